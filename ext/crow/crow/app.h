@@ -90,6 +90,22 @@ namespace crow
             return *this;
         }
 
+        // compress responses for clients which accept gzip or deflate
+        self_t& use_compression(int level, std::size_t min_size = 1024)
+        {
+            compression_.level = level;
+            compression_.min_size = min_size;
+            return *this;
+        }
+
+        // requests with larger bodies get 413 before
+        // their body is read. 0 means no limit.
+        self_t& max_body_size(std::size_t size)
+        {
+            max_body_size_ = size;
+            return *this;
+        }
+
         void validate()
         {
             router_.validate();
@@ -103,6 +119,8 @@ namespace crow
             {
                 ssl_server_ = std::move(std::unique_ptr<ssl_server_t>(new ssl_server_t(this, bindaddr_, port_, &middlewares_, concurrency_, &ssl_context_)));
                 ssl_server_->set_tick_function(tick_interval_, tick_function_);
+                ssl_server_->set_compression(compression_);
+                ssl_server_->set_max_body_size(max_body_size_);
                 ssl_server_->run();
             }
             else
@@ -110,6 +128,8 @@ namespace crow
             {
                 server_ = std::move(std::unique_ptr<server_t>(new server_t(this, bindaddr_, port_, &middlewares_, concurrency_, nullptr)));
                 server_->set_tick_function(tick_interval_, tick_function_);
+                server_->set_compression(compression_);
+                server_->set_max_body_size(max_body_size_);
                 server_->run();
             }
         }
@@ -235,6 +255,9 @@ namespace crow
         std::chrono::milliseconds tick_interval_;
         std::function<void()> tick_function_;
 
+        compression::settings compression_;
+        std::size_t max_body_size_{0};
+
         std::tuple<Middlewares...> middlewares_;
 
 #ifdef CROW_ENABLE_SSL
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <zlib.h>
+
+namespace crow
+{
+    namespace compression
+    {
+        // values are zlib's window bits for given format
+        enum algorithm
+        {
+            DEFLATE = 15,
+            GZIP = 15 | 16,
+        };
+
+        inline const char* content_encoding(algorithm algo)
+        {
+            return algo == GZIP ? "gzip" : "deflate";
+        }
+
+        struct settings
+        {
+            // zlib level, 1 to 9, or -1 for its default. 0 disables compression.
+            int level{0};
+
+            // smaller bodies are not worth compressing
+            std::size_t min_size{1024};
+
+            bool enabled() const
+            {
+                return level != 0;
+            }
+        };
+
+        // Picks algorithm accepted by the client, preferring gzip.
+        // Encodings with q=0 are treated as not accepted.
+        inline bool select_algorithm(const std::string& accept_encoding, algorithm& algo)
+        {
+            bool deflate_ok = false;
+
+            std::size_t pos = 0;
+
+            while (pos < accept_encoding.size())
+            {
+                std::size_t end = accept_encoding.find(',', pos);
+
+                if (end == std::string::npos)
+                    end = accept_encoding.size();
+
+                std::string coding = accept_encoding.substr(pos, end - pos);
+
+                pos = end + 1;
+
+                bool not_accepted = false;
+
+                std::size_t params = coding.find(';');
+
+                if (params != std::string::npos)
+                {
+                    std::string q = coding.substr(params + 1);
+                    q.erase(std::remove(q.begin(), q.end(), ' '), q.end());
+
+                    not_accepted = q == "q=0" || q == "q=0." || q == "q=0.0"
+                                   || q == "q=0.00" || q == "q=0.000";
+
+                    coding.erase(params);
+                }
+
+                coding.erase(std::remove(coding.begin(), coding.end(), ' '), coding.end());
+
+                if (not_accepted)
+                    continue;
+
+                if (coding == "gzip" || coding == "x-gzip")
+                {
+                    algo = GZIP;
+                    return true;
+                }
+
+                if (coding == "deflate")
+                    deflate_ok = true;
+            }
+
+            if (deflate_ok)
+                algo = DEFLATE;
+
+            return deflate_ok;
+        }
+
+        // Incremental compressor, so that bodies sent in chunks
+        // are compressed as they are produced.
+        class compressor
+        {
+        public:
+            compressor(algorithm algo, int level)
+            {
+                std::memset(&stream_, 0, sizeof(stream_));
+
+                ok_ = deflateInit2(&stream_, level, Z_DEFLATED, algo, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            }
+
+            ~compressor()
+            {
+                if (ok_)
+                    deflateEnd(&stream_);
+            }
+
+            compressor(const compressor&) = delete;
+            compressor& operator = (const compressor&) = delete;
+
+            // Appends compressed input to output. Everything given so far is
+            // flushed, so the client can decompress it before the next part.
+            bool compress(const std::string& input, std::string& output, bool last)
+            {
+                if (!ok_)
+                    return false;
+
+                stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+                stream_.avail_in = static_cast<uInt>(input.size());
+
+                int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+
+                char buffer[16384];
+
+                do
+                {
+                    stream_.next_out = reinterpret_cast<Bytef*>(buffer);
+                    stream_.avail_out = sizeof(buffer);
+
+                    int ret = deflate(&stream_, flush);
+
+                    if (ret == Z_STREAM_ERROR)
+                    {
+                        ok_ = false;
+                        return false;
+                    }
+
+                    output.append(buffer, sizeof(buffer) - stream_.avail_out);
+
+                } while (stream_.avail_out == 0);
+
+                return true;
+            }
+
+        private:
+            z_stream stream_;
+            bool ok_{false};
+        };
+
+        inline bool compress_string(const std::string& input, algorithm algo, int level, std::string& output)
+        {
+            compressor c(algo, level);
+            return c.compress(input, output, true);
+        }
+    }
+}
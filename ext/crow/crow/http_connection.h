@@ -6,11 +6,13 @@
 #include <atomic>
 #include <chrono>
 #include <vector>
+#include <sstream>
 
 #include "crow/http_parser_merged.h"
 
 #include "crow/parser.h"
 #include "crow/http_response.h"
+#include "crow/compression.h"
 #include "crow/logging.h"
 #include "crow/settings.h"
 #include "crow/dumb_timer_queue.h"
@@ -189,16 +191,20 @@ namespace crow
             std::tuple<Middlewares...>* middlewares,
             std::function<std::string()>& get_cached_date_str_f,
             detail::dumb_timer_queue& timer_queue,
-            typename Adaptor::context* adaptor_ctx_
+            typename Adaptor::context* adaptor_ctx_,
+            const compression::settings& compression,
+            std::size_t max_body_size
             ) 
             : adaptor_(io_service, adaptor_ctx_), 
             handler_(handler), 
             parser_(this), 
             server_name_(server_name),
+            compression_(compression),
             middlewares_(middlewares),
             get_cached_date_str(get_cached_date_str_f),
             timer_queue(timer_queue)
         {
+            parser_.max_body_size = max_body_size;
 #ifdef CROW_ENABLE_DEBUG
             connectionCount ++;
             CROW_LOG_DEBUG << "Connection open, total " << connectionCount << ", " << this;
@@ -257,6 +263,9 @@ namespace crow
             req_ = std::move(parser_.to_request());
             request& req = req_;
 
+            // HTTP/1.0 clients dont know chunked transfer encoding
+            is_http11_ = parser_.check_version(1, 1);
+
             if (parser_.check_version(1, 0))
             {
                 // HTTP/1.0
@@ -395,6 +404,38 @@ namespace crow
                 res.body = json::dump(res.json_value);
             }
 
+            if (res.body_producer)
+            {
+                body_producer_ = std::move(res.body_producer);
+                res.body_producer = nullptr;
+
+                if (!is_http11_)
+                {
+                    // produce whole body now and send it as usual
+                    if (!produce_body_part(res.body))
+                    {
+                        // reading could have been paused for
+                        // this response, if it completed later
+                        CROW_LOG_DEBUG << this << " from complete_request(1)";
+                        stop_paused_read();
+                        check_destroy();
+                        return;
+                    }
+                }
+            }
+
+            // client has the same content already
+            if (res.code == 200 && res.headers.count("etag") && req_.headers.count("if-none-match")
+                    && etag_matches(req_.get_header_value("if-none-match"), res.get_header_value("etag")))
+            {
+                res.code = 304;
+                res.body.clear();
+                res.gzip_body.reset();
+                body_producer_ = nullptr;
+            }
+
+            compress_response();
+
             if (!statusCodes.count(res.code))
                 res.code = 500;
             {
@@ -414,9 +455,15 @@ namespace crow
 
             }
 
-            if (!res.headers.count("content-length"))
+            if (body_producer_)
+            {
+                static std::string chunked_tag = "Transfer-Encoding: chunked";
+                buffers_.emplace_back(chunked_tag.data(), chunked_tag.size());
+                buffers_.emplace_back(crlf.data(), crlf.size());
+            }
+            else if (!res.headers.count("content-length") && res.code != 304 && res.code != 204)
             {
-                content_length_ = std::to_string(res.body.size());
+                content_length_ = std::to_string(res_gzip_body_ ? res_gzip_body_->size() : res.body.size());
                 static std::string content_length_tag = "Content-Length: ";
                 buffers_.emplace_back(content_length_tag.data(), content_length_tag.size());
                 buffers_.emplace_back(content_length_.data(), content_length_.size());
@@ -445,8 +492,24 @@ namespace crow
             }
 
             buffers_.emplace_back(crlf.data(), crlf.size());
-            res_body_copy_.swap(res.body);
-            buffers_.emplace_back(res_body_copy_.data(), res_body_copy_.size());
+
+            if (body_producer_)
+            {
+                // headers go out together with the first chunk. Reading
+                // of the next request resumes after the last one.
+                do_write_chunk();
+                return;
+            }
+
+            if (res_gzip_body_)
+            {
+                buffers_.emplace_back(res_gzip_body_->data(), res_gzip_body_->size());
+            }
+            else
+            {
+                res_body_copy_.swap(res.body);
+                buffers_.emplace_back(res_body_copy_.data(), res_body_copy_.size());
+            }
 
             do_write();
 
@@ -474,6 +537,11 @@ namespace crow
                         {
                             error_while_reading = false;
                         }
+                        else if (parser_.body_too_large && adaptor_.is_open())
+                        {
+                            reject_too_large_body();
+                            return;
+                        }
                     }
 
                     if (error_while_reading)
@@ -493,7 +561,7 @@ namespace crow
                         check_destroy();
                         // adaptor will close after write
                     }
-                    else if (!need_to_call_after_handlers_)
+                    else if (!need_to_call_after_handlers_ && !body_producer_)
                     {
                         start_deadline();
                         do_read();
@@ -506,6 +574,23 @@ namespace crow
                 });
         }
 
+        // replies 413 and closes the connection, as the
+        // rest of the body is not going to be read
+        void reject_too_large_body()
+        {
+            cancel_deadline_timer();
+            is_reading = false;
+            close_connection_ = true;
+            need_to_call_after_handlers_ = false;
+
+            req_ = parser_.to_request();
+
+            CROW_LOG_INFO << "Request body too large: " << boost::lexical_cast<std::string>(adaptor_.remote_endpoint()) << " " << this << ' ' << req_.raw_url;
+
+            res = response(413);
+            complete_request();
+        }
+
         void do_write()
         {
             //auto self = this->shared_from_this();
@@ -516,6 +601,7 @@ namespace crow
                     is_writing = false;
                     res.clear();
                     res_body_copy_.clear();
+                    res_gzip_body_.reset();
                     if (!ec)
                     {
                         if (close_connection_)
@@ -533,6 +619,196 @@ namespace crow
                 });
         }
 
+        // compresses the body, or sets up compression of the chunks
+        // of the produced body, if the client accepts it
+        void compress_response()
+        {
+            compression::algorithm algo;
+
+            if (!compression_.enabled()
+                    || res.headers.count("content-encoding")
+                    || res.code == 204 || res.code == 304
+                    || !compression::select_algorithm(req_.get_header_value("accept-encoding"), algo))
+            {
+                return;
+            }
+
+            if (body_producer_)
+            {
+                compressor_.reset(new compression::compressor(algo, compression_.level));
+            }
+            else if (res.gzip_body && algo == compression::GZIP)
+            {
+                res_gzip_body_ = std::move(res.gzip_body);
+            }
+            else if (res.body.size() >= compression_.min_size)
+            {
+                std::string compressed;
+
+                if (!compression::compress_string(res.body, algo, compression_.level, compressed))
+                {
+                    CROW_LOG_ERROR << "Compression failed for " << req_.raw_url;
+                    return;
+                }
+
+                res.body.swap(compressed);
+            }
+            else
+            {
+                return;
+            }
+
+            res.set_header("Content-Encoding", compression::content_encoding(algo));
+            res.add_header("Vary", "Accept-Encoding");
+        }
+
+        // calls the body producer; false if it threw, in which
+        // case the connection is closed without sending the rest.
+        // For HTTP/1.0 it is called until the whole body is done,
+        // each time with an empty part, as it is for chunks, so
+        // that producers limiting size of the part always progress.
+        bool produce_body_part(std::string& body_part)
+        {
+            try
+            {
+                if (is_http11_)
+                {
+                    if (!body_producer_(body_part))
+                        body_producer_ = nullptr;
+
+                    return true;
+                }
+
+                std::string part;
+                bool has_more {true};
+
+                while (has_more)
+                {
+                    part.clear();
+                    has_more = body_producer_(part);
+                    body_part += part;
+                }
+
+                body_producer_ = nullptr;
+                return true;
+            }
+            catch (std::exception& e)
+            {
+                CROW_LOG_ERROR << "Body producer failed for " << req_.raw_url << ": " << e.what();
+            }
+
+            body_producer_ = nullptr;
+            res.clear();
+            adaptor_.close();
+            return false;
+        }
+
+        void do_write_chunk()
+        {
+            static std::string crlf = "\r\n";
+            static std::string last_chunk = "0\r\n\r\n";
+
+            chunk_body_.clear();
+
+            if (!produce_body_part(chunk_body_))
+            {
+                CROW_LOG_DEBUG << this << " from write_chunk(1)";
+                stop_paused_read();
+                check_destroy();
+                return;
+            }
+
+            if (compressor_)
+            {
+                compressed_chunk_.clear();
+
+                if (!compressor_->compress(chunk_body_, compressed_chunk_, !body_producer_))
+                {
+                    CROW_LOG_ERROR << "Compression failed for " << req_.raw_url;
+                    body_producer_ = nullptr;
+                    compressor_.reset();
+                    res.clear();
+                    adaptor_.close();
+                    stop_paused_read();
+                    check_destroy();
+                    return;
+                }
+
+                chunk_body_.swap(compressed_chunk_);
+
+                if (!body_producer_)
+                    compressor_.reset();
+            }
+
+            if (!chunk_body_.empty())
+            {
+                std::ostringstream chunk_size;
+                chunk_size << std::hex << chunk_body_.size() << crlf;
+                chunk_header_ = chunk_size.str();
+
+                buffers_.emplace_back(chunk_header_.data(), chunk_header_.size());
+                buffers_.emplace_back(chunk_body_.data(), chunk_body_.size());
+                buffers_.emplace_back(crlf.data(), crlf.size());
+            }
+
+            // producer is reset after its last part
+            if (!body_producer_)
+                buffers_.emplace_back(last_chunk.data(), last_chunk.size());
+
+            is_writing = true;
+            boost::asio::async_write(adaptor_.socket(), buffers_,
+                [this](const boost::system::error_code& ec, std::size_t /*bytes_transferred*/)
+                {
+                    is_writing = false;
+                    buffers_.clear();
+
+                    if (ec)
+                    {
+                        body_producer_ = nullptr;
+                        compressor_.reset();
+                        res.clear();
+                        CROW_LOG_DEBUG << this << " from write_chunk(2)";
+                        stop_paused_read();
+                        check_destroy();
+                        return;
+                    }
+
+                    if (body_producer_)
+                    {
+                        do_write_chunk();
+                        return;
+                    }
+
+                    res.clear();
+                    chunk_body_.clear();
+
+                    if (close_connection_)
+                    {
+                        adaptor_.close();
+                        CROW_LOG_DEBUG << this << " from write_chunk(3)";
+                        stop_paused_read();
+                        check_destroy();
+                    }
+                    else if (need_to_start_read_after_complete_)
+                    {
+                        need_to_start_read_after_complete_ = false;
+                        start_deadline();
+                        do_read();
+                    }
+                });
+        }
+
+        // reading waits for the chunked response to finish. If
+        // the connection ends before that, no read is pending.
+        void stop_paused_read()
+        {
+            if (need_to_start_read_after_complete_)
+            {
+                need_to_start_read_after_complete_ = false;
+                is_reading = false;
+            }
+        }
+
         void check_destroy()
         {
             CROW_LOG_DEBUG << this << " is_reading " << is_reading << " is_writing " << is_writing;
@@ -583,6 +859,15 @@ namespace crow
         std::string date_str_;
         std::string res_body_copy_;
 
+        std::function<bool(std::string&)> body_producer_;
+        std::string chunk_header_;
+        std::string chunk_body_;
+
+        const compression::settings& compression_;
+        std::unique_ptr<compression::compressor> compressor_;
+        std::string compressed_chunk_;
+        std::shared_ptr<const std::string> res_gzip_body_;
+
         //boost::asio::deadline_timer deadline_;
         detail::dumb_timer_queue::key timer_cancel_key_;
 
@@ -591,6 +876,7 @@ namespace crow
         bool need_to_call_after_handlers_{};
         bool need_to_start_read_after_complete_{};
         bool add_keep_alive_{};
+        bool is_http11_{};
 
         std::tuple<Middlewares...>* middlewares_;
         detail::context<Middlewares...> ctx_;
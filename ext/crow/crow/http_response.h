@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <memory>
+#include <functional>
 #include <unordered_map>
 
 #include "crow/json.h"
@@ -8,6 +10,48 @@
 
 namespace crow
 {
+    // Weak comparison of ETag with If-None-Match header,
+    // i.e., W/ prefixes are ignored.
+    inline bool etag_matches(const std::string& if_none_match, const std::string& etag)
+    {
+        if (etag.empty())
+            return false;
+
+        auto strip_weak = [](const std::string& tag)
+        {
+            return tag.compare(0, 2, "W/") == 0 ? tag.substr(2) : tag;
+        };
+
+        std::string opaque_tag = strip_weak(etag);
+
+        std::size_t pos = 0;
+
+        while (pos < if_none_match.size())
+        {
+            std::size_t end = if_none_match.find(',', pos);
+
+            if (end == std::string::npos)
+                end = if_none_match.size();
+
+            std::string tag = if_none_match.substr(pos, end - pos);
+
+            pos = end + 1;
+
+            std::size_t first = tag.find_first_not_of(" \t");
+            std::size_t last = tag.find_last_not_of(" \t");
+
+            if (first == std::string::npos)
+                continue;
+
+            tag = tag.substr(first, last - first + 1);
+
+            if (tag == "*" || strip_weak(tag) == opaque_tag)
+                return true;
+        }
+
+        return false;
+    }
+
     template <typename Adaptor, typename Handler, typename ... Middlewares>
     class Connection;
     struct response
@@ -22,6 +66,18 @@ namespace crow
         // `headers' stores HTTP headers.
         ci_map headers;
 
+        // If set, the body is sent with chunked transfer encoding.
+        // The producer is called repeatedly after the handler
+        // returns; each call appends the next part of the body to
+        // the given string and returns false after the last part.
+        // Throwing from it aborts the response and the connection.
+        std::function<bool(std::string&)> body_producer;
+
+        // Gzip of the body, compressed in advance, e.g., kept in a
+        // cache. Sent instead of the body to clients accepting gzip
+        // when compression is enabled.
+        std::shared_ptr<const std::string> gzip_body;
+
         void set_header(std::string key, std::string value)
         {
             headers.erase(key);
@@ -68,6 +124,8 @@ namespace crow
             json_value = std::move(r.json_value);
             code = r.code;
             headers = std::move(r.headers);
+            body_producer = std::move(r.body_producer);
+            gzip_body = std::move(r.gzip_body);
             completed_ = r.completed_;
             return *this;
         }
@@ -83,6 +141,8 @@ namespace crow
             json_value.clear();
             code = 200;
             headers.clear();
+            body_producer = nullptr;
+            gzip_body.reset();
             completed_ = false;
         }
 
@@ -45,6 +45,16 @@ namespace crow
             tick_function_ = f;
         }
 
+        void set_compression(const compression::settings& compression)
+        {
+            compression_ = compression;
+        }
+
+        void set_max_body_size(std::size_t max_body_size)
+        {
+            max_body_size_ = max_body_size;
+        }
+
         void on_tick()
         {
             tick_function_();
@@ -191,7 +201,7 @@ namespace crow
             auto p = new Connection<Adaptor, Handler, Middlewares...>(
                 is, handler_, server_name_, middlewares_,
                 get_cached_date_str_pool_[roundrobin_index_], *timer_queue_pool_[roundrobin_index_],
-                adaptor_ctx_);
+                adaptor_ctx_, compression_, max_body_size_);
             acceptor_.async_accept(p->socket(),
                 [this, p, &is](boost::system::error_code ec)
                 {
@@ -229,6 +239,9 @@ namespace crow
         std::chrono::milliseconds tick_interval_;
         std::function<void()> tick_function_;
 
+        compression::settings compression_;
+        std::size_t max_body_size_{0};
+
         std::tuple<Middlewares...>* middlewares_;
 
 #ifdef CROW_ENABLE_SSL
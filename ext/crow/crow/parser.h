@@ -66,12 +66,25 @@ namespace crow
             {
                 self->headers.emplace(std::move(self->header_field), std::move(self->header_value));
             }
+            // reject declared length before any of the body is read
+            if (self->max_body_size > 0 && self->content_length != CROW_ULLONG_MAX
+                    && self->content_length > self->max_body_size)
+            {
+                self->body_too_large = true;
+                return -1;
+            }
             self->process_header();
             return 0;
         }
         static int on_body(http_parser* self_, const char* at, size_t length)
         {
             HTTPParser* self = static_cast<HTTPParser*>(self_);
+            // chunked bodies have no length declared upfront
+            if (self->max_body_size > 0 && self->body.size() + length > self->max_body_size)
+            {
+                self->body_too_large = true;
+                return -1;
+            }
             self->body.insert(self->body.end(), at, at+length);
             return 0;
         }
@@ -125,6 +138,7 @@ namespace crow
             headers.clear();
             url_params.clear();
             body.clear();
+            body_too_large = false;
         }
 
         void process_header()
@@ -162,6 +176,10 @@ namespace crow
         query_string url_params;
         std::string body;
 
+        // 0 means no limit
+        std::size_t max_body_size{0};
+        bool body_too_large{false};
+
         Handler* handler_;
     };
 }
@@ -5,6 +5,10 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #include <boost/variant.hpp>
 
@@ -91,19 +95,111 @@ class lambda_t {
   std::function<std::string(node_renderer<N> renderer, const std::string&)> fun;
 };
 
+// Flat map keeping items in a vector, in insertion order.
+// Contexts have at most few dozens of keys, so linear search
+// is as fast as a tree, while the whole map is one allocation
+// instead of one per key. Unlike std::map, adding new key may
+// invalidate references and iterators to other items.
 template <class Key, class Value>
-struct map : public std::map<Key, Value>
-{
+class map {
+ public:
+  using key_type = typename std::remove_const<Key>::type;
+  using mapped_type = Value;
+  using value_type = std::pair<key_type, Value>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+  using size_type = typename std::vector<value_type>::size_type;
+
   map() {}
-  map(const map<Key, Value>& rhs) : std::map<Key, Value>(rhs) {}
-  map(const std::initializer_list<typename std::map<Key, Value>::value_type>& args) : std::map<Key, Value>(args) {}
-  map& operator=(const map& rhs)
-  {
-    std::map<Key, Value>::clear();
-    for (auto& i : rhs)
-      std::map<Key, Value>::insert(i);
-    return *this;
+
+  map(std::initializer_list<value_type> args) {
+    m_items.reserve(args.size());
+    for (auto& item: args)
+      insert(item);
+  }
+
+  iterator begin() { return m_items.begin(); }
+  iterator end() { return m_items.end(); }
+  const_iterator begin() const { return m_items.begin(); }
+  const_iterator end() const { return m_items.end(); }
+
+  size_type size() const { return m_items.size(); }
+  bool empty() const { return m_items.empty(); }
+  void clear() { m_items.clear(); }
+  void reserve(size_type n) { m_items.reserve(n); }
+
+  iterator find(const key_type& key) {
+    iterator it = m_items.begin();
+    while (it != m_items.end() && it->first != key)
+      ++it;
+    return it;
+  }
+
+  const_iterator find(const key_type& key) const {
+    const_iterator it = m_items.begin();
+    while (it != m_items.end() && it->first != key)
+      ++it;
+    return it;
+  }
+
+  size_type count(const key_type& key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  Value& at(const key_type& key) {
+    iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("mstch::map::at");
+    return it->second;
+  }
+
+  const Value& at(const key_type& key) const {
+    const_iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("mstch::map::at");
+    return it->second;
+  }
+
+  Value& operator[](const key_type& key) {
+    iterator it = find(key);
+    if (it != end())
+      return it->second;
+    m_items.emplace_back(key, Value{});
+    return m_items.back().second;
+  }
+
+  // existing items are not overwritten, same as in std::map
+  std::pair<iterator, bool> insert(const value_type& item) {
+    iterator it = find(item.first);
+    if (it != end())
+      return {it, false};
+    m_items.push_back(item);
+    return {m_items.end() - 1, true};
+  }
+
+  std::pair<iterator, bool> insert(value_type&& item) {
+    iterator it = find(item.first);
+    if (it != end())
+      return {it, false};
+    m_items.push_back(std::move(item));
+    return {m_items.end() - 1, true};
+  }
+
+  template<class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return insert(value_type(std::forward<Args>(args)...));
   }
+
+  size_type erase(const key_type& key) {
+    iterator it = find(key);
+    if (it == end())
+      return 0;
+    m_items.erase(it);
+    return 1;
+  }
+
+ private:
+  std::vector<value_type> m_items;
 };
 
 }
@@ -125,4 +221,28 @@ std::string render(
     const std::map<std::string,std::string>& partials =
         std::map<std::string,std::string>());
 
+// Template tokenized once, together with its partials, so that
+// it can be rendered any number of times, from any number of
+// threads, without parsing it again.
+class compiled_template {
+ public:
+  compiled_template() = default;
+  compiled_template(
+      const std::string& tmplt,
+      const std::map<std::string,std::string>& partials =
+          std::map<std::string,std::string>());
+
+  std::string render(const node& root) const;
+
+  // appends rendered template to the output, so that
+  // the same buffer can be reused for many renders
+  void render(const node& root, std::string& output) const;
+
+ private:
+  struct impl;
+  std::shared_ptr<const impl> m_impl;
+};
+
+std::string render(const compiled_template& tmplt, const node& root);
+
 }
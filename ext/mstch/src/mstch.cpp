@@ -18,3 +18,35 @@ std::string mstch::render(
 
   return render_context(root, partial_templates).render(tmplt);
 }
+
+struct compiled_template::impl {
+  template_type tmplt;
+  std::map<std::string, template_type> partials;
+};
+
+compiled_template::compiled_template(
+    const std::string& tmplt,
+    const std::map<std::string,std::string>& partials)
+{
+  std::shared_ptr<impl> compiled = std::make_shared<impl>();
+  compiled->tmplt = template_type{tmplt};
+  for (auto& partial: partials)
+    compiled->partials.insert({partial.first, {partial.second}});
+  m_impl = compiled;
+}
+
+std::string compiled_template::render(const node& root) const {
+  std::string output;
+  render(root, output);
+  return output;
+}
+
+void compiled_template::render(const node& root, std::string& output) const {
+  if (!m_impl)
+    return;
+  render_context(root, m_impl->partials).render(m_impl->tmplt, output);
+}
+
+std::string mstch::render(const compiled_template& tmplt, const node& root) {
+  return tmplt.render(root);
+}
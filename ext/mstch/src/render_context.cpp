@@ -9,13 +9,11 @@ const mstch::node render_context::null_node;
 render_context::push::push(render_context& context, const mstch::node& node):
     m_context(context)
 {
-  context.m_nodes.emplace_front(node);
   context.m_node_ptrs.emplace_front(&node);
   context.m_state.push(std::unique_ptr<render_state>(new outside_section));
 }
 
 render_context::push::~push() {
-  m_context.m_nodes.pop_front();
   m_context.m_node_ptrs.pop_front();
   m_context.m_state.pop();
 }
@@ -27,7 +25,7 @@ std::string render_context::push::render(const template_type& templt) {
 render_context::render_context(
     const mstch::node& node,
     const std::map<std::string, template_type>& partials):
-    m_partials(partials), m_nodes(1, node), m_node_ptrs(1, &node)
+    m_partials(partials), m_node_ptrs(1, &node)
 {
   m_state.push(std::unique_ptr<render_state>(new outside_section));
 }
@@ -54,6 +52,14 @@ std::string render_context::render(
     const template_type& templt, const std::string& prefix)
 {
   std::string output;
+  render(templt, output, prefix);
+  return output;
+}
+
+void render_context::render(
+    const template_type& templt, std::string& output,
+    const std::string& prefix)
+{
   bool prev_eol = true;
   for (auto& token: templt) {
     if (prev_eol && prefix.length() != 0)
@@ -61,7 +67,6 @@ std::string render_context::render(
     output += m_state.top()->render(*this, token);
     prev_eol = token.eol();
   }
-  return output;
 }
 
 std::string render_context::render_partial(
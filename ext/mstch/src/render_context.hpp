@@ -29,6 +29,9 @@ class render_context {
   const mstch::node& get_node(const std::string& token);
   std::string render(
       const template_type& templt, const std::string& prefix = "");
+  void render(
+      const template_type& templt, std::string& output,
+      const std::string& prefix = "");
   std::string render_partial(
       const std::string& partial_name, const std::string& prefix);
   template<class T, class... Args>
@@ -42,8 +45,9 @@ class render_context {
   const mstch::node& find_node(
       const std::string& token,
       std::list<node const*> current_nodes);
-  std::map<std::string, template_type> m_partials;
-  std::deque<mstch::node> m_nodes;
+  // nodes and partials are only referenced. They outlive the
+  // context, or the push, which is always a temporary.
+  const std::map<std::string, template_type>& m_partials;
   std::list<const mstch::node*> m_node_ptrs;
   std::stack<std::unique_ptr<render_state>> m_state;
 };
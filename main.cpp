@@ -35,7 +35,112 @@ struct jsonresponse: public crow::response
         add_header("Access-Control-Allow-Headers", "Content-Type");
         add_header("Content-Type", "application/json");
     }
+
+    // for responses which are already serialized json
+    jsonresponse(string&& _body)
+            : crow::response {std::move(_body)}
+    {
+        add_header("Access-Control-Allow-Origin", "*");
+        add_header("Access-Control-Allow-Headers", "Content-Type");
+        add_header("Content-Type", "application/json");
+    }
+
+    // for responses sent in chunks as they are produced
+    jsonresponse(xmreg::json_stream&& _producer)
+    {
+        body_producer = std::move(_producer);
+
+        add_header("Access-Control-Allow-Origin", "*");
+        add_header("Access-Control-Allow-Headers", "Content-Type");
+        add_header("Content-Type", "application/json");
+    }
 };
+
+// response, e.g., hex of a blob, sent in chunks as it is produced
+struct streamresponse: public crow::response
+{
+    streamresponse(xmreg::body_stream&& _producer)
+    {
+        body_producer = std::move(_producer);
+    }
+};
+
+// Cache-Control of content which never changes for its url,
+// e.g., hex of a tx or a block requested by its hash
+const string immutable_cache_control {"public, max-age=31536000, immutable"};
+
+// Cache-Control of content which can change for its url, e.g.,
+// block requested by its height after a deep reorg, or a page
+// showing confirmations. Caches keep it, but must check its
+// ETag first, which costs only a 304 if it did not change.
+const string revalidate_cache_control {"public, no-cache"};
+
+// Response with content identified by given ETag. Clients and
+// proxies which have it already get 304, without the content being
+// generated again. Empty ETag means that the content can still
+// change often, so its just generated.
+template <typename Generator>
+crow::response
+cacheable_response(crow::request const& req, string const& etag,
+                   string const& cache_control, Generator generate)
+{
+    if (!etag.empty()
+            && crow::etag_matches(req.get_header_value("if-none-match"), etag))
+    {
+        crow::response r {304};
+        r.add_header("ETag", etag);
+        r.add_header("Cache-Control", cache_control);
+        return r;
+    }
+
+    crow::response r = generate();
+
+    if (!etag.empty() && r.code == 200)
+    {
+        r.set_header("ETag", etag);
+        r.set_header("Cache-Control", cache_control);
+    }
+
+    return r;
+}
+
+// gzip of response bodies which never change
+using gzip_cache_t = xmreg::ShardedLruCache<string, shared_ptr<const string>>;
+
+// json response with a body which never changes for given key,
+// e.g., raw tx requested by its hash. Its gzip is taken from the
+// cache, or compressed now and cached, so that the same body is
+// compressed only once.
+jsonresponse
+immutable_jsonresponse(string&& _body, string const& key,
+                       gzip_cache_t& gzip_cache,
+                       crow::compression::settings const& compression)
+{
+    jsonresponse r {std::move(_body)};
+
+    if (!compression.enabled() || r.body.size() < compression.min_size)
+        return r;
+
+    shared_ptr<const string> gzip_body;
+
+    if (!gzip_cache.get(key, gzip_body))
+    {
+        string compressed;
+
+        if (!crow::compression::compress_string(
+                r.body, crow::compression::GZIP,
+                compression.level, compressed))
+            return r;
+
+        gzip_body = make_shared<const string>(std::move(compressed));
+
+        gzip_cache.put(key, gzip_body);
+    }
+
+    r.gzip_body = gzip_body;
+
+    return r;
+}
 }
 
 int
@@ -77,7 +182,19 @@ main(int ac, const char* av[])
     auto enable_json_api_opt           = opts.get_option<bool>("enable-json-api");
     auto enable_as_hex_opt             = opts.get_option<bool>("enable-as-hex");
     auto concurrency_opt               = opts.get_option<size_t>("concurrency");
+    auto worker_threads_opt            = opts.get_option<size_t>("worker-threads");
+    auto worker_queue_size_opt         = opts.get_option<size_t>("worker-queue-size");
+    auto block_cache_size_opt          = opts.get_option<size_t>("block-cache-size");
+    auto ring_member_cache_size_opt    = opts.get_option<size_t>("ring-member-cache-size");
+    auto daemon_rpc_connections_opt    = opts.get_option<size_t>("daemon-rpc-connections");
+    auto daemon_rpc_timeout_opt        = opts.get_option<size_t>("daemon-rpc-timeout");
+    auto compression_level_opt         = opts.get_option<int>("compression-level");
+    auto compression_min_size_opt      = opts.get_option<size_t>("compression-min-size");
+    auto max_body_size_opt             = opts.get_option<size_t>("max-body-size");
+    auto emission_threads_opt          = opts.get_option<size_t>("emission-threads");
     auto enable_emission_monitor_opt   = opts.get_option<bool>("enable-emission-monitor");
+    auto enable_index_snapshot_opt     = opts.get_option<bool>("enable-index-snapshot");
+    auto enable_header_index_opt       = opts.get_option<bool>("enable-header-index");
 
 
     bool testnet                      {*testnet_opt};
@@ -89,6 +206,14 @@ main(int ac, const char* av[])
         return EXIT_FAILURE;
     }
 
+    // levels which zlib accepts, -1 being its default
+    if (*compression_level_opt < -1 || *compression_level_opt > 9)
+    {
+        cerr << "compression-level must be from -1 to 9, given: "
+             << *compression_level_opt << endl;
+        return EXIT_FAILURE;
+    }
+
     const cryptonote::network_type nettype = testnet ?
         cryptonote::network_type::TESTNET : stagenet ?
         cryptonote::network_type::STAGENET : cryptonote::network_type::MAINNET;
@@ -102,6 +227,8 @@ main(int ac, const char* av[])
     bool enable_json_api              {*enable_json_api_opt};
     bool enable_as_hex                {*enable_as_hex_opt};
     bool enable_emission_monitor      {*enable_emission_monitor_opt};
+    bool enable_index_snapshot        {*enable_index_snapshot_opt};
+    bool enable_header_index          {*enable_header_index_opt};
 
 
     // set  monero log output level
@@ -225,6 +352,11 @@ main(int ac, const char* av[])
              <<" into numbers. Using default values.\n";
     }
 
+    // watches lmdb for new blocks and reorganizations, so
+    // that other threads dont have to poll it themselves
+    xmreg::ChainTipWatcher::set_blockchain_variables(core_storage);
+    xmreg::ChainTipWatcher::start_chain_tip_thread();
+
     uint64_t mempool_refresh_time {10};
 
 
@@ -234,14 +366,14 @@ main(int ac, const char* av[])
         // to calculate, store and monitor
         // current total Monero emission amount.
 
-        // This thread stores the current emission
-        // which it has caluclated in
-        // <blockchain_path>/emission_amount.txt file,
-        // e.g., ~/.bitmonero/lmdb/emission_amount.txt.
+        // This thread stores the emission of each
+        // 10000 blocks which it has caluclated in
+        // <blockchain_path>/emission_checkpoints.txt file,
+        // e.g., ~/.bitmonero/lmdb/emission_checkpoints.txt.
         // So instead of calcualting the emission
         // from scrach whenever the explorer is started,
         // the thread is initalized with the values
-        // found in emission_amount.txt file.
+        // found in emission_checkpoints.txt file.
 
         xmreg::CurrentBlockchainStatus::blockchain_path
                 = blockchain_path;
@@ -249,6 +381,8 @@ main(int ac, const char* av[])
                 = nettype;
         xmreg::CurrentBlockchainStatus::deamon_url
                 = deamon_url;
+        xmreg::CurrentBlockchainStatus::no_of_scan_threads
+                = *emission_threads_opt;
         xmreg::CurrentBlockchainStatus::set_blockchain_variables(
                 &mcore, core_storage);
 
@@ -260,14 +394,21 @@ main(int ac, const char* av[])
     }
 
 
+    // rpc connections to the deamon are kept open and
+    // shared between mempool thread and http queries
+    xmreg::rpccalls daemon_rpc {deamon_url,
+                                daemon_rpc_login,
+                                *daemon_rpc_timeout_opt,
+                                *daemon_rpc_connections_opt};
+
     xmreg::MempoolStatus::blockchain_path
             = blockchain_path;
     xmreg::MempoolStatus::nettype
             = nettype;
     xmreg::MempoolStatus::deamon_url
             = deamon_url;
-    xmreg::MempoolStatus::login
-            = daemon_rpc_login;
+    xmreg::MempoolStatus::rpc
+            = &daemon_rpc;
     xmreg::MempoolStatus::set_blockchain_variables(
             &mcore, core_storage);
 
@@ -295,11 +436,15 @@ main(int ac, const char* av[])
     xmreg::MempoolStatus::mempool_refresh_time = mempool_refresh_time;
     xmreg::MempoolStatus::start_mempool_status_thread();
 
+    // worker threads shared by all http queries, instead
+    // of creating new threads for each of them
+    xmreg::ThreadPool executor {*worker_threads_opt,
+                                *worker_queue_size_opt};
+
     // create instance of page class which
     // contains logic for the website
     xmreg::page xmrblocks(&mcore,
                           core_storage,
-                          deamon_url,
                           nettype,
                           enable_pusher,
                           enable_randomx,
@@ -313,11 +458,48 @@ main(int ac, const char* av[])
                           *testnet_url,
                           *stagenet_url,
                           *mainnet_url,
-                          daemon_rpc_login);
+                          &daemon_rpc,
+                          &executor,
+                          *block_cache_size_opt,
+                          enable_index_snapshot,
+                          *ring_member_cache_size_opt,
+                          enable_header_index);
+
+    // in index snapshot mode, this starts thread which
+    // prepares front page in advance, whenever new block
+    // arrives or mempool changes.
+    xmrblocks.start_index_snapshot_thread();
+
+    // with header index enabled, this starts thread which loads
+    // headers of all blocks into memory, and then keeps adding
+    // new ones
+    xmrblocks.start_header_index_thread();
+
+    // reorganized blocks are dropped from the caches
+    // as soon as the chain tip watcher finds them
+    xmreg::ChainTipWatcher::add_reorg_listener(
+            [&xmrblocks](xmreg::ChainTipWatcher::chain_tip const& tip)
+    {
+        xmrblocks.evict_reorged_blocks(tip.fork_height);
+    });
 
     // crow instance
     crow::SimpleApp app;
 
+    crow::compression::settings compression;
+
+    compression.level    = *compression_level_opt;
+    compression.min_size = *compression_min_size_opt;
+
+    app.use_compression(compression.level, compression.min_size);
+
+    // key image and output exports are posted as a whole, so
+    // larger uploads are rejected before they are buffered
+    app.max_body_size(*max_body_size_opt);
+
+    // raw txs and blocks requested by hash are compressed only once
+    myxmr::gzip_cache_t gzip_cache {1000};
+
     // get domian url based on the request
     auto get_domain = [&use_ssl](crow::request const& req) {
         return (use_ssl ? "https://" : "http://")
@@ -335,8 +517,12 @@ main(int ac, const char* av[])
     });
 
     CROW_ROUTE(app, "/block/<uint>")
-    ([&](size_t block_height) {
-        return myxmr::htmlresponse(xmrblocks.show_block(block_height));
+    ([&](const crow::request& req, size_t block_height) {
+        return myxmr::cacheable_response(
+                req, xmrblocks.get_block_page_etag(block_height),
+                myxmr::revalidate_cache_control, [&]() -> crow::response {
+            return myxmr::htmlresponse(xmrblocks.show_block(block_height));
+        });
     });
     
     CROW_ROUTE(app, "/randomx/<uint>")
@@ -345,15 +531,23 @@ main(int ac, const char* av[])
     });
 
     CROW_ROUTE(app, "/block/<string>")
-    ([&](string block_hash) {
-        return myxmr::htmlresponse(
-                xmrblocks.show_block(remove_bad_chars(block_hash)));
+    ([&](const crow::request& req, string block_hash) {
+        block_hash = remove_bad_chars(block_hash);
+        return myxmr::cacheable_response(
+                req, xmrblocks.get_block_page_etag(block_hash),
+                myxmr::revalidate_cache_control, [&]() -> crow::response {
+            return myxmr::htmlresponse(xmrblocks.show_block(block_hash));
+        });
     });
 
     CROW_ROUTE(app, "/tx/<string>")
-    ([&](string tx_hash) {
-        return myxmr::htmlresponse(
-                xmrblocks.show_tx(remove_bad_chars(tx_hash)));
+    ([&](const crow::request& req, string tx_hash) {
+        tx_hash = remove_bad_chars(tx_hash);
+        return myxmr::cacheable_response(
+                req, xmrblocks.get_tx_page_etag(tx_hash),
+                myxmr::revalidate_cache_control, [&]() -> crow::response {
+            return myxmr::htmlresponse(xmrblocks.show_tx(tx_hash));
+        });
     });
     if (enable_autorefresh_option)
     {
@@ -369,27 +563,45 @@ main(int ac, const char* av[])
     if (enable_as_hex)
     {
         CROW_ROUTE(app, "/txhex/<string>")
-        ([&](string tx_hash) {
-            return crow::response(
-                    xmrblocks.show_tx_hex(remove_bad_chars(tx_hash)));
+        ([&](const crow::request& req, string tx_hash) {
+            tx_hash = remove_bad_chars(tx_hash);
+            return myxmr::cacheable_response(
+                    req, xmrblocks.get_immutable_tx_etag(tx_hash),
+                    myxmr::immutable_cache_control, [&]() -> crow::response {
+                return myxmr::streamresponse(xmrblocks.show_tx_hex(tx_hash));
+            });
         });
 
         CROW_ROUTE(app, "/ringmembershex/<string>")
-        ([&](string tx_hash) {
-            return crow::response(
-                    xmrblocks.show_ringmembers_hex(remove_bad_chars(tx_hash)));
+        ([&](const crow::request& req, string tx_hash) {
+            tx_hash = remove_bad_chars(tx_hash);
+            return myxmr::cacheable_response(
+                    req, xmrblocks.get_immutable_tx_etag(tx_hash),
+                    myxmr::immutable_cache_control, [&]() {
+                return crow::response(xmrblocks.show_ringmembers_hex(tx_hash));
+            });
         });
 
         CROW_ROUTE(app, "/blockhex/<uint>")
-        ([&](size_t block_height) {
-            return crow::response(
-                    xmrblocks.show_block_hex(block_height, false));
+        ([&](const crow::request& req, size_t block_height) {
+            // block at given height can change after a deep reorg
+            return myxmr::cacheable_response(
+                    req, xmrblocks.get_immutable_block_etag(block_height),
+                    myxmr::revalidate_cache_control, [&]() -> crow::response {
+                return myxmr::streamresponse(
+                        xmrblocks.show_block_hex(block_height, false));
+            });
         });
 
         CROW_ROUTE(app, "/blockhexcomplete/<uint>")
-        ([&](size_t block_height) {
-            return crow::response(
-                    xmrblocks.show_block_hex(block_height, true));
+        ([&](const crow::request& req, size_t block_height) {
+            // block at given height can change after a deep reorg
+            return myxmr::cacheable_response(
+                    req, xmrblocks.get_immutable_block_etag(block_height),
+                    myxmr::revalidate_cache_control, [&]() -> crow::response {
+                return myxmr::streamresponse(
+                        xmrblocks.show_block_hex(block_height, true));
+            });
         });
 
 //        CROW_ROUTE(app, "/ringmemberstxhex/<string>")
@@ -428,23 +640,22 @@ main(int ac, const char* av[])
     ([&](const crow::request& req) -> myxmr::htmlresponse
      {
 
-        map<std::string, std::string> post_body
-                = xmreg::parse_crow_post_data(req.body);
+        xmreg::form_fields post_body
+                = xmreg::parse_form_data(req.body);
+
+        string tx_hash, xmr_address, viewkey;
 
-        if (post_body.count("xmr_address") == 0
-            || post_body.count("viewkey") == 0
-            || post_body.count("tx_hash") == 0)
+        if (!xmreg::get_form_field(post_body, "xmr_address", xmr_address)
+            || !xmreg::get_form_field(post_body, "viewkey", viewkey)
+            || !xmreg::get_form_field(post_body, "tx_hash", tx_hash))
         {
             return string("xmr address, viewkey or tx hash not provided");
         }
 
-        string tx_hash     = remove_bad_chars(post_body["tx_hash"]);
-        string xmr_address = remove_bad_chars(post_body["xmr_address"]);
-        string viewkey     = remove_bad_chars(post_body["viewkey"]);
-
         // this will be only not empty when checking raw tx data
         // using tx pusher
-        string raw_tx_data = remove_bad_chars(post_body["raw_tx_data"]);
+        string raw_tx_data;
+        xmreg::get_form_field(post_body, "raw_tx_data", raw_tx_data);
 
         string domain      =  get_domain(req);
 
@@ -475,24 +686,23 @@ main(int ac, const char* av[])
         ([&](const crow::request& req) -> myxmr::htmlresponse 
          {
 
-            map<std::string, std::string> post_body
-                    = xmreg::parse_crow_post_data(req.body);
+            xmreg::form_fields post_body
+                    = xmreg::parse_form_data(req.body);
+
+            string tx_hash, tx_prv_key, xmr_address;
 
-            if (post_body.count("xmraddress") == 0
-                || post_body.count("txprvkey") == 0
-                || post_body.count("txhash") == 0)
+            if (!xmreg::get_form_field(post_body, "xmraddress", xmr_address)
+                || !xmreg::get_form_field(post_body, "txprvkey", tx_prv_key)
+                || !xmreg::get_form_field(post_body, "txhash", tx_hash))
             {
                 return string("xmr address, tx private key or "
                                       "tx hash not provided");
             }
 
-            string tx_hash     = remove_bad_chars(post_body["txhash"]);
-            string tx_prv_key  = remove_bad_chars(post_body["txprvkey"]);
-            string xmr_address = remove_bad_chars(post_body["xmraddress"]);
-
             // this will be only not empty when checking raw tx data
             // using tx pusher
-            string raw_tx_data = remove_bad_chars(post_body["raw_tx_data"]);
+            string raw_tx_data;
+            xmreg::get_form_field(post_body, "raw_tx_data", raw_tx_data);
 
             string domain      = get_domain(req);
 
@@ -530,18 +740,17 @@ main(int ac, const char* av[])
         ([&](const crow::request& req) -> myxmr::htmlresponse
          {
 
-            map<std::string, std::string> post_body
-                    = xmreg::parse_crow_post_data(req.body);
+            xmreg::form_fields post_body
+                    = xmreg::parse_form_data(req.body);
+
+            string raw_tx_data, action;
 
-            if (post_body.count("rawtxdata") == 0 
-                    || post_body.count("action") == 0)
+            if (!xmreg::get_form_field(post_body, "rawtxdata", raw_tx_data)
+                    || !xmreg::get_form_field(post_body, "action", action))
             {
                 return string("Raw tx data or action not provided");
             }
 
-            string raw_tx_data = remove_bad_chars(post_body["rawtxdata"]);
-            string action      = remove_bad_chars(post_body["action"]);
-
             if (action == "check")
                 return myxmr::htmlresponse(
                         xmrblocks.show_checkrawtx(raw_tx_data, action));
@@ -564,22 +773,21 @@ main(int ac, const char* av[])
         ([&](const crow::request& req) -> myxmr::htmlresponse
          {
 
-            map<std::string, std::string> post_body
-                    = xmreg::parse_crow_post_data(req.body);
+            xmreg::form_fields post_body
+                    = xmreg::parse_form_data(req.body);
+
+            string raw_data, viewkey;
 
-            if (post_body.count("rawkeyimgsdata") == 0)
+            if (!xmreg::get_form_field(post_body, "rawkeyimgsdata", raw_data))
             {
                 return string("Raw key images data not given");
             }
 
-            if (post_body.count("viewkey") == 0)
+            if (!xmreg::get_form_field(post_body, "viewkey", viewkey))
             {
                 return string("Viewkey not provided. Cant decrypt key image file without it");
             }
 
-            string raw_data = remove_bad_chars(post_body["rawkeyimgsdata"]);
-            string viewkey  = remove_bad_chars(post_body["viewkey"]);
-
             return myxmr::htmlresponse(
                     xmrblocks.show_checkrawkeyimgs(raw_data, viewkey));
         });
@@ -597,23 +805,22 @@ main(int ac, const char* av[])
         ([&](const crow::request& req) -> myxmr::htmlresponse
          {
 
-            map<std::string, std::string> post_body
-                    = xmreg::parse_crow_post_data(req.body);
+            xmreg::form_fields post_body
+                    = xmreg::parse_form_data(req.body);
 
-            if (post_body.count("rawoutputkeysdata") == 0)
+            string raw_data, viewkey;
+
+            if (!xmreg::get_form_field(post_body, "rawoutputkeysdata", raw_data))
             {
                 return string("Raw output keys data not given");
             }
 
-            if (post_body.count("viewkey") == 0)
+            if (!xmreg::get_form_field(post_body, "viewkey", viewkey))
             {
                 return string("Viewkey not provided. Cant decrypt "
                                       "key image file without it");
             }
 
-            string raw_data = remove_bad_chars(post_body["rawoutputkeysdata"]);
-            string viewkey  = remove_bad_chars(post_body["viewkey"]);
-
             return myxmr::htmlresponse(
                     xmrblocks.show_checkcheckrawoutput(raw_data, viewkey));
         });
@@ -657,19 +864,40 @@ main(int ac, const char* av[])
         cout << "Enable JSON API\n";
 
         CROW_ROUTE(app, "/api/transaction/<string>")
-        ([&](string tx_hash) {
+        ([&](const crow::request& req, string tx_hash) {
 
-            myxmr::jsonresponse r{xmrblocks.json_transaction(remove_bad_chars(tx_hash))};
+            tx_hash = remove_bad_chars(tx_hash);
 
-            return r;
+            return myxmr::cacheable_response(
+                    req, xmrblocks.get_tx_page_etag(tx_hash),
+                    myxmr::revalidate_cache_control, [&]() -> crow::response {
+
+                return myxmr::jsonresponse {xmrblocks.json_transaction(tx_hash)};
+            });
         });
 
         CROW_ROUTE(app, "/api/rawtransaction/<string>")
-        ([&](string tx_hash) {
+        ([&](const crow::request& req, string tx_hash) {
 
-            myxmr::jsonresponse r{xmrblocks.json_rawtransaction(remove_bad_chars(tx_hash))};
+            tx_hash = remove_bad_chars(tx_hash);
 
-            return r;
+            return myxmr::cacheable_response(
+                    req, xmrblocks.get_immutable_tx_etag(tx_hash),
+                    myxmr::immutable_cache_control, [&]() -> crow::response {
+
+                string response_str = xmrblocks.json_rawtransaction(tx_hash);
+
+                // tx of given hash never changes
+                if (tx_hash.size() == 64
+                        && boost::ends_with(response_str, "\"status\":\"success\"}"))
+                {
+                    return myxmr::immutable_jsonresponse(
+                            std::move(response_str), "rawtransaction/" + tx_hash,
+                            gzip_cache, compression);
+                }
+
+                return myxmr::jsonresponse {std::move(response_str)};
+            });
         });
 
         CROW_ROUTE(app, "/api/detailedtransaction/<string>")
@@ -681,19 +909,69 @@ main(int ac, const char* av[])
         });
 
         CROW_ROUTE(app, "/api/block/<string>")
-        ([&](string block_no_or_hash) {
+        ([&](const crow::request& req, string block_no_or_hash) {
 
-            myxmr::jsonresponse r{xmrblocks.json_block(remove_bad_chars(block_no_or_hash))};
+            block_no_or_hash = remove_bad_chars(block_no_or_hash);
 
-            return r;
+            string etag;
+
+            if (block_no_or_hash.size() == 64)
+            {
+                etag = xmrblocks.get_block_page_etag(block_no_or_hash);
+            }
+            else if (!block_no_or_hash.empty() && block_no_or_hash.size() <= 8
+                     && all_of(block_no_or_hash.begin(), block_no_or_hash.end(), ::isdigit))
+            {
+                etag = xmrblocks.get_block_page_etag(
+                        boost::lexical_cast<uint64_t>(block_no_or_hash));
+            }
+
+            return myxmr::cacheable_response(
+                    req, etag, myxmr::revalidate_cache_control,
+                    [&]() -> crow::response {
+
+                return myxmr::jsonresponse {xmrblocks.json_block(block_no_or_hash)};
+            });
         });
 
         CROW_ROUTE(app, "/api/rawblock/<string>")
-        ([&](string block_no_or_hash) {
+        ([&](const crow::request& req, string block_no_or_hash) {
 
-            myxmr::jsonresponse r{xmrblocks.json_rawblock(remove_bad_chars(block_no_or_hash))};
+            block_no_or_hash = remove_bad_chars(block_no_or_hash);
 
-            return r;
+            string etag;
+
+            // block at given height can change after a deep reorg
+            string cache_control {myxmr::revalidate_cache_control};
+
+            if (block_no_or_hash.size() == 64)
+            {
+                etag = xmrblocks.get_immutable_block_etag(block_no_or_hash);
+                cache_control = myxmr::immutable_cache_control;
+            }
+            else if (!block_no_or_hash.empty() && block_no_or_hash.size() <= 8
+                     && all_of(block_no_or_hash.begin(), block_no_or_hash.end(), ::isdigit))
+            {
+                etag = xmrblocks.get_immutable_block_etag(
+                        boost::lexical_cast<uint64_t>(block_no_or_hash));
+            }
+
+            return myxmr::cacheable_response(req, etag, cache_control,
+                                             [&]() -> crow::response {
+
+                string response_str = xmrblocks.json_rawblock(block_no_or_hash);
+
+                // block of given hash never changes, block of given height can
+                if (block_no_or_hash.size() == 64
+                        && boost::ends_with(response_str, "\"status\":\"success\"}"))
+                {
+                    return myxmr::immutable_jsonresponse(
+                            std::move(response_str), "rawblock/" + block_no_or_hash,
+                            gzip_cache, compression);
+                }
+
+                return myxmr::jsonresponse {std::move(response_str)};
+            });
         });
 
         CROW_ROUTE(app, "/api/transactions").methods("GET"_method)
@@ -753,6 +1031,14 @@ main(int ac, const char* av[])
             return r;
         });
 
+        CROW_ROUTE(app, "/api/emission/<uint>")
+        ([&](size_t blk_height) {
+
+            myxmr::jsonresponse r{xmrblocks.json_emission_at(blk_height)};
+
+            return r;
+        });
+
         CROW_ROUTE(app, "/api/outputs").methods("GET"_method)
         ([&](const crow::request &req) {
 
@@ -832,6 +1118,33 @@ main(int ac, const char* av[])
             return r;
         });
 
+        CROW_ROUTE(app, "/api/stats")
+        ([&]() {
+
+            myxmr::jsonresponse r{xmrblocks.json_stats()};
+
+            return r;
+        });
+
+        if (enable_key_image_checker)
+        {
+            CROW_ROUTE(app, "/api/checkrawkeyimgs").methods("POST"_method)
+            ([&](const crow::request& req) {
+
+                xmreg::form_fields post_body
+                        = xmreg::parse_form_data(req.body);
+
+                string raw_data, viewkey;
+
+                xmreg::get_form_field(post_body, "rawkeyimgsdata", raw_data);
+                xmreg::get_form_field(post_body, "viewkey", viewkey);
+
+                myxmr::jsonresponse r{xmrblocks.json_checkrawkeyimgs(raw_data, viewkey)};
+
+                return r;
+            });
+        }
+
     } // if (enable_json_api)
 
     if (enable_autorefresh_option)
@@ -879,6 +1192,32 @@ main(int ac, const char* av[])
         cout << "Emission monitoring thread finished." << endl;
     }
 
+    if (enable_index_snapshot == true)
+    {
+        cout << "Waiting for index snapshot thread to finish." << endl;
+
+        xmrblocks.stop_index_snapshot_thread();
+
+        cout << "Index snapshot thread finished." << endl;
+    }
+
+    if (enable_header_index == true)
+    {
+        cout << "Waiting for header index thread to finish." << endl;
+
+        xmrblocks.stop_header_index_thread();
+
+        cout << "Header index thread finished." << endl;
+    }
+
+    // finish worker threads
+
+    cout << "Waiting for worker threads to finish." << endl;
+
+    executor.stop();
+
+    cout << "Worker threads finished." << endl;
+
     // finish mempool thread
 
     cout << "Waiting for mempool monitoring thread to finish." << endl;
@@ -888,6 +1227,15 @@ main(int ac, const char* av[])
 
     cout << "Mempool monitoring thread finished." << endl;
 
+    // finish chain tip thread last, as others wait for its tips
+
+    cout << "Waiting for chain tip thread to finish." << endl;
+
+    xmreg::ChainTipWatcher::m_thread.interrupt();
+    xmreg::ChainTipWatcher::m_thread.join();
+
+    cout << "Chain tip thread finished." << endl;
+
     cout << "The explorer is terminating." << endl;
 
     return EXIT_SUCCESS;
@@ -0,0 +1,219 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#include "ChainTipWatcher.h"
+#include "ReadTxnScope.h"
+
+
+namespace xmreg
+{
+
+using namespace std;
+
+
+void
+ChainTipWatcher::set_blockchain_variables(Blockchain* _core_storage)
+{
+    core_storage = _core_storage;
+}
+
+void
+ChainTipWatcher::start_chain_tip_thread()
+{
+    if (is_running)
+        return;
+
+    // so that the tip is already known when
+    // others start using it
+    check_chain_tip();
+
+    m_thread = boost::thread{[]()
+    {
+        try
+        {
+            while (true)
+            {
+                boost::this_thread::sleep_for(
+                        boost::chrono::milliseconds(poll_interval));
+
+                check_chain_tip();
+            }
+        }
+        catch (boost::thread_interrupted&)
+        {
+            cout << "Chain tip thread interrupted." << endl;
+            return;
+        }
+    }};
+
+    is_running = true;
+}
+
+bool
+ChainTipWatcher::check_chain_tip()
+{
+    BlockchainDB& db = core_storage->get_db();
+
+    // only this thread changes current_tip,
+    // so it can read it without the lock
+    chain_tip new_tip;
+
+    std::deque<crypto::hash> new_recent_hashes;
+
+    // top hash, height and recent hashes from the same snapshot
+    {
+        ReadTxnScope rtxn_scope {db};
+
+        try
+        {
+            new_tip.height = db.height();
+
+            if (new_tip.height > 0)
+                new_tip.top_hash = db.top_block_hash();
+
+            if (new_tip.height == current_tip.height
+                    && new_tip.top_hash == current_tip.top_hash)
+                return false;
+
+            // recent_hashes are of blocks from recent_start
+            // to current_tip.height - 1
+            uint64_t recent_start = current_tip.height - recent_hashes.size();
+
+            uint64_t fork_height = std::min(current_tip.height, new_tip.height);
+
+            while (fork_height > recent_start
+                   && db.get_block_hash_from_height(fork_height - 1)
+                      != recent_hashes[fork_height - 1 - recent_start])
+            {
+                --fork_height;
+            }
+
+            // reorganization deeper than the recent hashes, or this is
+            // the first tip. Either way, all blocks could have changed.
+            if (fork_height == recent_start)
+                fork_height = 0;
+
+            new_tip.fork_height = fork_height;
+
+            for (uint64_t blk_height = new_tip.height
+                         - std::min(no_of_recent_hashes, new_tip.height);
+                 blk_height < new_tip.height; ++blk_height)
+            {
+                new_recent_hashes.push_back(
+                        db.get_block_hash_from_height(blk_height));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            cerr << "Cant read top of the blockchain: " << e.what() << endl;
+            return false;
+        }
+    }
+
+    uint64_t previous_height = current_tip.height;
+
+    new_tip.generation = current_tip.generation + 1;
+
+    {
+        boost::lock_guard<boost::mutex> lck (tip_mtx);
+
+        current_tip = new_tip;
+
+        generation = new_tip.generation;
+        height     = new_tip.height;
+    }
+
+    recent_hashes.swap(new_recent_hashes);
+
+    tip_cv.notify_all();
+
+    if (new_tip.generation > 1 && new_tip.fork_height < previous_height)
+    {
+        cout << "Blockchain reorganized from height "
+             << new_tip.fork_height << ", new height: "
+             << new_tip.height << endl;
+
+        notify_reorg_listeners(new_tip);
+    }
+
+    return true;
+}
+
+ChainTipWatcher::chain_tip
+ChainTipWatcher::get_chain_tip()
+{
+    boost::lock_guard<boost::mutex> lck (tip_mtx);
+
+    return current_tip;
+}
+
+uint64_t
+ChainTipWatcher::get_height()
+{
+    if (!is_running)
+        return core_storage->get_current_blockchain_height();
+
+    return height;
+}
+
+ChainTipWatcher::chain_tip
+ChainTipWatcher::wait_for_new_tip(uint64_t known_generation,
+                                  boost::chrono::milliseconds timeout)
+{
+    boost::unique_lock<boost::mutex> lck (tip_mtx);
+
+    tip_cv.wait_for(lck, timeout, [known_generation]()
+    {
+        return current_tip.generation != known_generation;
+    });
+
+    return current_tip;
+}
+
+bool
+ChainTipWatcher::is_thread_running()
+{
+    return is_running;
+}
+
+void
+ChainTipWatcher::add_reorg_listener(reorg_listener listener)
+{
+    boost::lock_guard<boost::mutex> lck (listeners_mtx);
+
+    reorg_listeners.push_back(std::move(listener));
+}
+
+void
+ChainTipWatcher::notify_reorg_listeners(chain_tip const& tip)
+{
+    boost::lock_guard<boost::mutex> lck (listeners_mtx);
+
+    for (reorg_listener const& listener: reorg_listeners)
+    {
+        try
+        {
+            listener(tip);
+        }
+        catch (const std::exception& e)
+        {
+            cerr << "Reorg listener failed: " << e.what() << endl;
+        }
+    }
+}
+
+uint64_t           ChainTipWatcher::poll_interval {250};
+uint64_t           ChainTipWatcher::no_of_recent_hashes {100};
+boost::thread      ChainTipWatcher::m_thread;
+atomic<bool>       ChainTipWatcher::is_running {false};
+Blockchain*        ChainTipWatcher::core_storage {nullptr};
+atomic<uint64_t>   ChainTipWatcher::generation {0};
+atomic<uint64_t>   ChainTipWatcher::height {0};
+boost::mutex       ChainTipWatcher::tip_mtx;
+boost::condition_variable ChainTipWatcher::tip_cv;
+ChainTipWatcher::chain_tip ChainTipWatcher::current_tip;
+std::deque<crypto::hash>   ChainTipWatcher::recent_hashes;
+boost::mutex               ChainTipWatcher::listeners_mtx;
+std::vector<ChainTipWatcher::reorg_listener> ChainTipWatcher::reorg_listeners;
+}
@@ -0,0 +1,128 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_CHAINTIPWATCHER_H
+#define XMRBLOCKS_CHAINTIPWATCHER_H
+
+#include "MicroCore.h"
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <iostream>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <functional>
+
+namespace xmreg
+{
+
+/**
+ * Watches top of the blockchain in lmdb and publishes each
+ * new block or reorganization as new chain tip, with
+ * increasing generation number.
+ *
+ * This is the only thread which polls lmdb for the top block.
+ * Others either check the generation to see if what they have
+ * cached is still for the current blockchain, or wait in
+ * wait_for_new_tip() to be woken up as soon as new block arrives.
+ * Caches of blocks can also add reorg listeners, to drop the
+ * blocks from fork_height up as soon as reorganization is found.
+ */
+struct ChainTipWatcher
+{
+
+    struct chain_tip;
+
+    using reorg_listener = std::function<void(chain_tip const&)>;
+
+    struct chain_tip
+    {
+        // increased by one for each new tip
+        uint64_t generation {0};
+
+        // number of blocks, i.e., height of top block + 1
+        uint64_t height {0};
+
+        crypto::hash top_hash {};
+
+        // height of the first block which differs from the
+        // previous tip. Equal to the previous height if blocks
+        // were only added, lower than that after reorganization.
+        uint64_t fork_height {0};
+    };
+
+    // how often lmdb is checked for new top block, in milliseconds
+    static uint64_t poll_interval;
+
+    // number of top block hashes kept to find where
+    // reorganization of the blockchain starts
+    static uint64_t no_of_recent_hashes;
+
+    static boost::thread m_thread;
+
+    static atomic<bool> is_running;
+
+    static Blockchain* core_storage;
+
+    // same as in current_tip, but readable without the lock
+    static atomic<uint64_t> generation;
+    static atomic<uint64_t> height;
+
+    static void
+    set_blockchain_variables(Blockchain* _core_storage);
+
+    static void
+    start_chain_tip_thread();
+
+    // reads top of the blockchain from lmdb and publishes
+    // new tip if it changed. Returns true if it did.
+    static bool
+    check_chain_tip();
+
+    static chain_tip
+    get_chain_tip();
+
+    // current blockchain height. Read from lmdb if the
+    // watcher thread is not running.
+    static uint64_t
+    get_height();
+
+    // blocks until there is tip with generation other than
+    // known_generation, or until timeout passes, and returns
+    // current tip. It is interruption point of boost::thread.
+    static chain_tip
+    wait_for_new_tip(uint64_t known_generation,
+                     boost::chrono::milliseconds timeout);
+
+    static bool
+    is_thread_running();
+
+    // listener is called by the watcher thread, after new tip
+    // with lower fork_height than the previous height is published
+    static void
+    add_reorg_listener(reorg_listener listener);
+
+private:
+
+    static void
+    notify_reorg_listeners(chain_tip const& tip);
+
+    static boost::mutex listeners_mtx;
+    static std::vector<reorg_listener> reorg_listeners;
+
+    static boost::mutex tip_mtx;
+    static boost::condition_variable tip_cv;
+
+    static chain_tip current_tip;
+
+    // hashes of the blocks just below current_tip.height, oldest
+    // first. Used only by the thread checking the chain tip.
+    static std::deque<crypto::hash> recent_hashes;
+};
+
+}
+#endif //XMRBLOCKS_CHAINTIPWATCHER_H
@@ -45,6 +45,12 @@ namespace xmreg
                  "enable users to have the index page on autorefresh")
                 ("enable-emission-monitor", value<bool>()->default_value(false)->implicit_value(true),
                  "enable Monero total emission monitoring thread")
+                ("emission-threads", value<size_t>()->default_value(0),
+                 "number of threads scanning the blockchain for emission. Default is 0 which means it is based on the cpu")
+                ("enable-index-snapshot", value<bool>()->default_value(false)->implicit_value(true),
+                 "enable preparing the front page in advance by a separate thread")
+                ("enable-header-index", value<bool>()->default_value(false)->implicit_value(true),
+                 "enable keeping hash, timestamp, weight, cumulative difficulty and number of txs of all blocks in memory")
                 ("port,p", value<string>()->default_value("8081"),
                  "default explorer port")
                 ("bindaddr,x", value<string>()->default_value("0.0.0.0"),
@@ -63,6 +69,24 @@ namespace xmreg
                  "time, in seconds, for each refresh of mempool state")
                 ("concurrency,c", value<size_t>()->default_value(0),
                  "number of threads handling http queries. Default is 0 which means it is based you on the cpu")
+                ("worker-threads", value<size_t>()->default_value(0),
+                 "number of worker threads for background tasks of http queries, including rpc calls to the deamon. An rpc call keeps its thread busy at most --daemon-rpc-timeout. Default is 0 which means it is based on the cpu")
+                ("worker-queue-size", value<size_t>()->default_value(256),
+                 "maximum number of tasks waiting for worker threads. When full, tasks are done in http query threads")
+                ("block-cache-size", value<size_t>()->default_value(1000),
+                 "number of decoded blocks kept in memory for the front page and /api/transactions")
+                ("ring-member-cache-size", value<size_t>()->default_value(100000),
+                 "number of resolved ring members kept in memory for mixin details of txs")
+                ("daemon-rpc-connections", value<size_t>()->default_value(4),
+                 "number of persistent rpc connections to the deamon, shared by all http queries")
+                ("daemon-rpc-timeout", value<size_t>()->default_value(10000),
+                 "maximum time, in milliseconds, of a single rpc call to the deamon, including waiting for a free connection")
+                ("compression-level", value<int>()->default_value(6),
+                 "zlib level, from 1 to 9, of gzip/deflate compression of http responses. -1 is default level of zlib, and 0 disables the compression")
+                ("compression-min-size", value<size_t>()->default_value(1024),
+                 "http responses smaller than that many bytes are not compressed")
+                ("max-body-size", value<size_t>()->default_value(16777216),
+                 "http requests with larger bodies, in bytes, are rejected. 0 means no limit")
                 ("bc-path,b", value<string>(),
                  "path to lmdb folder of the blockchain, e.g., ~/.bitmonero/lmdb")
                 ("ssl-crt-file", value<string>(),
@@ -25,25 +25,47 @@ CurrentBlockchainStatus::start_monitor_blockchain_thread()
 {
     total_emission_atomic = Emission {0, 0, 0};
 
-    string emmision_saved_file = get_output_file_path().string();
+    if (no_of_scan_threads == 0)
+        no_of_scan_threads = std::max<uint64_t>(
+                    boost::thread::hardware_concurrency(), 1);
+
+    current_height = core_storage->get_current_blockchain_height();
+
+    if (!emission_index.open(get_index_file_path()))
+    {
+        cerr << "Emission index cant be opened: " << get_index_file_path()
+             << "\nEmission monitoring thread is not started." << endl;
+        return;
+    }
 
-    // read stored emission data if possible
-    if (boost::filesystem::exists(emmision_saved_file))
+    // read stored emission checkpoints if possible. Chunks which
+    // cant be read or are not in the blockchain anymore
+    // are just going to be scanned again.
+    if (boost::filesystem::exists(get_checkpoint_file_path()))
     {
-        if (!load_current_emission_amount())
+        if (!load_emission_checkpoints())
         {
-            cerr << "Emission file cant be read, got corrupted or has incorrect format:\n " << emmision_saved_file
-                 << "\nEmission monitoring thread is not started.\nDelete the file and"
-                 << " restart the explorer or disable emission monitoring."
+            cerr << "Emission checkpoints file cant be read fully: "
+                 << get_checkpoint_file_path()
+                 << "\nUnreadable chunks will be scanned again."
                  << endl;
-
-            cerr << "Press ENTER to continue without emission monitoring or Ctr+C to exit" << endl;
-
-            cin.get();
-
-            return;
         }
     }
+    else if (boost::filesystem::exists(get_output_file_path()))
+    {
+        // emission_amount.txt of older versions has only the
+        // total, which is not enough for the chunks and the index
+        cout << "Emission checkpoints not found, only "
+             << get_output_file_path()
+             << " of older version. Whole blockchain is going to be"
+             << " scanned for emission again." << endl;
+    }
+
+    // the index must have exactly the blocks in the chunks,
+    // as the tail is calculated again anyway
+    emission_index.truncate(std::min<uint64_t>(
+            emission_index.size(),
+            emission_chunks.size() * blockchain_chunk_size));
 
     if (!is_running)
     {
@@ -53,29 +75,38 @@ CurrentBlockchainStatus::start_monitor_blockchain_thread()
                {
                    while (true)
                    {
-                       Emission current_emission = total_emission_atomic;
+                       uint64_t tip_generation = ChainTipWatcher::generation;
 
-                       current_height = core_storage->get_current_blockchain_height();
+                       current_height = ChainTipWatcher::get_height();
 
-                       // scan 10000 blocks for emissiom or if we are at the top of
+                       // scan next few chunks of blocks for emission in
+                       // parallel, or if we are at the top of
                        // the blockchain, only few top blocks
                        update_current_emission_amount();
 
-                       cout << "current emission: " << string(current_emission) << endl;
+                       Emission current_emission = total_emission_atomic;
+
+                       cout << "current emission: " << string(current_emission)
+                            << ", scanning speed: "
+                            << static_cast<uint64_t>(scan_blocks_per_second)
+                            << " blocks/s" << endl;
 
                        save_current_emission_amount();
 
-                       if (current_emission.blk_no < current_height - blockchain_chunk_size)
+                       if (current_emission.blk_no + blockchain_chunk_size
+                               < current_height)
                        {
-                           // while we scan the blockchain from scrach, every 10000
-                           // blocks take 1 second break
-                           boost::this_thread::sleep_for(boost::chrono::seconds(1));
+                           // while we scan the blockchain from scrach,
+                           // dont wait, just check if we should stop
+                           boost::this_thread::interruption_point();
                        }
                        else
                        {
                            // when we reach top of the blockchain, update
-                           // the emission amount every minute.
-                           boost::this_thread::sleep_for(boost::chrono::seconds(60));
+                           // the emission amount as soon as new block
+                           // arrives, or at least every minute.
+                           ChainTipWatcher::wait_for_new_tip(
+                                   tip_generation, boost::chrono::seconds(60));
                        }
 
                    } // while (true)
@@ -97,38 +128,109 @@ CurrentBlockchainStatus::start_monitor_blockchain_thread()
 void
 CurrentBlockchainStatus::update_current_emission_amount()
 {
-
-    Emission current_emission = total_emission_atomic;
-
-    uint64_t blk_no = current_emission.blk_no;
-
-    uint64_t end_block = blk_no + blockchain_chunk_size;
-
     uint64_t current_blockchain_height = current_height;
 
     // blockchain_chunk_gap is used so that we
     // never read and store few top blocks
     // the emission in the top few blocks will be calcalted
     // later
-    end_block = end_block > current_blockchain_height
-                ? current_blockchain_height - blockchain_chunk_gap
-                : end_block;
+    if (current_blockchain_height <= blockchain_chunk_gap)
+        return;
+
+    uint64_t end_block = current_blockchain_height - blockchain_chunk_gap;
+
+    remove_reorganized_chunks();
+
+    uint64_t no_of_full_chunks = end_block / blockchain_chunk_size;
 
-    Emission emission_calculated = calculate_emission_in_blocks(blk_no, end_block);
+    if (emission_chunks.size() < no_of_full_chunks)
+    {
+        // drop the tail from the index, as the
+        // chunks are appended there first
+        emission_index.truncate(std::min<uint64_t>(
+                emission_index.size(),
+                emission_chunks.size() * blockchain_chunk_size));
+
+        // scan only as many chunks as we have threads, so that
+        // the progress is saved often and the thread can be
+        // interrupted between the chunks.
+        uint64_t end_chunk = std::min<uint64_t>(
+                    no_of_full_chunks,
+                    emission_chunks.size() + no_of_scan_threads);
+
+        scan_emission_chunks(emission_chunks.size(), end_chunk);
+
+        save_emission_checkpoints();
+    }
+
+    uint64_t tail_start_blk = emission_chunks.size() * blockchain_chunk_size;
+
+    // tail is rescanned from its begining if
+    // chunks below it or its blocks have changed
+    if (tail_emission.blk_no < tail_start_blk
+            || (tail_emission.blk_no > tail_start_blk
+                && core_storage->get_block_id_by_height(tail_emission.blk_no - 1)
+                   != tail_last_blk_hash))
+    {
+        tail_emission = Emission {0, 0, tail_start_blk};
+    }
+
+    // index should end where the tail does, if it
+    // does not, we just calculate the tail again
+    if (emission_index.size() != tail_emission.blk_no)
+    {
+        tail_emission = Emission {0, 0, tail_start_blk};
+
+        emission_index.truncate(std::min<uint64_t>(
+                emission_index.size(), tail_start_blk));
+    }
+
+    // tail is calcualted only when all full chunks are done
+    if (emission_chunks.size() == no_of_full_chunks
+            && tail_emission.blk_no < end_block)
+    {
+        vector<EmissionIndex::entry> blk_emissions;
+
+        Emission emission_calculated
+                = calculate_emission_in_blocks(tail_emission.blk_no, end_block,
+                                               &blk_emissions);
+
+        emission_index.append(blk_emissions);
+
+        tail_emission.coinbase += emission_calculated.coinbase;
+        tail_emission.fee      += emission_calculated.fee;
+        tail_emission.blk_no    = emission_calculated.blk_no;
+
+        tail_last_blk_hash = core_storage->get_block_id_by_height(
+                    tail_emission.blk_no - 1);
+    }
+
+    // sum of all chunks and the tail above them
+    Emission current_emission {0, 0, tail_emission.blk_no};
+
+    for (const EmissionChunk& chunk: emission_chunks)
+    {
+        current_emission.coinbase += chunk.coinbase;
+        current_emission.fee      += chunk.fee;
+    }
 
-    current_emission.coinbase += emission_calculated.coinbase;
-    current_emission.fee      += emission_calculated.fee;
-    current_emission.blk_no    = emission_calculated.blk_no;
+    current_emission.coinbase += tail_emission.coinbase;
+    current_emission.fee      += tail_emission.fee;
 
     total_emission_atomic = current_emission;
 }
 
 CurrentBlockchainStatus::Emission
 CurrentBlockchainStatus::calculate_emission_in_blocks(
-        uint64_t start_blk, uint64_t end_blk)
+        uint64_t start_blk, uint64_t end_blk,
+        vector<EmissionIndex::entry>* blk_emissions)
 {
     Emission emission_calculated {0, 0, 0};
 
+    if (blk_emissions)
+        blk_emissions->reserve(blk_emissions->size()
+                               + (end_blk > start_blk ? end_blk - start_blk : 0));
+
     while (start_blk < end_blk)
     {
         block blk;
@@ -154,6 +256,10 @@ CurrentBlockchainStatus::calculate_emission_in_blocks(
         emission_calculated.coinbase += coinbase_amount - tx_fee_amount;
         emission_calculated.fee      += tx_fee_amount;
 
+        if (blk_emissions)
+            blk_emissions->push_back({coinbase_amount - tx_fee_amount,
+                                      tx_fee_amount});
+
         ++start_blk;
     }
 
@@ -163,6 +269,125 @@ CurrentBlockchainStatus::calculate_emission_in_blocks(
 }
 
 
+void
+CurrentBlockchainStatus::scan_emission_chunks(
+        uint64_t first_chunk, uint64_t end_chunk)
+{
+    if (first_chunk >= end_chunk)
+        return;
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    // each thread scans its own chunks and puts them
+    // here, so that they can be merged in order below.
+    vector<EmissionChunk> scanned_chunks(end_chunk - first_chunk);
+
+    // and emission of each block in the chunks, for the index
+    vector<vector<EmissionIndex::entry>> scanned_blk_emissions(
+                end_chunk - first_chunk);
+
+    std::atomic<uint64_t> next_chunk {first_chunk};
+
+    auto scan_chunks = [&]()
+    {
+        uint64_t chunk_no;
+
+        while ((chunk_no = next_chunk++) < end_chunk)
+        {
+            uint64_t start_blk = chunk_no * blockchain_chunk_size;
+            uint64_t end_blk   = start_blk + blockchain_chunk_size;
+
+            EmissionChunk& chunk = scanned_chunks[chunk_no - first_chunk];
+
+            // hash is taken before the scan, so that if the chunk
+            // gets reorganized while we scan it, it is going to be
+            // detected next time and scanned again.
+            chunk.chunk_no      = chunk_no;
+            chunk.last_blk_hash = core_storage->get_block_id_by_height(end_blk - 1);
+
+            Emission emission_calculated
+                    = calculate_emission_in_blocks(
+                        start_blk, end_blk,
+                        &scanned_blk_emissions[chunk_no - first_chunk]);
+
+            chunk.coinbase = emission_calculated.coinbase;
+            chunk.fee      = emission_calculated.fee;
+
+            no_of_scanned_blocks += blockchain_chunk_size;
+
+            boost::this_thread::interruption_point();
+        }
+    };
+
+    boost::thread_group scanning_threads;
+
+    try
+    {
+        uint64_t no_of_threads = std::min<uint64_t>(
+                    no_of_scan_threads, end_chunk - first_chunk);
+
+        for (uint64_t i = 0; i < no_of_threads; ++i)
+            scanning_threads.create_thread(scan_chunks);
+
+        scanning_threads.join_all();
+    }
+    catch (boost::thread_interrupted&)
+    {
+        // dont leave threads refering to local variables
+        scanning_threads.interrupt_all();
+        scanning_threads.join_all();
+        throw;
+    }
+
+    for (size_t i = 0; i < scanned_chunks.size(); ++i)
+    {
+        // chunk is used only if its blocks are in the index
+        if (!emission_index.append(scanned_blk_emissions[i]))
+        {
+            cerr << "Cant add emission chunk " << scanned_chunks[i].chunk_no
+                 << " to the index" << endl;
+            break;
+        }
+
+        emission_chunks.push_back(scanned_chunks[i]);
+    }
+
+    double scan_time = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start_time).count();
+
+    if (scan_time > 0)
+        scan_blocks_per_second = (end_chunk - first_chunk)
+                                 * blockchain_chunk_size / scan_time;
+}
+
+
+void
+CurrentBlockchainStatus::remove_reorganized_chunks()
+{
+    // reorganizations happen at the top of the blockchain,
+    // so we go from the last chunk down, until its last
+    // block is still in the blockchain.
+    while (!emission_chunks.empty())
+    {
+        const EmissionChunk& chunk = emission_chunks.back();
+
+        uint64_t last_blk = (chunk.chunk_no + 1) * blockchain_chunk_size - 1;
+
+        if (last_blk < current_height
+                && core_storage->get_block_id_by_height(last_blk)
+                   == chunk.last_blk_hash)
+        {
+            break;
+        }
+
+        cout << "Emission chunk " << chunk.chunk_no
+             << " got reorganized. Scanning it again." << endl;
+
+        emission_chunks.pop_back();
+    }
+}
+
+
 bool
 CurrentBlockchainStatus::save_current_emission_amount()
 {
@@ -186,59 +411,163 @@ CurrentBlockchainStatus::save_current_emission_amount()
 
 
 bool
-CurrentBlockchainStatus::load_current_emission_amount()
+CurrentBlockchainStatus::save_emission_checkpoints()
 {
-    string emmision_saved_file = get_output_file_path().string();
+    string checkpoint_saved_file = get_checkpoint_file_path().string();
 
-    string last_saved_emmision = xmreg::read(emmision_saved_file);
+    // write to temporary file first, so that we dont end up with
+    // half written checkpoints if we get killed in the middle.
+    string tmp_file = checkpoint_saved_file + ".tmp";
 
-    if (last_saved_emmision.empty())
     {
-        cerr << "Couldn't open file." << endl;
-        return false;
+        ofstream out(tmp_file);
+
+        if( !out )
+        {
+            cerr << "Couldn't open file: " << tmp_file << endl;
+            return false;
+        }
+
+        for (const EmissionChunk& chunk: emission_chunks)
+            out << string(chunk) << '\n';
+
+        out << flush;
+
+        if (!out)
+        {
+            cerr << "Couldn't write file: " << tmp_file << endl;
+            return false;
+        }
     }
 
-    last_saved_emmision.erase(last_saved_emmision.find_last_not_of(" \n\r\t")+1);
+    boost::system::error_code ec;
 
-    vector<string> strs;
-    boost::split(strs, last_saved_emmision, boost::is_any_of(","));
+    boost::filesystem::rename(tmp_file, checkpoint_saved_file, ec);
 
-    if (strs.empty())
+    if (ec)
     {
-        cerr << "Problem spliting string values form  emission_amount." << endl;
+        cerr << "Couldn't rename " << tmp_file << ": " << ec.message() << endl;
         return false;
     }
 
-    Emission emission_loaded {0, 0, 0};
+    return true;
+}
 
-    uint64_t read_check_sum {0};
 
-    try
+bool
+CurrentBlockchainStatus::load_emission_checkpoints()
+{
+    string checkpoint_saved_file = get_checkpoint_file_path().string();
+
+    ifstream in(checkpoint_saved_file);
+
+    if (!in)
     {
-        emission_loaded.blk_no   = boost::lexical_cast<uint64_t>(strs.at(0));
-        emission_loaded.coinbase = boost::lexical_cast<uint64_t>(strs.at(1));
-        emission_loaded.fee      = boost::lexical_cast<uint64_t>(strs.at(2));
-        read_check_sum           = boost::lexical_cast<uint64_t>(strs.at(3));
+        cerr << "Couldn't open file: " << checkpoint_saved_file << endl;
+        return false;
     }
-    catch (boost::bad_lexical_cast &e)
+
+    emission_chunks.clear();
+
+    string line;
+
+    while (std::getline(in, line))
     {
-        cerr << "Cant parse to number date from string: " << last_saved_emmision << endl;
-        return false;
+        line.erase(line.find_last_not_of(" \n\r\t")+1);
+
+        if (line.empty())
+            continue;
+
+        vector<string> strs;
+        boost::split(strs, line, boost::is_any_of(","));
+
+        if (strs.size() != 5)
+        {
+            cerr << "Problem spliting values of emission chunk: " << line << endl;
+            return false;
+        }
+
+        EmissionChunk chunk;
+
+        uint64_t read_check_sum {0};
+
+        try
+        {
+            chunk.chunk_no = boost::lexical_cast<uint64_t>(strs[0]);
+            chunk.coinbase = boost::lexical_cast<uint64_t>(strs[1]);
+            chunk.fee      = boost::lexical_cast<uint64_t>(strs[2]);
+            read_check_sum = boost::lexical_cast<uint64_t>(strs[4]);
+        }
+        catch (boost::bad_lexical_cast &e)
+        {
+            cerr << "Cant parse to number date from string: " << line << endl;
+            return false;
+        }
+
+        if (!epee::string_tools::hex_to_pod(strs[3], chunk.last_blk_hash))
+        {
+            cerr << "Cant parse block hash from string: " << line << endl;
+            return false;
+        }
+
+        if (read_check_sum != chunk.checksum())
+        {
+            cerr << "read_check_sum != check_sum: "
+                 << read_check_sum << " != " << chunk.checksum()
+                 << endl;
+
+            return false;
+        }
+
+        // chunks must be stored in order, without gaps
+        if (chunk.chunk_no != emission_chunks.size())
+        {
+            cerr << "Emission chunk " << chunk.chunk_no
+                 << " out of order" << endl;
+            return false;
+        }
+
+        emission_chunks.push_back(chunk);
     }
 
-    if (read_check_sum != emission_loaded.checksum())
+    // drop chunks which are not in the blockchain anymore
+    remove_reorganized_chunks();
+
+    // and those which dont match the emission index,
+    // so that they are scanned and indexed again.
+    Emission cumulative {0, 0, 0};
+
+    for (size_t i = 0; i < emission_chunks.size(); ++i)
     {
-        cerr << "read_check_sum != check_sum: "
-             << read_check_sum << " != " << emission_loaded.checksum()
-             << endl;
+        cumulative.coinbase += emission_chunks[i].coinbase;
+        cumulative.fee      += emission_chunks[i].fee;
 
-        return false;
+        EmissionIndex::entry indexed;
+
+        if (!emission_index.get((i + 1) * blockchain_chunk_size - 1, indexed)
+                || indexed.coinbase != cumulative.coinbase
+                || indexed.fee      != cumulative.fee)
+        {
+            cout << "Emission chunk " << i
+                 << " is not in the emission index. Scanning it again." << endl;
+
+            emission_chunks.resize(i);
+            break;
+        }
+    }
+
+    Emission emission_loaded {0, 0,
+                emission_chunks.size() * blockchain_chunk_size};
+
+    for (const EmissionChunk& chunk: emission_chunks)
+    {
+        emission_loaded.coinbase += chunk.coinbase;
+        emission_loaded.fee      += chunk.fee;
     }
 
     total_emission_atomic = emission_loaded;
 
     return true;
-
 }
 
 bf::path
@@ -247,6 +576,18 @@ CurrentBlockchainStatus::get_output_file_path()
     return blockchain_path / output_file;
 }
 
+bf::path
+CurrentBlockchainStatus::get_checkpoint_file_path()
+{
+    return blockchain_path / checkpoint_file;
+}
+
+bf::path
+CurrentBlockchainStatus::get_index_file_path()
+{
+    return blockchain_path / index_file;
+}
+
 
 CurrentBlockchainStatus::Emission
 CurrentBlockchainStatus::get_emission()
@@ -303,16 +644,34 @@ cryptonote::network_type CurrentBlockchainStatus::nettype {cryptonote::network_t
 
 string CurrentBlockchainStatus::output_file {"emission_amount.txt"};
 
+string CurrentBlockchainStatus::checkpoint_file {"emission_checkpoints.txt"};
+
+string CurrentBlockchainStatus::index_file {"emission_index.bin"};
+
 string CurrentBlockchainStatus::deamon_url {"http:://127.0.0.1:18081"};
 
 uint64_t  CurrentBlockchainStatus::blockchain_chunk_size {10000};
 
 uint64_t  CurrentBlockchainStatus::blockchain_chunk_gap {3};
 
+uint64_t  CurrentBlockchainStatus::no_of_scan_threads {0};
+
 atomic<uint64_t> CurrentBlockchainStatus::current_height {0};
 
 atomic<CurrentBlockchainStatus::Emission> CurrentBlockchainStatus::total_emission_atomic;
 
+vector<CurrentBlockchainStatus::EmissionChunk> CurrentBlockchainStatus::emission_chunks;
+
+CurrentBlockchainStatus::Emission CurrentBlockchainStatus::tail_emission {0, 0, 0};
+
+crypto::hash      CurrentBlockchainStatus::tail_last_blk_hash {};
+
+EmissionIndex    CurrentBlockchainStatus::emission_index;
+
+atomic<uint64_t> CurrentBlockchainStatus::no_of_scanned_blocks {0};
+
+atomic<double>   CurrentBlockchainStatus::scan_blocks_per_second {0};
+
 boost::thread      CurrentBlockchainStatus::m_thread;
 
 atomic<bool>     CurrentBlockchainStatus::is_running {false};
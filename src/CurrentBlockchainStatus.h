@@ -6,6 +6,8 @@
 #define XMRBLOCKS_CURRENTBLOCKCHAINSTATUS_H
 
 #include "MicroCore.h"
+#include "EmissionIndex.h"
+#include "ChainTipWatcher.h"
 
 #include <boost/algorithm/string.hpp>
 
@@ -14,6 +16,9 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstring>
 
 namespace xmreg
 {
@@ -45,17 +50,64 @@ struct CurrentBlockchainStatus
         }
     };
 
+    // emission in one chunk of blockchain_chunk_size blocks, i.e.,
+    // in blocks [chunk_no * blockchain_chunk_size,
+    //            (chunk_no + 1) * blockchain_chunk_size)
+    // these are stored in checkpoint file, so that after restart or
+    // blockchain reorganization only affected chunks are rescanned.
+    struct EmissionChunk
+    {
+        uint64_t chunk_no;
+        uint64_t coinbase;
+        uint64_t fee;
+
+        // hash of last block in the chunk, to
+        // detect if the chunk got reorganized
+        crypto::hash last_blk_hash;
+
+        inline uint64_t
+        checksum() const
+        {
+            uint64_t hash_words[sizeof(crypto::hash) / sizeof(uint64_t)];
+
+            memcpy(hash_words, &last_blk_hash, sizeof(hash_words));
+
+            uint64_t sum = chunk_no + coinbase + fee;
+
+            for (uint64_t word: hash_words)
+                sum += word;
+
+            return sum;
+        }
+
+        operator
+        std::string() const
+        {
+            return to_string(chunk_no) + "," + to_string(coinbase)
+                   + "," + to_string(fee) + "," + epee::string_tools::pod_to_hex(last_blk_hash)
+                   + "," + to_string(checksum());
+        }
+    };
+
     static bf::path blockchain_path;
 
     static cryptonote::network_type nettype;
 
     static string output_file;
 
+    static string checkpoint_file;
+
+    static string index_file;
+
     static string deamon_url;
 
-    // how many blocks to read before thread goes to sleep
+    // how many blocks are in each emission chunk
     static uint64_t blockchain_chunk_size;
 
+    // how many threads scan the chunks in parallel.
+    // 0 means it is based on the cpu
+    static uint64_t no_of_scan_threads;
+
     // gap from what we store total_emission_atomic and
     // current blockchain height. We dont want to store
     // what is on, e.g., top block, as this can get messy
@@ -71,6 +123,23 @@ struct CurrentBlockchainStatus
 
     static atomic<Emission> total_emission_atomic;
 
+    // emission of all full chunks scanned so far, in order.
+    // accessed only from the monitoring thread.
+    static vector<EmissionChunk> emission_chunks;
+
+    // emission of blocks above the last full chunk, up to
+    // current_height - blockchain_chunk_gap, and hash of its last
+    // block. accessed only from the monitoring thread.
+    static Emission tail_emission;
+    static crypto::hash tail_last_blk_hash;
+
+    // cumulative emission of each block
+    static EmissionIndex emission_index;
+
+    // progress of the scanning
+    static atomic<uint64_t> no_of_scanned_blocks;
+    static atomic<double> scan_blocks_per_second;
+
 
     static boost::thread m_thread;
 
@@ -90,14 +159,26 @@ struct CurrentBlockchainStatus
     static void
     update_current_emission_amount();
 
+    // if blk_emissions is given, emission of each
+    // block is also pushed into it
     static Emission
-    calculate_emission_in_blocks(uint64_t start_blk, uint64_t end_blk);
+    calculate_emission_in_blocks(uint64_t start_blk, uint64_t end_blk,
+                                 vector<EmissionIndex::entry>* blk_emissions = nullptr);
+
+    static void
+    scan_emission_chunks(uint64_t first_chunk, uint64_t end_chunk);
+
+    static void
+    remove_reorganized_chunks();
 
     static bool
     save_current_emission_amount();
 
     static bool
-    load_current_emission_amount();
+    save_emission_checkpoints();
+
+    static bool
+    load_emission_checkpoints();
 
     static Emission
     get_emission();
@@ -105,6 +186,12 @@ struct CurrentBlockchainStatus
     static bf::path
     get_output_file_path();
 
+    static bf::path
+    get_checkpoint_file_path();
+
+    static bf::path
+    get_index_file_path();
+
     static bool
     is_thread_running();
 };
@@ -0,0 +1,285 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#include "EmissionIndex.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+namespace xmreg
+{
+
+using namespace std;
+
+namespace bip = boost::interprocess;
+
+constexpr uint64_t EmissionIndex::PAGE_SIZE;
+constexpr uint64_t EmissionIndex::ENTRIES_PER_PAGE;
+
+// file grows by this many pages at a time, i.e., 1MB,
+// so that we dont remap it with each new block
+static constexpr uint64_t PAGES_PER_GROWTH {256};
+
+
+bool
+EmissionIndex::open(const bf::path& _file_path)
+{
+    file_path = _file_path;
+
+    if (!bf::exists(file_path))
+    {
+        ofstream out(file_path.string(), ios::binary);
+
+        if (!out)
+        {
+            cerr << "Couldn't create emission index: " << file_path << endl;
+            return false;
+        }
+    }
+
+    boost::system::error_code ec;
+
+    uint64_t file_size = bf::file_size(file_path, ec);
+
+    if (ec)
+    {
+        cerr << "Couldn't get size of emission index: "
+             << file_path << ", " << ec.message() << endl;
+        return false;
+    }
+
+    uint64_t no_of_pages = file_size / PAGE_SIZE;
+
+    if (!reserve(std::max<uint64_t>(no_of_pages, 1)))
+        return false;
+
+    region_ptr mapped = std::atomic_load(&region);
+
+    // count entries in the pages which are fine. The
+    // last page is the first one which is not full.
+    uint64_t verified_entries {0};
+
+    for (uint64_t page_no = 0; page_no < no_of_pages; ++page_no)
+    {
+        const page_trailer* trailer = get_trailer(mapped, page_no);
+
+        if (trailer->no_of_entries > ENTRIES_PER_PAGE
+                || trailer->checksum != page_checksum(
+                        page_no, get_entry(mapped, page_no * ENTRIES_PER_PAGE),
+                        trailer->no_of_entries))
+        {
+            cerr << "Emission index page " << page_no
+                 << " is corrupted. Blocks from "
+                 << verified_entries << " will be scanned again." << endl;
+            break;
+        }
+
+        verified_entries += trailer->no_of_entries;
+
+        if (trailer->no_of_entries < ENTRIES_PER_PAGE)
+            break;
+    }
+
+    no_of_entries = verified_entries;
+
+    // so that corrupted page, if any, is marked as last
+    return truncate(verified_entries);
+}
+
+bool
+EmissionIndex::is_open() const
+{
+    return std::atomic_load(&region) != nullptr;
+}
+
+uint64_t
+EmissionIndex::size() const
+{
+    return no_of_entries;
+}
+
+bool
+EmissionIndex::get(uint64_t blk_height, entry& cumulative) const
+{
+    if (blk_height >= no_of_entries)
+        return false;
+
+    region_ptr mapped = std::atomic_load(&region);
+
+    if (!mapped)
+        return false;
+
+    std::memcpy(&cumulative, get_entry(mapped, blk_height), sizeof(entry));
+
+    return true;
+}
+
+bool
+EmissionIndex::append(const vector<entry>& blk_emissions)
+{
+    if (blk_emissions.empty())
+        return true;
+
+    uint64_t start_size = no_of_entries;
+    uint64_t new_size   = start_size + blk_emissions.size();
+
+    // one more page, as the trailer of the page
+    // after the last entry is always written
+    if (!reserve(new_size / ENTRIES_PER_PAGE + 1))
+        return false;
+
+    region_ptr mapped = std::atomic_load(&region);
+
+    entry cumulative {0, 0};
+
+    if (start_size > 0)
+        cumulative = *get_entry(mapped, start_size - 1);
+
+    for (uint64_t i = 0; i < blk_emissions.size(); ++i)
+    {
+        cumulative.coinbase += blk_emissions[i].coinbase;
+        cumulative.fee      += blk_emissions[i].fee;
+
+        *get_entry(mapped, start_size + i) = cumulative;
+    }
+
+    for (uint64_t page_no = start_size / ENTRIES_PER_PAGE;
+         page_no <= new_size / ENTRIES_PER_PAGE; ++page_no)
+    {
+        uint64_t page_entries = std::min<uint64_t>(
+                    new_size - page_no * ENTRIES_PER_PAGE,
+                    ENTRIES_PER_PAGE);
+
+        write_trailer(page_no, page_entries);
+    }
+
+    // readers see new entries only now
+    no_of_entries = new_size;
+
+    return true;
+}
+
+bool
+EmissionIndex::truncate(uint64_t new_size)
+{
+    if (new_size > no_of_entries)
+        return false;
+
+    // readers dont see dropped entries from now on
+    no_of_entries = new_size;
+
+    if (!reserve(new_size / ENTRIES_PER_PAGE + 1))
+        return false;
+
+    // page with the new last entry is not full anymore, so
+    // when the index is opened next time, all pages after it
+    // are ignored.
+    write_trailer(new_size / ENTRIES_PER_PAGE,
+                  new_size % ENTRIES_PER_PAGE);
+
+    return true;
+}
+
+bool
+EmissionIndex::reserve(uint64_t no_of_pages)
+{
+    if (no_of_pages <= no_of_mapped_pages)
+        return true;
+
+    no_of_pages = (no_of_pages + PAGES_PER_GROWTH - 1)
+                  / PAGES_PER_GROWTH * PAGES_PER_GROWTH;
+
+    try
+    {
+        boost::system::error_code ec;
+
+        uint64_t file_size = bf::file_size(file_path, ec);
+
+        if (ec)
+        {
+            cerr << "Couldn't get size of emission index: "
+                 << file_path << ", " << ec.message() << endl;
+            return false;
+        }
+
+        // the file never shrinks. Readers may still use old
+        // mapping, and accessing it beyond the end of the
+        // file would kill the explorer.
+        if (file_size < no_of_pages * PAGE_SIZE)
+            bf::resize_file(file_path, no_of_pages * PAGE_SIZE);
+
+        bip::file_mapping file (file_path.string().c_str(), bip::read_write);
+
+        region_ptr new_region = std::make_shared<bip::mapped_region>(
+                    file, bip::read_write, 0, no_of_pages * PAGE_SIZE);
+
+        std::atomic_store(&region, new_region);
+
+        no_of_mapped_pages = no_of_pages;
+    }
+    catch (std::exception const& e)
+    {
+        cerr << "Couldn't map emission index: "
+             << file_path << ", " << e.what() << endl;
+        return false;
+    }
+
+    return true;
+}
+
+void
+EmissionIndex::write_trailer(uint64_t page_no, uint64_t no_of_entries)
+{
+    region_ptr mapped = std::atomic_load(&region);
+
+    page_trailer* trailer = get_trailer(mapped, page_no);
+
+    trailer->no_of_entries = no_of_entries;
+    trailer->checksum      = page_checksum(
+                page_no, get_entry(mapped, page_no * ENTRIES_PER_PAGE),
+                no_of_entries);
+}
+
+uint64_t
+EmissionIndex::page_checksum(uint64_t page_no, const entry* entries,
+                             uint64_t no_of_entries)
+{
+    // 64 bit FNV-1a over the entries. Page number is mixed in,
+    // so that page written in a wrong place is detected as well.
+    uint64_t checksum = 14695981039346656037ULL ^ page_no;
+
+    const unsigned char* bytes
+            = reinterpret_cast<const unsigned char*>(entries);
+
+    for (uint64_t i = 0; i < no_of_entries * sizeof(entry); ++i)
+    {
+        checksum ^= bytes[i];
+        checksum *= 1099511628211ULL;
+    }
+
+    return checksum;
+}
+
+EmissionIndex::entry*
+EmissionIndex::get_entry(const region_ptr& mapped, uint64_t blk_height)
+{
+    char* page = static_cast<char*>(mapped->get_address())
+                 + (blk_height / ENTRIES_PER_PAGE) * PAGE_SIZE;
+
+    return reinterpret_cast<entry*>(page)
+           + (blk_height % ENTRIES_PER_PAGE);
+}
+
+EmissionIndex::page_trailer*
+EmissionIndex::get_trailer(const region_ptr& mapped, uint64_t page_no)
+{
+    char* page = static_cast<char*>(mapped->get_address())
+                 + page_no * PAGE_SIZE;
+
+    return reinterpret_cast<page_trailer*>(
+                page + ENTRIES_PER_PAGE * sizeof(entry));
+}
+
+}
@@ -0,0 +1,127 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_EMISSIONINDEX_H
+#define XMRBLOCKS_EMISSIONINDEX_H
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+namespace xmreg
+{
+
+using namespace std;
+
+namespace bf = boost::filesystem;
+
+/**
+ * Memory mapped file with cumulative emission for each block.
+ *
+ * Each block takes 16 bytes, i.e., cumulative coinbase and
+ * fee up to and including the block. Entries are grouped in
+ * pages of 4096 bytes: 255 entries followed by 16 byte trailer
+ * with number of entries in the page and their checksum.
+ * So emission at any height is just one lookup into the file,
+ * and corrupted or half written pages are detected when the
+ * file is opened.
+ *
+ * Only one thread (emission monitoring thread) can append to
+ * or truncate the index. Any number of threads can read it.
+ * The file never shrinks, so the mapping that readers use
+ * stays valid even if the index gets remapped to grow it.
+ */
+class EmissionIndex
+{
+public:
+
+    struct entry
+    {
+        uint64_t coinbase;
+        uint64_t fee;
+    };
+
+    static constexpr uint64_t PAGE_SIZE        {4096};
+    static constexpr uint64_t ENTRIES_PER_PAGE {(PAGE_SIZE - 16) / sizeof(entry)};
+
+    EmissionIndex() = default;
+
+    EmissionIndex(const EmissionIndex&) = delete;
+    EmissionIndex& operator=(const EmissionIndex&) = delete;
+
+    // opens or creates the index file. Entries after first
+    // corrupted page are dropped.
+    bool
+    open(const bf::path& _file_path);
+
+    bool
+    is_open() const;
+
+    // number of blocks in the index
+    uint64_t
+    size() const;
+
+    // cumulative emission up to and including given block
+    bool
+    get(uint64_t blk_height, entry& cumulative) const;
+
+    // add emission of next blocks, i.e., not cumulative values
+    // of blocks starting at the height of size()
+    bool
+    append(const vector<entry>& blk_emissions);
+
+    // drop all entries from new_size upwards, e.g.,
+    // after blockchain reorganization
+    bool
+    truncate(uint64_t new_size);
+
+private:
+
+    struct page_trailer
+    {
+        uint64_t no_of_entries;
+        uint64_t checksum;
+    };
+
+    static_assert(ENTRIES_PER_PAGE * sizeof(entry) + sizeof(page_trailer)
+                  == PAGE_SIZE, "Wrong size of EmissionIndex page");
+
+    using region_ptr = std::shared_ptr<boost::interprocess::mapped_region>;
+
+    // makes sure that the file and its mapping has at least
+    // given number of pages
+    bool
+    reserve(uint64_t no_of_pages);
+
+    void
+    write_trailer(uint64_t page_no, uint64_t no_of_entries);
+
+    static uint64_t
+    page_checksum(uint64_t page_no, const entry* entries,
+                  uint64_t no_of_entries);
+
+    static entry*
+    get_entry(const region_ptr& mapped, uint64_t blk_height);
+
+    static page_trailer*
+    get_trailer(const region_ptr& mapped, uint64_t page_no);
+
+    bf::path file_path;
+
+    // accessed only through std::atomic_load and std::atomic_store
+    region_ptr region;
+
+    uint64_t no_of_mapped_pages {0};
+
+    std::atomic<uint64_t> no_of_entries {0};
+};
+
+}
+
+#endif //XMRBLOCKS_EMISSIONINDEX_H
@@ -0,0 +1,252 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#include "HeaderIndex.h"
+#include "tools.h"
+#include "ReadTxnScope.h"
+
+#include <iostream>
+#include <algorithm>
+
+namespace xmreg
+{
+
+bool
+HeaderIndex::update(BlockchainDB& db, uint64_t max_no_of_blocks)
+{
+    columns new_headers;
+
+    uint64_t start_height {0};
+    uint64_t bc_height {0};
+
+    // read transaction only for reading the headers,
+    // not while the index is locked for writing
+    {
+        ReadTxnScope rtxn_scope {db};
+
+        try
+        {
+            bc_height = db.height();
+
+            // only this thread changes the index,
+            // so it can read it without the lock
+            start_height = std::min<uint64_t>(no_of_blocks, bc_height);
+
+            while (start_height > 0
+                   && db.get_block_hash_from_height(start_height - 1)
+                      != headers.hashes[start_height - 1])
+            {
+                --start_height;
+            }
+
+            uint64_t end_height = std::min<uint64_t>(
+                    bc_height, start_height + max_no_of_blocks);
+
+            if (end_height > start_height)
+            {
+                new_headers.reserve(end_height - start_height);
+
+                db.for_blocks_range(start_height, end_height - 1,
+                        [&new_headers](uint64_t, const crypto::hash& blk_hash,
+                                       const block& blk) -> bool
+                {
+                    new_headers.hashes.push_back(blk_hash);
+                    new_headers.timestamps.push_back(blk.timestamp);
+                    new_headers.no_of_txs.push_back(blk.tx_hashes.size());
+                    return true;
+                });
+
+                for (uint64_t blk_height = start_height;
+                     blk_height < end_height; ++blk_height)
+                {
+                    difficulty_type cumulative_difficulty
+                            = db.get_block_cumulative_difficulty(blk_height);
+
+                    new_headers.weights.push_back(
+                            db.get_block_weight(blk_height));
+                    new_headers.cumulative_difficulties_low.push_back(
+                            (cumulative_difficulty & 0xffffffffffffffff)
+                                    .convert_to<uint64_t>());
+                    new_headers.cumulative_difficulties_high.push_back(
+                            ((cumulative_difficulty >> 64) & 0xffffffffffffffff)
+                                    .convert_to<uint64_t>());
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            cerr << "Cant read block headers for header index: "
+                 << e.what() << endl;
+            return false;
+        }
+    }
+
+    if (new_headers.hashes.size() != new_headers.weights.size())
+    {
+        cerr << "Cant read all block headers for header index" << endl;
+        return false;
+    }
+
+    if (start_height == no_of_blocks && new_headers.hashes.empty())
+        return true;
+
+    write_lock lck (headers_mtx);
+
+    // room for the whole blockchain and some new blocks, so
+    // that the columns are not reallocated with each batch
+    // of the initial scan
+    if (bc_height > headers.hashes.capacity())
+        headers.reserve(bc_height + bc_height / 64);
+
+    truncate(start_height);
+
+    headers.append(new_headers);
+
+    no_of_blocks = headers.hashes.size();
+
+    return true;
+}
+
+uint64_t
+HeaderIndex::size() const
+{
+    return no_of_blocks;
+}
+
+bool
+HeaderIndex::get_hash(uint64_t blk_height, crypto::hash& blk_hash) const
+{
+    read_lock lck (headers_mtx);
+
+    if (blk_height >= headers.hashes.size())
+        return false;
+
+    blk_hash = headers.hashes[blk_height];
+
+    return true;
+}
+
+bool
+HeaderIndex::get_timestamp(uint64_t blk_height, uint64_t& timestamp) const
+{
+    read_lock lck (headers_mtx);
+
+    if (blk_height >= headers.timestamps.size())
+        return false;
+
+    timestamp = headers.timestamps[blk_height];
+
+    return true;
+}
+
+bool
+HeaderIndex::get_weight(uint64_t blk_height, uint64_t& weight) const
+{
+    read_lock lck (headers_mtx);
+
+    if (blk_height >= headers.weights.size())
+        return false;
+
+    weight = headers.weights[blk_height];
+
+    return true;
+}
+
+bool
+HeaderIndex::get_header(uint64_t blk_height, header& blk_header) const
+{
+    read_lock lck (headers_mtx);
+
+    if (blk_height >= headers.hashes.size())
+        return false;
+
+    blk_header.hash      = headers.hashes[blk_height];
+    blk_header.timestamp = headers.timestamps[blk_height];
+    blk_header.weight    = headers.weights[blk_height];
+    blk_header.no_of_txs = headers.no_of_txs[blk_height];
+
+    blk_header.cumulative_difficulty = make_difficulty(
+            headers.cumulative_difficulties_low[blk_height],
+            headers.cumulative_difficulties_high[blk_height]);
+
+    return true;
+}
+
+uint64_t
+HeaderIndex::memory_usage() const
+{
+    read_lock lck (headers_mtx);
+
+    return headers.memory_usage();
+}
+
+void
+HeaderIndex::truncate(uint64_t new_size)
+{
+    if (new_size < headers.hashes.size())
+        headers.resize(new_size);
+}
+
+void
+HeaderIndex::columns::reserve(size_t n)
+{
+    hashes.reserve(n);
+    timestamps.reserve(n);
+    weights.reserve(n);
+    cumulative_difficulties_low.reserve(n);
+    cumulative_difficulties_high.reserve(n);
+    no_of_txs.reserve(n);
+}
+
+void
+HeaderIndex::columns::resize(size_t n)
+{
+    hashes.resize(n);
+    timestamps.resize(n);
+    weights.resize(n);
+    cumulative_difficulties_low.resize(n);
+    cumulative_difficulties_high.resize(n);
+    no_of_txs.resize(n);
+}
+
+void
+HeaderIndex::columns::append(const columns& other)
+{
+    size_t new_size = hashes.size() + other.hashes.size();
+
+    // grow by 1/8, rather than doubling, as the columns
+    // of the whole blockchain take over 200 MB
+    if (new_size > hashes.capacity())
+        reserve(new_size + new_size / 8);
+
+    hashes.insert(hashes.end(),
+                  other.hashes.begin(), other.hashes.end());
+    timestamps.insert(timestamps.end(),
+                      other.timestamps.begin(), other.timestamps.end());
+    weights.insert(weights.end(),
+                   other.weights.begin(), other.weights.end());
+    cumulative_difficulties_low.insert(
+            cumulative_difficulties_low.end(),
+            other.cumulative_difficulties_low.begin(),
+            other.cumulative_difficulties_low.end());
+    cumulative_difficulties_high.insert(
+            cumulative_difficulties_high.end(),
+            other.cumulative_difficulties_high.begin(),
+            other.cumulative_difficulties_high.end());
+    no_of_txs.insert(no_of_txs.end(),
+                     other.no_of_txs.begin(), other.no_of_txs.end());
+}
+
+uint64_t
+HeaderIndex::columns::memory_usage() const
+{
+    return hashes.capacity() * sizeof(crypto::hash)
+           + timestamps.capacity() * sizeof(uint64_t)
+           + weights.capacity() * sizeof(uint32_t)
+           + cumulative_difficulties_low.capacity() * sizeof(uint64_t)
+           + cumulative_difficulties_high.capacity() * sizeof(uint64_t)
+           + no_of_txs.capacity() * sizeof(uint32_t);
+}
+
+}
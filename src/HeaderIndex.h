@@ -0,0 +1,124 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_HEADERINDEX_H
+#define XMRBLOCKS_HEADERINDEX_H
+
+#include "monero_headers.h"
+
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <cstdint>
+#include <vector>
+#include <atomic>
+
+namespace xmreg
+{
+
+using namespace std;
+using namespace cryptonote;
+
+/**
+ * In memory table of block headers, i.e., hash, timestamp,
+ * weight, cumulative difficulty and number of txs of each block.
+ *
+ * So that these are array lookups, rather than lmdb queries or
+ * deserializing whole block just to get its timestamp. Each field
+ * is kept in its own column, which takes 64 bytes per block.
+ *
+ * Only one thread can update the index. Any number of threads
+ * can read it.
+ */
+class HeaderIndex
+{
+public:
+
+    struct header
+    {
+        crypto::hash hash;
+        uint64_t timestamp;
+        uint64_t weight;
+        difficulty_type cumulative_difficulty;
+
+        // without coinbase tx
+        uint64_t no_of_txs;
+    };
+
+    HeaderIndex() = default;
+
+    HeaderIndex(const HeaderIndex&) = delete;
+    HeaderIndex& operator=(const HeaderIndex&) = delete;
+
+    /**
+     * Drops blocks which are not in the blockchain anymore, e.g.,
+     * after reorganization, and adds at most max_no_of_blocks
+     * new ones, all read in one lmdb read transaction.
+     *
+     * @return false if the blockchain cant be read
+     */
+    bool
+    update(BlockchainDB& db, uint64_t max_no_of_blocks);
+
+    // number of blocks in the index
+    uint64_t
+    size() const;
+
+    bool
+    get_hash(uint64_t blk_height, crypto::hash& blk_hash) const;
+
+    bool
+    get_timestamp(uint64_t blk_height, uint64_t& timestamp) const;
+
+    bool
+    get_weight(uint64_t blk_height, uint64_t& weight) const;
+
+    bool
+    get_header(uint64_t blk_height, header& blk_header) const;
+
+    // bytes taken by all the columns
+    uint64_t
+    memory_usage() const;
+
+private:
+
+    using read_lock  = boost::shared_lock<boost::shared_mutex>;
+    using write_lock = boost::unique_lock<boost::shared_mutex>;
+
+    struct columns
+    {
+        vector<crypto::hash> hashes;
+        vector<uint64_t> timestamps;
+        vector<uint32_t> weights;
+        vector<uint64_t> cumulative_difficulties_low;
+        vector<uint64_t> cumulative_difficulties_high;
+        vector<uint32_t> no_of_txs;
+
+        void
+        reserve(size_t n);
+
+        void
+        resize(size_t n);
+
+        void
+        append(const columns& other);
+
+        uint64_t
+        memory_usage() const;
+    };
+
+    void
+    truncate(uint64_t new_size);
+
+    columns headers;
+
+    mutable boost::shared_mutex headers_mtx;
+
+    // readable without the lock
+    std::atomic<uint64_t> no_of_blocks {0};
+};
+
+}
+
+#endif //XMRBLOCKS_HEADERINDEX_H
@@ -0,0 +1,316 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#include "HexCodec.h"
+
+#include <array>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define XMRBLOCKS_HEX_SIMD
+#include <immintrin.h>
+#endif
+
+namespace xmreg
+{
+
+namespace
+{
+
+const char hex_digits[] = "0123456789abcdef";
+
+// value of each hex digit, or -1 for other characters
+std::array<int8_t, 256>
+make_hex_values()
+{
+    std::array<int8_t, 256> values;
+
+    values.fill(-1);
+
+    for (int c = '0'; c <= '9'; ++c)
+        values[c] = c - '0';
+
+    for (int c = 'a'; c <= 'f'; ++c)
+        values[c] = values[c - 'a' + 'A'] = c - 'a' + 10;
+
+    return values;
+}
+
+const std::array<int8_t, 256> hex_values = make_hex_values();
+
+void
+hex_encode_scalar(const uint8_t* data, size_t size, char* out)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        *out++ = hex_digits[data[i] >> 4];
+        *out++ = hex_digits[data[i] & 0x0f];
+    }
+}
+
+bool
+hex_decode_scalar(const char* hex, size_t size, uint8_t* out)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        int8_t high = hex_values[static_cast<uint8_t>(hex[2 * i])];
+        int8_t low  = hex_values[static_cast<uint8_t>(hex[2 * i + 1])];
+
+        if (high < 0 || low < 0)
+            return false;
+
+        out[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+
+    return true;
+}
+
+#ifdef XMRBLOCKS_HEX_SIMD
+
+// nibbles 0-15 to '0'-'9' and 'a'-'f'
+inline __m128i
+nibbles_to_hex_sse2(__m128i nibbles)
+{
+    __m128i above_9 = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')),
+                        _mm_and_si128(above_9, _mm_set1_epi8('a' - '0' - 10)));
+}
+
+// values of 16 hex characters, and sets valid to 0 if any isnt one
+inline __m128i
+hex_to_nibbles_sse2(__m128i chars, __m128i& valid)
+{
+    // chars which are not digits or letters end up
+    // outside of the ranges, also after wrapping around
+    __m128i digit  = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                  _mm_set1_epi8('a'));
+
+    __m128i is_digit  = _mm_and_si128(_mm_cmpgt_epi8(digit, _mm_set1_epi8(-1)),
+                                      _mm_cmpgt_epi8(_mm_set1_epi8(10), digit));
+    __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(letter, _mm_set1_epi8(-1)),
+                                      _mm_cmpgt_epi8(_mm_set1_epi8(6), letter));
+
+    valid = _mm_and_si128(valid, _mm_or_si128(is_digit, is_letter));
+
+    return _mm_or_si128(
+            _mm_and_si128(is_digit, digit),
+            _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+// pairs of nibbles, high one first, into 16 bit lanes with their byte
+inline __m128i
+join_nibbles_sse2(__m128i nibbles)
+{
+    return _mm_or_si128(
+            _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4),
+            _mm_srli_epi16(nibbles, 8));
+}
+
+void
+hex_encode_sse2(const uint8_t* data, size_t size, char* out)
+{
+    const __m128i low_nibble = _mm_set1_epi8(0x0f);
+
+    for (; size >= 16; size -= 16, data += 16, out += 32)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+
+        __m128i high = nibbles_to_hex_sse2(
+                _mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble));
+        __m128i low  = nibbles_to_hex_sse2(_mm_and_si128(bytes, low_nibble));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16),
+                         _mm_unpackhi_epi8(high, low));
+    }
+
+    hex_encode_scalar(data, size, out);
+}
+
+bool
+hex_decode_sse2(const char* hex, size_t size, uint8_t* out)
+{
+    __m128i valid = _mm_set1_epi8(-1);
+
+    for (; size >= 16; size -= 16, hex += 32, out += 16)
+    {
+        __m128i first  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 16));
+
+        first  = join_nibbles_sse2(hex_to_nibbles_sse2(first, valid));
+        second = join_nibbles_sse2(hex_to_nibbles_sse2(second, valid));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_packus_epi16(first, second));
+    }
+
+    if (_mm_movemask_epi8(valid) != 0xffff)
+        return false;
+
+    return hex_decode_scalar(hex, size, out);
+}
+
+__attribute__((target("avx2")))
+inline __m256i
+nibbles_to_hex_avx2(__m256i nibbles)
+{
+    __m256i above_9 = _mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9));
+
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')),
+                           _mm256_and_si256(above_9, _mm256_set1_epi8('a' - '0' - 10)));
+}
+
+__attribute__((target("avx2")))
+inline __m256i
+hex_to_nibbles_avx2(__m256i chars, __m256i& valid)
+{
+    __m256i digit  = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)),
+                                     _mm256_set1_epi8('a'));
+
+    __m256i is_digit  = _mm256_and_si256(_mm256_cmpgt_epi8(digit, _mm256_set1_epi8(-1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8(10), digit));
+    __m256i is_letter = _mm256_and_si256(_mm256_cmpgt_epi8(letter, _mm256_set1_epi8(-1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8(6), letter));
+
+    valid = _mm256_and_si256(valid, _mm256_or_si256(is_digit, is_letter));
+
+    return _mm256_or_si256(
+            _mm256_and_si256(is_digit, digit),
+            _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+inline __m256i
+join_nibbles_avx2(__m256i nibbles)
+{
+    return _mm256_or_si256(
+            _mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00ff)), 4),
+            _mm256_srli_epi16(nibbles, 8));
+}
+
+__attribute__((target("avx2")))
+void
+hex_encode_avx2(const uint8_t* data, size_t size, char* out)
+{
+    const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+
+    for (; size >= 32; size -= 32, data += 32, out += 64)
+    {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+
+        __m256i high = nibbles_to_hex_avx2(
+                _mm256_and_si256(_mm256_srli_epi16(bytes, 4), low_nibble));
+        __m256i low  = nibbles_to_hex_avx2(_mm256_and_si256(bytes, low_nibble));
+
+        // unpacking is done within 128 bit lanes, so they
+        // have bytes 0-7 and 16-23, and 8-15 and 24-31
+        __m256i first  = _mm256_unpacklo_epi8(high, low);
+        __m256i second = _mm256_unpackhi_epi8(high, low);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                            _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+
+    hex_encode_sse2(data, size, out);
+}
+
+__attribute__((target("avx2")))
+bool
+hex_decode_avx2(const char* hex, size_t size, uint8_t* out)
+{
+    __m256i valid = _mm256_set1_epi8(-1);
+
+    for (; size >= 32; size -= 32, hex += 64, out += 32)
+    {
+        __m256i first  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex));
+        __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 32));
+
+        first  = join_nibbles_avx2(hex_to_nibbles_avx2(first, valid));
+        second = join_nibbles_avx2(hex_to_nibbles_avx2(second, valid));
+
+        // packing is also done within lanes
+        __m256i bytes = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(first, second), 0xd8);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), bytes);
+    }
+
+    if (_mm256_movemask_epi8(valid) != -1)
+        return false;
+
+    return hex_decode_sse2(hex, size, out);
+}
+
+#endif // XMRBLOCKS_HEX_SIMD
+
+
+hex_codec
+select_hex_codec()
+{
+#ifdef XMRBLOCKS_HEX_SIMD
+    if (__builtin_cpu_supports("avx2"))
+        return {"avx2", hex_encode_avx2, hex_decode_avx2};
+
+    // sse2 is part of x86-64
+    return {"sse2", hex_encode_sse2, hex_decode_sse2};
+#else
+    return {"scalar", hex_encode_scalar, hex_decode_scalar};
+#endif
+}
+
+const hex_codec&
+get_hex_codec()
+{
+    static const hex_codec codec = select_hex_codec();
+    return codec;
+}
+
+}
+
+void
+hex_encode(const void* data, size_t size, char* out)
+{
+    get_hex_codec().encode(static_cast<const uint8_t*>(data), size, out);
+}
+
+bool
+hex_decode(const char* hex, size_t size, void* out)
+{
+    return get_hex_codec().decode(hex, size, static_cast<uint8_t*>(out));
+}
+
+const char*
+hex_codec_name()
+{
+    return get_hex_codec().name;
+}
+
+int
+hex_digit_value(char c)
+{
+    return hex_values[static_cast<uint8_t>(c)];
+}
+
+std::vector<hex_codec>
+get_hex_codecs()
+{
+    std::vector<hex_codec> codecs {
+            {"scalar", hex_encode_scalar, hex_decode_scalar}};
+
+#ifdef XMRBLOCKS_HEX_SIMD
+    codecs.push_back({"sse2", hex_encode_sse2, hex_decode_sse2});
+
+    if (__builtin_cpu_supports("avx2"))
+        codecs.push_back({"avx2", hex_encode_avx2, hex_decode_avx2});
+#endif
+
+    return codecs;
+}
+
+}
@@ -0,0 +1,108 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_HEXCODEC_H
+#define XMRBLOCKS_HEXCODEC_H
+
+#include <boost/utility/string_ref.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace xmreg
+{
+
+/**
+ * Hex encoding and decoding of hashes, keys and blobs.
+ *
+ * On x86-64 whole blocks are done with SSE2, or with AVX2 if the
+ * cpu has it, which is checked once at runtime. Remaining bytes,
+ * and all of them on other cpus, are done with lookup tables.
+ */
+
+// writes 2 * size lower case hex characters to out
+void
+hex_encode(const void* data, size_t size, char* out);
+
+// decodes 2 * size hex characters, of any case, into out.
+// returns false if any of them is not a hex digit.
+bool
+hex_decode(const char* hex, size_t size, void* out);
+
+// name of the implementation used, e.g., for /api/stats
+const char*
+hex_codec_name();
+
+// value of hex digit c, of any case, or -1 if it is not one
+int
+hex_digit_value(char c);
+
+struct hex_codec
+{
+    const char* name;
+    void (*encode)(const uint8_t*, size_t, char*);
+    bool (*decode)(const char*, size_t, uint8_t*);
+};
+
+// all implementations which this cpu can run, scalar one
+// first, so that tests can check the others against it
+std::vector<hex_codec>
+get_hex_codecs();
+
+inline std::string
+buff_to_hex(boost::string_ref buff)
+{
+    std::string hex(2 * buff.size(), '\0');
+
+    if (!buff.empty())
+        hex_encode(buff.data(), buff.size(), &hex[0]);
+
+    return hex;
+}
+
+inline bool
+hex_to_buff(boost::string_ref hex, std::string& buff)
+{
+    if (hex.size() % 2 != 0)
+        return false;
+
+    buff.resize(hex.size() / 2);
+
+    return buff.empty() || hex_decode(hex.data(), buff.size(), &buff[0]);
+}
+
+template <typename T>
+inline std::string
+pod_to_hex(const T& pod)
+{
+    std::string hex(2 * sizeof(T), '\0');
+
+    hex_encode(&pod, sizeof(T), &hex[0]);
+
+    return hex;
+}
+
+// no allocation, e.g., crypto::hash into char[64]
+template <typename T>
+inline void
+pod_to_hex(const T& pod, char (&hex)[2 * sizeof(T)])
+{
+    hex_encode(&pod, sizeof(T), hex);
+}
+
+template <typename T>
+inline bool
+hex_to_pod(boost::string_ref hex, T& pod)
+{
+    if (hex.size() != 2 * sizeof(T))
+        return false;
+
+    return hex_decode(hex.data(), sizeof(T), &pod);
+}
+
+}
+
+#endif //XMRBLOCKS_HEXCODEC_H
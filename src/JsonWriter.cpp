@@ -0,0 +1,477 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#include "JsonWriter.h"
+
+namespace xmreg
+{
+
+JsonWriter::JsonWriter(string& _out, bool _pretty)
+    : out {_out}, pretty {_pretty}
+{}
+
+JsonWriter&
+JsonWriter::begin_object()
+{
+    before_value();
+    out += '{';
+    empty_scope.push_back(true);
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::end_object()
+{
+    bool was_empty = empty_scope.back();
+
+    empty_scope.pop_back();
+
+    if (!was_empty)
+        new_line();
+
+    out += '}';
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::begin_array()
+{
+    before_value();
+    out += '[';
+    empty_scope.push_back(true);
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::end_array()
+{
+    bool was_empty = empty_scope.back();
+
+    empty_scope.pop_back();
+
+    if (!was_empty)
+        new_line();
+
+    out += ']';
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::key(const char* name)
+{
+    before_value();
+
+    out += '"';
+    out += name;
+    out += pretty ? "\": " : "\":";
+
+    after_key = true;
+
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::value(uint64_t number)
+{
+    before_value();
+
+    // to_string would allocate new string for each number
+    char buf[20];
+    char* end = buf + sizeof(buf);
+    char* p   = end;
+
+    do
+    {
+        *--p = static_cast<char>('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+
+    out.append(p, end);
+
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::value_hex(const void* data, size_t size)
+{
+    before_value();
+
+    size_t start = out.size();
+
+    out.resize(start + 2 * size + 2);
+
+    char* p = &out[start];
+
+    *p++ = '"';
+
+    hex_encode(data, size, p);
+
+    p[2 * size] = '"';
+
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::value_raw(const string& json_str)
+{
+    before_value();
+    out += json_str;
+    return *this;
+}
+
+void
+JsonWriter::before_value()
+{
+    if (after_key)
+    {
+        // value of a key goes right after it
+        after_key = false;
+        return;
+    }
+
+    if (empty_scope.empty())
+        return;
+
+    if (!empty_scope.back())
+        out += ',';
+
+    empty_scope.back() = false;
+
+    new_line();
+}
+
+void
+JsonWriter::new_line()
+{
+    if (!pretty)
+        return;
+
+    out += '\n';
+    out.append(2 * empty_scope.size(), ' ');
+}
+
+
+namespace
+{
+
+template <typename T>
+void
+write_pod_array(JsonWriter& w, const vector<T>& pods)
+{
+    w.begin_array();
+
+    for (const T& pod: pods)
+        w.value_pod(pod);
+
+    w.end_array();
+}
+
+void
+write_tx_prefix(JsonWriter& w, const transaction& tx)
+{
+    w.key("version").value(tx.version);
+    w.key("unlock_time").value(tx.unlock_time);
+
+    w.key("vin").begin_array();
+
+    for (const txin_v& in: tx.vin)
+    {
+        w.begin_object();
+
+        if (const txin_gen* in_gen = boost::get<txin_gen>(&in))
+        {
+            w.key("gen").begin_object();
+            w.key("height").value(in_gen->height);
+            w.end_object();
+        }
+        else
+        {
+            const txin_to_key& in_key = boost::get<txin_to_key>(in);
+
+            w.key("key").begin_object();
+            w.key("amount").value(in_key.amount);
+
+            w.key("key_offsets").begin_array();
+
+            for (uint64_t offset: in_key.key_offsets)
+                w.value(offset);
+
+            w.end_array();
+
+            w.key("k_image").value_pod(in_key.k_image);
+            w.end_object();
+        }
+
+        w.end_object();
+    }
+
+    w.end_array();
+
+    w.key("vout").begin_array();
+
+    for (const tx_out& out: tx.vout)
+    {
+        const txout_to_key& out_key = boost::get<txout_to_key>(out.target);
+
+        w.begin_object();
+        w.key("amount").value(out.amount);
+        w.key("target").begin_object();
+        w.key("key").begin_object();
+        w.key("key").value_pod(out_key.key);
+        w.end_object();
+        w.end_object();
+        w.end_object();
+    }
+
+    w.end_array();
+
+    w.key("extra").begin_array();
+
+    for (uint8_t byte: tx.extra)
+        w.value(byte);
+
+    w.end_array();
+}
+
+void
+write_rctsig_base(JsonWriter& w, const rct::rctSig& rct)
+{
+    w.begin_object();
+
+    w.key("type").value(rct.type);
+
+    if (rct.type == rct::RCTTypeNull)
+    {
+        w.end_object();
+        return;
+    }
+
+    w.key("txnFee").value(rct.txnFee);
+
+    // bulletproof2 and clsag keep only 8 bytes of encrypted amounts
+    bool compact_ecdh = rct.type == rct::RCTTypeBulletproof2
+                        || rct.type == rct::RCTTypeCLSAG;
+
+    w.key("ecdhInfo").begin_array();
+
+    for (const rct::ecdhTuple& ecdh: rct.ecdhInfo)
+    {
+        w.begin_object();
+
+        if (!compact_ecdh)
+            w.key("mask").value_pod(ecdh.mask);
+
+        w.key("amount").value_hex(&ecdh.amount,
+                                  compact_ecdh ? 8 : sizeof(ecdh.amount));
+        w.end_object();
+    }
+
+    w.end_array();
+
+    w.key("outPk").begin_array();
+
+    for (const rct::ctkey& out_pk: rct.outPk)
+        w.value_pod(out_pk.mask);
+
+    w.end_array();
+
+    w.end_object();
+}
+
+void
+write_rctsig_prunable(JsonWriter& w, const rct::rctSig& rct)
+{
+    const rct::rctSigPrunable& p = rct.p;
+
+    w.begin_object();
+
+    w.key("nbp").value(p.bulletproofs.size());
+
+    w.key("bp").begin_array();
+
+    for (const rct::Bulletproof& bp: p.bulletproofs)
+    {
+        // V is not serialized, its restored from outPk
+        w.begin_object();
+        w.key("A").value_pod(bp.A);
+        w.key("S").value_pod(bp.S);
+        w.key("T1").value_pod(bp.T1);
+        w.key("T2").value_pod(bp.T2);
+        w.key("taux").value_pod(bp.taux);
+        w.key("mu").value_pod(bp.mu);
+        w.key("L"); write_pod_array(w, bp.L);
+        w.key("R"); write_pod_array(w, bp.R);
+        w.key("a").value_pod(bp.a);
+        w.key("b").value_pod(bp.b);
+        w.key("t").value_pod(bp.t);
+        w.end_object();
+    }
+
+    w.end_array();
+
+    if (rct.type == rct::RCTTypeCLSAG)
+    {
+        w.key("CLSAGs").begin_array();
+
+        for (const rct::clsag& sig: p.CLSAGs)
+        {
+            // key image I is not serialized
+            w.begin_object();
+            w.key("s"); write_pod_array(w, sig.s);
+            w.key("c1").value_pod(sig.c1);
+            w.key("D").value_pod(sig.D);
+            w.end_object();
+        }
+
+        w.end_array();
+    }
+    else
+    {
+        w.key("MGs").begin_array();
+
+        for (const rct::mgSig& sig: p.MGs)
+        {
+            // key images II are not serialized
+            w.begin_object();
+            w.key("ss").begin_array();
+
+            for (const rct::keyV& ss: sig.ss)
+                write_pod_array(w, ss);
+
+            w.end_array();
+            w.key("cc").value_pod(sig.cc);
+            w.end_object();
+        }
+
+        w.end_array();
+    }
+
+    w.key("pseudoOuts"); write_pod_array(w, p.pseudoOuts);
+
+    w.end_object();
+}
+
+// true if write_tx can produce the same json as obj_to_json_str
+bool
+is_supported_tx(const transaction& tx)
+{
+    if (tx.version != 2 || tx.vin.empty())
+        return false;
+
+    for (const tx_out& out: tx.vout)
+        if (out.target.type() != typeid(txout_to_key))
+            return false;
+
+    for (const txin_v& in: tx.vin)
+        if (in.type() != typeid(txin_gen) && in.type() != typeid(txin_to_key))
+            return false;
+
+    const rct::rctSig& rct = tx.rct_signatures;
+
+    switch (rct.type)
+    {
+        case rct::RCTTypeNull:
+            return true;
+        case rct::RCTTypeBulletproof:
+        case rct::RCTTypeBulletproof2:
+        case rct::RCTTypeCLSAG:
+            break;
+        default:
+            return false;
+    }
+
+    if (rct.ecdhInfo.size() != tx.vout.size()
+            || rct.outPk.size() != tx.vout.size())
+        return false;
+
+    // pruned txs have only rct base
+    if (tx.pruned)
+        return true;
+
+    size_t no_of_sigs = rct.type == rct::RCTTypeCLSAG
+                        ? rct.p.CLSAGs.size() : rct.p.MGs.size();
+
+    return no_of_sigs == tx.vin.size()
+            && rct.p.pseudoOuts.size() == tx.vin.size();
+}
+
+void
+write_tx(JsonWriter& w, const transaction& tx)
+{
+    w.begin_object();
+
+    write_tx_prefix(w, tx);
+
+    w.key("rct_signatures");
+    write_rctsig_base(w, tx.rct_signatures);
+
+    if (tx.rct_signatures.type != rct::RCTTypeNull && !tx.pruned)
+    {
+        w.key("rctsig_prunable");
+        write_rctsig_prunable(w, tx.rct_signatures);
+    }
+
+    w.end_object();
+}
+
+}
+
+
+bool
+write_tx_json(const transaction& tx, string& json_str, bool pretty)
+{
+    if (!is_supported_tx(tx))
+    {
+        // obj_to_json_str takes non-const reference
+        transaction tx_copy = tx;
+
+        string tx_json = obj_to_json_str(tx_copy);
+
+        json_str += tx_json;
+
+        return !tx_json.empty();
+    }
+
+    JsonWriter w {json_str, pretty};
+
+    write_tx(w, tx);
+
+    return true;
+}
+
+bool
+write_block_json(const block& blk, string& json_str, bool pretty)
+{
+    if (!is_supported_tx(blk.miner_tx))
+    {
+        block blk_copy = blk;
+
+        string blk_json = obj_to_json_str(blk_copy);
+
+        json_str += blk_json;
+
+        return !blk_json.empty();
+    }
+
+    JsonWriter w {json_str, pretty};
+
+    w.begin_object();
+
+    w.key("major_version").value(blk.major_version);
+    w.key("minor_version").value(blk.minor_version);
+    w.key("timestamp").value(blk.timestamp);
+    w.key("prev_id").value_pod(blk.prev_id);
+    w.key("nonce").value(blk.nonce);
+
+    w.key("miner_tx");
+    write_tx(w, blk.miner_tx);
+
+    w.key("tx_hashes"); write_pod_array(w, blk.tx_hashes);
+
+    w.end_object();
+
+    return true;
+}
+
+}
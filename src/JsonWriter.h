@@ -0,0 +1,105 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_JSONWRITER_H
+#define XMRBLOCKS_JSONWRITER_H
+
+#include "monero_headers.h"
+#include "HexCodec.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace xmreg
+{
+
+using namespace std;
+using namespace cryptonote;
+
+/**
+ * Minimal streaming json writer which appends
+ * straight into given string.
+ *
+ * Used to serialize blocks and txs without first producing
+ * json string with obj_to_json_str, parsing it into nlohmann
+ * json and dumping it again. Only writes what the explorer
+ * needs, i.e., objects, arrays, integers and hex blobs.
+ */
+class JsonWriter
+{
+public:
+
+    explicit JsonWriter(string& _out, bool _pretty = false);
+
+    JsonWriter&
+    begin_object();
+
+    JsonWriter&
+    end_object();
+
+    JsonWriter&
+    begin_array();
+
+    JsonWriter&
+    end_array();
+
+    JsonWriter&
+    key(const char* name);
+
+    JsonWriter&
+    value(uint64_t number);
+
+    // data as lower case hex string
+    JsonWriter&
+    value_hex(const void* data, size_t size);
+
+    template <typename T>
+    JsonWriter&
+    value_pod(const T& pod)
+    {
+        return value_hex(&pod, sizeof(T));
+    }
+
+    // already serialized json value
+    JsonWriter&
+    value_raw(const string& json_str);
+
+private:
+
+    void
+    before_value();
+
+    void
+    new_line();
+
+    string& out;
+
+    bool pretty;
+
+    // true if nothing was written yet in the
+    // object or array at given depth
+    vector<bool> empty_scope;
+
+    bool after_key {false};
+};
+
+
+/**
+ * Appends json of the tx or block to the json_str, using the
+ * same field names and order as monero's obj_to_json_str.
+ *
+ * Txs which this writer does not know how to serialize,
+ * e.g., pre-ringct or with old ringct types, are serialized
+ * with obj_to_json_str. Returns false if that fails.
+ */
+bool
+write_tx_json(const transaction& tx, string& json_str, bool pretty = false);
+
+bool
+write_block_json(const block& blk, string& json_str, bool pretty = false);
+
+}
+
+#endif //XMRBLOCKS_JSONWRITER_H
@@ -23,7 +23,7 @@ void
 MempoolStatus::start_mempool_status_thread()
 {
 
-    // to protect from deviation by zero below.
+    // so that the loop below does not spin
     mempool_refresh_time = std::max<uint64_t>(1, mempool_refresh_time);
 
     if (!is_running)
@@ -32,18 +32,24 @@ MempoolStatus::start_mempool_status_thread()
         {
          try
          {
-             uint64_t loop_index {0};
+             using network_info_clock = boost::chrono::steady_clock;
 
-            // so that network status is checked every minute
-            uint64_t loop_index_divider = std::max<uint64_t>(1, 60 / mempool_refresh_time);
+             // network status is checked by elapsed time, as the
+             // loop also wakes up on each new block
+             network_info_clock::time_point next_network_info_time
+                     = network_info_clock::now();
 
             while (true)
             {
+             uint64_t tip_generation = ChainTipWatcher::generation;
 
              // we just query network status every minute. No sense
              // to do it as frequently as getting mempool data.
-             if (loop_index % loop_index_divider == 0)
+             if (network_info_clock::now() >= next_network_info_time)
              {
+                 next_network_info_time = network_info_clock::now()
+                                          + boost::chrono::seconds(60);
+
                  if (!MempoolStatus::read_network_info())
                  {
                      network_info local_copy = current_network_info;
@@ -57,26 +63,22 @@ MempoolStatus::start_mempool_status_thread()
                  else
                  {
                      cout << "Current network info read, ";
-                     loop_index = 0;
                  }
              }
 
              if (MempoolStatus::read_mempool())
              {
-                 vector<mempool_tx> current_mempool_txs = get_mempool_txs();
-
                  cout << "mempool status txs: "
-                      << current_mempool_txs.size()
+                      << get_mempool_snapshot()->txs.size()
                       << endl;
              }
 
-             // when we reach top of the blockchain, update
-             // the emission amount every minute.
-             boost::this_thread::sleep_for(
+             // new block removes its txs from the mempool, so
+             // dont wait the whole refresh time if it arrives
+             ChainTipWatcher::wait_for_new_tip(
+                     tip_generation,
                      boost::chrono::seconds(mempool_refresh_time));
 
-             ++loop_index;
-
              } // while (true)
          }
          catch (boost::thread_interrupted&)
@@ -96,15 +98,24 @@ MempoolStatus::start_mempool_status_thread()
 bool
 MempoolStatus::read_mempool()
 {
-    rpccalls rpc {deamon_url, login};
+    // previous snapshot. txs which are still in the mempool
+    // are taken from it, so that we dont parse them again.
+    std::shared_ptr<const mempool_snapshot> previous_mempool
+            = get_mempool_snapshot();
 
-    string error_msg;
+    std::unordered_map<crypto::hash, mempool_tx_ptr> previous_txs;
+
+    previous_txs.reserve(previous_mempool->txs.size());
 
-    // we populate this variable instead of global mempool_txs
-    // mempool_txs will be changed only when this function completes.
-    // this ensures that we don't sent out partial mempool txs to
-    // other places.
-    vector<mempool_tx> local_copy_of_mempool_txs;
+    for (const mempool_tx_ptr& mtx: previous_mempool->txs)
+        previous_txs.emplace(mtx->tx_hash, mtx);
+
+    // we populate this variable instead of current_mempool.
+    // current_mempool will be changed only when this function
+    // completes. this ensures that we don't sent out partial
+    // mempool txs to other places.
+    std::shared_ptr<mempool_snapshot> new_mempool
+            = std::make_shared<mempool_snapshot>();
 
     // get txs in the mempool
     std::vector<tx_info> mempool_tx_info;
@@ -136,84 +147,112 @@ MempoolStatus::read_mempool()
     });
 
 
-    // if dont have tx_blob member, construct tx
-    // from json obtained from the rpc call
-
     uint64_t mempool_size_kB {0};
 
+    uint64_t no_of_new_txs {0};
+
+    new_mempool->txs.reserve(mempool_tx_info.size());
+
     for (size_t i = 0; i < mempool_tx_info.size(); ++i)
     {
         // get transaction info of the tx in the mempool
         const tx_info& _tx_info = mempool_tx_info.at(i);
 
-        transaction tx;
+        mempool_size_kB += _tx_info.blob_size;
+
         crypto::hash tx_hash;
-        crypto::hash tx_prefix_hash;
 
-        if (!parse_and_validate_tx_from_blob(
-                _tx_info.tx_blob, tx, tx_hash, tx_prefix_hash))
+        if (hex_to_pod(_tx_info.id_hash, tx_hash))
         {
-            cerr << "Cant make tx from _tx_info.tx_blob" << endl;
-            return false;
+            auto it = previous_txs.find(tx_hash);
+
+            if (it != previous_txs.end())
+            {
+                // we already have this tx, nothing to do
+                new_mempool->txs.push_back(it->second);
+                continue;
+            }
         }
 
-        mempool_size_kB += _tx_info.blob_size;
+        std::shared_ptr<mempool_tx> new_tx = std::make_shared<mempool_tx>();
 
-        local_copy_of_mempool_txs.push_back(mempool_tx{});
+        if (!make_mempool_tx(_tx_info, *new_tx))
+            return false;
 
-        mempool_tx& last_tx = local_copy_of_mempool_txs.back();
+        new_mempool->txs.push_back(new_tx);
 
-        last_tx.tx_hash = tx_hash;
-        last_tx.tx = tx;
+        ++no_of_new_txs;
 
-        // key images of inputs
-        vector<txin_to_key> input_key_imgs;
+    } // for (size_t i = 0; i < mempool_tx_info.size(); ++i)
 
-        // public keys and xmr amount of outputs
-        vector<pair<txout_to_key, uint64_t>> output_pub_keys;
 
-        // sum xmr in inputs and ouputs in the given tx
-        const array<uint64_t, 4>& sum_data = summary_of_in_out_rct(
-               tx, output_pub_keys, input_key_imgs);
+    // no new txs and none removed, so there is nothing to publish.
+    if (no_of_new_txs == 0
+            && new_mempool->txs.size() == previous_mempool->txs.size())
+    {
+        return true;
+    }
 
+    new_mempool->generation = previous_mempool->generation + 1;
 
-        double tx_size =  static_cast<double>(_tx_info.blob_size)/1024.0;
+    mempool_no   = new_mempool->txs.size();
+    mempool_size = mempool_size_kB;
 
-        double payed_for_kB = XMR_AMOUNT(_tx_info.fee) / tx_size;
+    std::atomic_store(&current_mempool,
+                      std::shared_ptr<const mempool_snapshot> {new_mempool});
 
-        last_tx.receive_time = _tx_info.receive_time;
+    mempool_generation = new_mempool->generation;
 
-        last_tx.sum_outputs       = sum_data[0];
-        last_tx.sum_inputs        = sum_data[1];
-        last_tx.no_outputs        = output_pub_keys.size();
-        last_tx.no_inputs         = input_key_imgs.size();
-        last_tx.mixin_no          = sum_data[2];
-        last_tx.num_nonrct_inputs = sum_data[3];
+    return true;
+}
+
+bool
+MempoolStatus::make_mempool_tx(const tx_info& _tx_info, mempool_tx& mtx)
+{
+    crypto::hash tx_prefix_hash;
 
-        last_tx.fee_str          = xmreg::xmr_amount_to_str(_tx_info.fee, "{:0.4f}", false);
-        last_tx.fee_micro_str    = xmreg::xmr_amount_to_str(_tx_info.fee*1.0e6, "{:04.0f}", false);
-        last_tx.payed_for_kB_str = fmt::format("{:0.4f}", payed_for_kB);
-        last_tx.payed_for_kB_micro_str = fmt::format("{:04.0f}", payed_for_kB*1e6);
-        last_tx.xmr_inputs_str   = xmreg::xmr_amount_to_str(last_tx.sum_inputs , "{:0.3f}");
-        last_tx.xmr_outputs_str  = xmreg::xmr_amount_to_str(last_tx.sum_outputs, "{:0.3f}");
-        last_tx.timestamp_str    = xmreg::timestamp_to_str_gm(_tx_info.receive_time);
+    if (!parse_and_validate_tx_from_blob(
+            _tx_info.tx_blob, mtx.tx, mtx.tx_hash, tx_prefix_hash))
+    {
+        cerr << "Cant make tx from _tx_info.tx_blob" << endl;
+        return false;
+    }
 
-        last_tx.txsize           = fmt::format("{:0.2f}", tx_size);
+    const transaction& tx = mtx.tx;
 
-    } // for (size_t i = 0; i < mempool_tx_info.size(); ++i)
+    // key images of inputs
+    vector<txin_to_key> input_key_imgs;
 
+    // public keys and xmr amount of outputs
+    vector<pair<txout_to_key, uint64_t>> output_pub_keys;
 
+    // sum xmr in inputs and ouputs in the given tx
+    const array<uint64_t, 4>& sum_data = summary_of_in_out_rct(
+           tx, output_pub_keys, input_key_imgs);
 
-    Guard lck (mempool_mutx);
 
-    // clear current mempool txs vector
-    // repopulate it with each execution of read_mempool()
-    // not very efficient but good enough for now.
+    double tx_size =  static_cast<double>(_tx_info.blob_size)/1024.0;
 
-    mempool_no   = local_copy_of_mempool_txs.size();
-    mempool_size = mempool_size_kB;
+    double payed_for_kB = XMR_AMOUNT(_tx_info.fee) / tx_size;
 
-    mempool_txs = std::move(local_copy_of_mempool_txs);
+    mtx.receive_time = _tx_info.receive_time;
+
+    mtx.sum_outputs       = sum_data[0];
+    mtx.sum_inputs        = sum_data[1];
+    mtx.no_outputs        = output_pub_keys.size();
+    mtx.no_inputs         = input_key_imgs.size();
+    mtx.mixin_no          = sum_data[2];
+    mtx.num_nonrct_inputs = sum_data[3];
+
+    mtx.fee_str          = xmreg::xmr_amount_to_str(_tx_info.fee, "{:0.4f}", false);
+    mtx.fee_micro_str    = xmreg::xmr_amount_to_str(_tx_info.fee*1.0e6, "{:04.0f}", false);
+    mtx.payed_for_kB_str = fmt::format("{:0.4f}", payed_for_kB);
+    mtx.payed_for_kB_micro_str = fmt::format("{:04.0f}", payed_for_kB*1e6);
+    mtx.xmr_inputs_str   = xmreg::xmr_amount_to_str(mtx.sum_inputs , "{:0.3f}");
+    mtx.xmr_outputs_str  = xmreg::xmr_amount_to_str(mtx.sum_outputs, "{:0.3f}");
+    mtx.timestamp_str    = xmreg::timestamp_to_str_gm(_tx_info.receive_time);
+
+    mtx.txsize           = fmt::format("{:0.2f}", tx_size);
 
     return true;
 }
@@ -222,18 +261,16 @@ MempoolStatus::read_mempool()
 bool
 MempoolStatus::read_network_info()
 {
-    rpccalls rpc {deamon_url, login};
-
     COMMAND_RPC_GET_INFO::response rpc_network_info;
 
-    if (!rpc.get_network_info(rpc_network_info))
+    if (!rpc->get_network_info(rpc_network_info))
         return false;
 
     uint64_t fee_estimated;
 
     string error_msg;
 
-    if (!rpc.get_dynamic_per_kb_fee_estimate(
+    if (!rpc->get_dynamic_per_kb_fee_estimate(
             FEE_ESTIMATE_GRACE_BLOCKS,
             fee_estimated, error_msg))
     {
@@ -245,7 +282,7 @@ MempoolStatus::read_network_info()
 
     COMMAND_RPC_HARD_FORK_INFO::response rpc_hardfork_info;
 
-    if (!rpc.get_hardfork_info(rpc_hardfork_info))
+    if (!rpc->get_hardfork_info(rpc_hardfork_info))
         return false;
 
 
@@ -302,21 +339,10 @@ MempoolStatus::read_network_info()
     return true;
 }
 
-vector<MempoolStatus::mempool_tx>
-MempoolStatus::get_mempool_txs()
+std::shared_ptr<const MempoolStatus::mempool_snapshot>
+MempoolStatus::get_mempool_snapshot()
 {
-    Guard lck (mempool_mutx);
-    return mempool_txs;
-}
-
-vector<MempoolStatus::mempool_tx>
-MempoolStatus::get_mempool_txs(uint64_t no_of_tx)
-{
-    Guard lck (mempool_mutx);
-
-    no_of_tx = std::min<uint64_t>(no_of_tx, mempool_txs.size());
-
-    return vector<mempool_tx>(mempool_txs.begin(), mempool_txs.begin() + no_of_tx);
+    return std::atomic_load(&current_mempool);
 }
 
 bool
@@ -332,11 +358,12 @@ atomic<bool>       MempoolStatus::is_running {false};
 boost::thread      MempoolStatus::m_thread;
 Blockchain*        MempoolStatus::core_storage {nullptr};
 xmreg::MicroCore*  MempoolStatus::mcore {nullptr};
-rpccalls::login_opt MempoolStatus::login {};
-vector<MempoolStatus::mempool_tx> MempoolStatus::mempool_txs;
+rpccalls*          MempoolStatus::rpc {nullptr};
+std::shared_ptr<const MempoolStatus::mempool_snapshot> MempoolStatus::current_mempool
+        = std::make_shared<const MempoolStatus::mempool_snapshot>();
 atomic<MempoolStatus::network_info> MempoolStatus::current_network_info;
 atomic<uint64_t> MempoolStatus::mempool_no {0};   // no of txs
 atomic<uint64_t> MempoolStatus::mempool_size {0}; // size in bytes.
+atomic<uint64_t> MempoolStatus::mempool_generation {0};
 uint64_t MempoolStatus::mempool_refresh_time {10};
-mutex MempoolStatus::mempool_mutx;
 }
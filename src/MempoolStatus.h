@@ -8,6 +8,7 @@
 
 #include "MicroCore.h"
 #include "rpccalls.h"
+#include "ChainTipWatcher.h"
 
 #include <boost/algorithm/string.hpp>
 
@@ -16,6 +17,7 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <unordered_map>
 
 namespace xmreg
 {
@@ -48,6 +50,22 @@ struct MempoolStatus
         string txsize;
     };
 
+    // mempool txs do not change once parsed, so they are
+    // shared between consecutive snapshots of the mempool
+    using mempool_tx_ptr = std::shared_ptr<const mempool_tx>;
+
+    // immutable state of the mempool published by
+    // read_mempool(). Readers get it without any locking
+    // or copying of txs, and can keep it as long as they
+    // need, even if newer snapshot gets published meanwhile.
+    struct mempool_snapshot
+    {
+        uint64_t generation {0};
+
+        // sorted by receive_time, newest first
+        vector<mempool_tx_ptr> txs;
+    };
+
 
     // to keep network_info in cache
     // and to show previous info in case current querry for
@@ -115,8 +133,6 @@ struct MempoolStatus
 
     static boost::thread m_thread;
 
-    static mutex mempool_mutx;
-
     static atomic<bool> is_running;
 
     static uint64_t mempool_refresh_time;
@@ -124,20 +140,25 @@ struct MempoolStatus
     static atomic<uint64_t> mempool_no;   // no of txs
     static atomic<uint64_t> mempool_size; // size in bytes.
 
+    // increased each time new mempool snapshot is published, so
+    // that others can check if mempool changed since they last looked
+    static atomic<uint64_t> mempool_generation;
+
     static bf::path blockchain_path;
     static string deamon_url;
     static cryptonote::network_type nettype;
 
-    static rpccalls::login_opt login;
+    // connections to the deamon, shared with page
+    static rpccalls* rpc;
 
     // make object for accessing the blockchain here
     static MicroCore* mcore;
     static Blockchain* core_storage;
 
-    // vector of mempool transactions that all threads
-    // can refer to
-    //           <recieved_time, transaction>
-    static vector<mempool_tx> mempool_txs;
+    // current snapshot of mempool transactions that all
+    // threads can refer to. Accessed only through
+    // std::atomic_load and std::atomic_store.
+    static std::shared_ptr<const mempool_snapshot> current_mempool;
 
     static atomic<network_info> current_network_info;
 
@@ -154,12 +175,12 @@ struct MempoolStatus
     static bool
     read_network_info();
 
-    static vector<mempool_tx>
-    get_mempool_txs();
+    // parse tx from its blob and prepare its summary
+    static bool
+    make_mempool_tx(const tx_info& _tx_info, mempool_tx& mtx);
 
-    // get first no_of_tx from the vector
-    static vector<mempool_tx>
-    get_mempool_txs(uint64_t no_of_tx);
+    static std::shared_ptr<const mempool_snapshot>
+    get_mempool_snapshot();
 
     static bool
     is_thread_running();
@@ -190,6 +190,59 @@ MicroCore::get_tx(const string& tx_hash_str, transaction& tx)
     return true;
 }
 
+/**
+ * Get tx blob as it is stored in the blockchain, without
+ * parsing it into transaction. Txs which are pruned, e.g., in
+ * pruned blockchain, have only their pruned part, the same as
+ * tx_to_blob of get_tx would give.
+ */
+bool
+MicroCore::get_tx_blob(const crypto::hash& tx_hash, blobdata& tx_blob)
+{
+    try
+    {
+        BlockchainDB& db = m_blockchain_storage.get_db();
+
+        if (db.get_tx_blob(tx_hash, tx_blob))
+            return true;
+
+        if (db.get_pruned_tx_blob(tx_hash, tx_blob))
+            return true;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "MicroCore::get_tx_blob: " << e.what() << endl;
+        return false;
+    }
+
+    cerr << "MicroCore::get_tx_blob tx does not exist in blockchain: "
+         << tx_hash << endl;
+
+    return false;
+}
+
+/**
+ * Get block blob as it is stored in the blockchain,
+ * i.e., block_to_blob of get_block_by_height
+ */
+bool
+MicroCore::get_block_blob(uint64_t height, blobdata& blk_blob)
+{
+    try
+    {
+        blk_blob = m_blockchain_storage.get_db()
+                .get_block_blob_from_height(height);
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "Cant get blob of block " << height << ": "
+             << e.what() << endl;
+        return false;
+    }
+
+    return true;
+}
+
 
 
 
@@ -234,21 +287,107 @@ MicroCore::find_output_in_tx(const transaction& tx,
 }
 
 
+/**
+ * Get timestamp of a block, without reading
+ * and parsing the whole block.
+ */
 uint64_t
 MicroCore::get_blk_timestamp(uint64_t blk_height)
 {
-    cryptonote::block blk;
+    try
+    {
+        return m_blockchain_storage.get_db().get_block_timestamp(blk_height);
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "Cant get timestamp of block of height: " << blk_height
+             << ", " << e.what() << endl;
+    }
+
+    return 0;
+}
+
+
+/**
+ * Check spent status of many key images at once.
+ *
+ * Key images are looked up in sorted order, all in one
+ * read transaction, rather than opening new transaction
+ * and jumping randomly around the lmdb for each of them.
+ * spent[i] is the status of key_images[i].
+ */
+bool
+MicroCore::are_key_images_spent(const vector<key_image>& key_images,
+                                vector<bool>& spent)
+{
+    spent.assign(key_images.size(), false);
+
+    vector<size_t> order(key_images.size());
+
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
 
-    if (!get_block_by_height(blk_height, blk))
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
     {
-        cerr << "Cant get block by height: " << blk_height << endl;
-        return 0;
+        return memcmp(&key_images[a], &key_images[b], sizeof(key_image)) < 0;
+    });
+
+    BlockchainDB& db = m_blockchain_storage.get_db();
+
+    ReadTxnScope rtxn_scope {db};
+
+    try
+    {
+        for (size_t i: order)
+            spent[i] = db.has_key_image(key_images[i]);
+    }
+    catch (const DB_ERROR& e)
+    {
+        cerr << "Blockchain access error when checking key images: "
+             << e.what() << endl;
+        return false;
     }
 
-    return blk.timestamp;
+    return true;
 }
 
 
+/**
+ * Check if given hash is a tx hash or a block hash.
+ *
+ * Both are just existence probes of lmdb indices done
+ * in one read transaction, so that e.g., search does not
+ * need to fetch and parse a tx or a block only to find
+ * out that it does not exist.
+ */
+bool
+MicroCore::find_hash(const crypto::hash& hash,
+                     bool& is_tx, bool& is_block)
+{
+    is_tx    = false;
+    is_block = false;
+
+    BlockchainDB& db = m_blockchain_storage.get_db();
+
+    ReadTxnScope rtxn_scope {db};
+
+    try
+    {
+        is_tx = db.tx_exists(hash);
+
+        if (!is_tx)
+            is_block = db.block_exists(hash);
+    }
+    catch (const DB_ERROR& e)
+    {
+        cerr << "Blockchain access error when looking for hash: "
+             << e.what() << endl;
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * De-initialized Blockchain.
  *
@@ -292,14 +431,46 @@ MicroCore::get_block_complete_entry(block const& b, block_complete_entry& bce)
 
     for (const auto &tx_hash: b.tx_hashes)
     {
-      transaction tx;
+      cryptonote::blobdata txblob;
 
-      if (!get_tx(tx_hash, tx))
+      if (!get_tx_blob(tx_hash, txblob))
         return false;
 
-      cryptonote::blobdata txblob =  tx_to_blob(tx);
+      bce.txs.push_back(std::move(txblob));
+    }
+
+    return true;
+}
+
+/**
+ * Same as above, but block is read as a blob and
+ * parsed only for hashes of its txs
+ */
+bool
+MicroCore::get_block_complete_entry(uint64_t height, block_complete_entry& bce)
+{
+    // block and its txs from the same snapshot
+    ReadTxnScope rtxn_scope {m_blockchain_storage.get_db()};
+
+    if (!get_block_blob(height, bce.block))
+        return false;
+
+    block b;
+
+    if (!parse_and_validate_block_from_blob(bce.block, b))
+    {
+        cerr << "Cant parse blob of block " << height << endl;
+        return false;
+    }
+
+    for (const auto &tx_hash: b.tx_hashes)
+    {
+      cryptonote::blobdata txblob;
+
+      if (!get_tx_blob(tx_hash, txblob))
+        return false;
 
-      bce.txs.push_back(txblob);
+      bce.txs.push_back(std::move(txblob));
     }
 
     return true;
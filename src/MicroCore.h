@@ -9,6 +9,7 @@
 
 #include "monero_headers.h"
 #include "tools.h"
+#include "ReadTxnScope.h"
 
 namespace xmreg
 {
@@ -56,6 +57,12 @@ namespace xmreg
         bool
         get_tx(const string& tx_hash, transaction& tx);
 
+        bool
+        get_tx_blob(const crypto::hash& tx_hash, blobdata& tx_blob);
+
+        bool
+        get_block_blob(uint64_t height, blobdata& blk_blob);
+
         bool
         find_output_in_tx(const transaction& tx,
                           const public_key& output_pubkey,
@@ -65,9 +72,20 @@ namespace xmreg
         uint64_t
         get_blk_timestamp(uint64_t blk_height);
 
+        bool
+        are_key_images_spent(const vector<key_image>& key_images,
+                             vector<bool>& spent);
+
+        bool
+        find_hash(const crypto::hash& hash,
+                  bool& is_tx, bool& is_block);
+
         bool
         get_block_complete_entry(block const& b, block_complete_entry& bce);
 
+        bool
+        get_block_complete_entry(uint64_t height, block_complete_entry& bce);
+
         string
         get_blkchain_path();
 
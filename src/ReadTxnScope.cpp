@@ -0,0 +1,87 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#include "ReadTxnScope.h"
+
+#include <iostream>
+
+namespace xmreg
+{
+
+ReadTxnScope::ReadTxnScope(BlockchainDB& _db)
+    : db {_db}
+{
+    try
+    {
+        // false if this thread has already read transaction open
+        started = db.block_rtxn_start();
+    }
+    catch (const std::exception& e)
+    {
+        // lookups still work, each in its own transaction
+        cerr << "Cant start read transaction: " << e.what() << endl;
+        ++failed_starts;
+        return;
+    }
+
+    if (!started)
+    {
+        ++txns_joined;
+        return;
+    }
+
+    start_time = clock::now();
+
+    ++txns_started;
+    ++open_txns;
+}
+
+ReadTxnScope::~ReadTxnScope()
+{
+    if (!started)
+        return;
+
+    db.block_rtxn_stop();
+
+    uint64_t open_time = std::chrono::duration_cast<
+            std::chrono::microseconds>(clock::now() - start_time).count();
+
+    total_open_time += open_time;
+    update_max(max_open_time, open_time);
+
+    --open_txns;
+}
+
+ReadTxnScope::stats
+ReadTxnScope::get_stats()
+{
+    stats current_stats;
+
+    current_stats.txns_started    = txns_started;
+    current_stats.txns_joined     = txns_joined;
+    current_stats.failed_starts   = failed_starts;
+    current_stats.open_txns       = open_txns;
+    current_stats.total_open_time = total_open_time;
+    current_stats.max_open_time   = max_open_time;
+
+    return current_stats;
+}
+
+void
+ReadTxnScope::update_max(std::atomic<uint64_t>& max_value, uint64_t value)
+{
+    uint64_t current_max = max_value;
+
+    while (value > current_max
+           && !max_value.compare_exchange_weak(current_max, value))
+    {}
+}
+
+std::atomic<uint64_t> ReadTxnScope::txns_started {0};
+std::atomic<uint64_t> ReadTxnScope::txns_joined {0};
+std::atomic<uint64_t> ReadTxnScope::failed_starts {0};
+std::atomic<uint64_t> ReadTxnScope::open_txns {0};
+std::atomic<uint64_t> ReadTxnScope::total_open_time {0};
+std::atomic<uint64_t> ReadTxnScope::max_open_time {0};
+}
@@ -0,0 +1,100 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_READTXNSCOPE_H
+#define XMRBLOCKS_READTXNSCOPE_H
+
+#include "monero_headers.h"
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+namespace xmreg
+{
+
+using namespace std;
+using namespace cryptonote;
+
+/**
+ * Keeps lmdb read transaction open for the lifetime of the object.
+ *
+ * Read transactions of BlockchainLMDB are per thread. Each lookup,
+ * e.g., get_tx_block_height() or get_output_key(), starts its own
+ * one unless the thread already has one open, in which case it
+ * just uses it. So creating ReadTxnScope at the start of a page
+ * handler makes all its lookups share one transaction, and see
+ * the same snapshot of the blockchain, even if a new block is
+ * added in the middle of the request.
+ *
+ * Nested scopes join the transaction of the outer one. Lookups
+ * done in other threads, e.g., in executor->parallel_for, are
+ * not covered and use their own transactions.
+ *
+ * The transaction stops readers from reusing pages freed by the
+ * writer, so scopes should not be kept over calls to the daemon
+ * or other waits.
+ */
+class ReadTxnScope
+{
+    using clock = std::chrono::steady_clock;
+
+public:
+
+    struct stats
+    {
+        // scopes which started new read transaction, and
+        // those which joined the one already open in the thread
+        uint64_t txns_started {0};
+        uint64_t txns_joined {0};
+        uint64_t failed_starts {0};
+
+        uint64_t open_txns {0};
+
+        // time transactions started by scopes
+        // were kept open, in microseconds
+        uint64_t total_open_time {0};
+        uint64_t max_open_time {0};
+    };
+
+    explicit ReadTxnScope(BlockchainDB& _db);
+
+    ReadTxnScope(const ReadTxnScope&) = delete;
+    ReadTxnScope& operator=(const ReadTxnScope&) = delete;
+
+    ~ReadTxnScope();
+
+    // true if this scope started the transaction,
+    // and so will stop it when destroyed
+    bool
+    owns_txn() const
+    {
+        return started;
+    }
+
+    static stats
+    get_stats();
+
+private:
+
+    static void
+    update_max(std::atomic<uint64_t>& max_value, uint64_t value);
+
+    BlockchainDB& db;
+
+    bool started {false};
+
+    clock::time_point start_time;
+
+    static std::atomic<uint64_t> txns_started;
+    static std::atomic<uint64_t> txns_joined;
+    static std::atomic<uint64_t> failed_starts;
+    static std::atomic<uint64_t> open_txns;
+    static std::atomic<uint64_t> total_open_time;
+    static std::atomic<uint64_t> max_open_time;
+};
+
+}
+
+#endif //XMRBLOCKS_READTXNSCOPE_H
@@ -0,0 +1,226 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_SHARDEDLRUCACHE_H
+#define XMRBLOCKS_SHARDEDLRUCACHE_H
+
+#include <list>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+
+namespace xmreg
+{
+
+/**
+ * Size bounded, thread safe LRU cache.
+ *
+ * Keys are spread over a number of shards, each
+ * with its own mutex, so that concurrent crow threads
+ * looking up different keys do not wait on each other.
+ *
+ * Values are returned by copy, so it is best to store
+ * std::shared_ptr<const T> in it for anything bigger
+ * than a few bytes.
+ */
+template <typename Key,
+          typename Value,
+          typename Hash = std::hash<Key>>
+class ShardedLruCache
+{
+    using Guard = std::lock_guard<std::mutex>;
+
+    using item_t = std::pair<Key, Value>;
+    using list_t = std::list<item_t>;
+
+    struct shard
+    {
+        std::mutex mtx;
+
+        // most recently used items are at the front
+        list_t items;
+
+        std::unordered_map<Key, typename list_t::iterator, Hash> index;
+
+        size_t capacity {1};
+    };
+
+public:
+
+    ShardedLruCache(size_t _capacity, size_t _no_of_shards = 16)
+        : capacity {_capacity}
+    {
+        _no_of_shards = std::max<size_t>(_no_of_shards, 1);
+
+        // each shard gets equal part of the total capacity
+        size_t shard_capacity = std::max<size_t>(
+                    (capacity + _no_of_shards - 1) / _no_of_shards, 1);
+
+        for (size_t i = 0; i < _no_of_shards; ++i)
+        {
+            shards.emplace_back(new shard());
+            shards.back()->capacity = shard_capacity;
+        }
+    }
+
+    ShardedLruCache(const ShardedLruCache&) = delete;
+    ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+    bool
+    get(const Key& key, Value& value)
+    {
+        shard& s = get_shard(key);
+
+        Guard lck (s.mtx);
+
+        auto it = s.index.find(key);
+
+        if (it == s.index.end())
+        {
+            ++no_of_misses;
+            return false;
+        }
+
+        // move the item to the front, i.e., mark as recently used
+        s.items.splice(s.items.begin(), s.items, it->second);
+
+        value = it->second->second;
+
+        ++no_of_hits;
+
+        return true;
+    }
+
+    void
+    put(const Key& key, Value value)
+    {
+        shard& s = get_shard(key);
+
+        Guard lck (s.mtx);
+
+        auto it = s.index.find(key);
+
+        if (it != s.index.end())
+        {
+            it->second->second = std::move(value);
+            s.items.splice(s.items.begin(), s.items, it->second);
+            return;
+        }
+
+        s.items.emplace_front(key, std::move(value));
+        s.index[key] = s.items.begin();
+
+        while (s.items.size() > s.capacity)
+        {
+            s.index.erase(s.items.back().first);
+            s.items.pop_back();
+        }
+    }
+
+    void
+    erase(const Key& key)
+    {
+        shard& s = get_shard(key);
+
+        Guard lck (s.mtx);
+
+        auto it = s.index.find(key);
+
+        if (it == s.index.end())
+            return;
+
+        s.items.erase(it->second);
+        s.index.erase(it);
+    }
+
+    // remove all items for which the predicate returns true,
+    // e.g., all blocks above given height after a reorg.
+    void
+    erase_if(std::function<bool(const Key&, const Value&)> pred)
+    {
+        for (auto& s: shards)
+        {
+            Guard lck (s->mtx);
+
+            for (auto it = s->items.begin(); it != s->items.end();)
+            {
+                if (pred(it->first, it->second))
+                {
+                    s->index.erase(it->first);
+                    it = s->items.erase(it);
+                    continue;
+                }
+
+                ++it;
+            }
+        }
+    }
+
+    void
+    clear()
+    {
+        for (auto& s: shards)
+        {
+            Guard lck (s->mtx);
+            s->items.clear();
+            s->index.clear();
+        }
+    }
+
+    size_t
+    size() const
+    {
+        size_t total {0};
+
+        for (auto& s: shards)
+        {
+            Guard lck (s->mtx);
+            total += s->items.size();
+        }
+
+        return total;
+    }
+
+    size_t
+    get_capacity() const
+    {
+        return capacity;
+    }
+
+    uint64_t
+    hits() const
+    {
+        return no_of_hits;
+    }
+
+    uint64_t
+    misses() const
+    {
+        return no_of_misses;
+    }
+
+private:
+
+    shard&
+    get_shard(const Key& key)
+    {
+        return *shards[Hash{}(key) % shards.size()];
+    }
+
+    size_t capacity;
+
+    std::vector<std::unique_ptr<shard>> shards;
+
+    std::atomic<uint64_t> no_of_hits {0};
+    std::atomic<uint64_t> no_of_misses {0};
+};
+
+}
+
+#endif //XMRBLOCKS_SHARDEDLRUCACHE_H
@@ -0,0 +1,215 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#include "ThreadPool.h"
+
+#include <iostream>
+#include <algorithm>
+
+namespace xmreg
+{
+
+ThreadPool::ThreadPool(size_t _no_of_threads, size_t _max_queue_size)
+    : max_queue_size {std::max<size_t>(_max_queue_size, 1)}
+{
+    if (_no_of_threads == 0)
+        _no_of_threads = std::max<size_t>(
+                boost::thread::hardware_concurrency(), 1);
+
+    for (size_t i = 0; i < _no_of_threads; ++i)
+        workers.emplace_back([this]() { worker_loop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+bool
+ThreadPool::try_submit(std::function<void()> task)
+{
+    {
+        Guard lck (tasks_mtx);
+
+        if (stopping || tasks.size() >= max_queue_size)
+            return false;
+
+        tasks.push_back(queued_task {std::move(task), clock::now()});
+    }
+
+    ++tasks_submitted;
+
+    tasks_cv.notify_one();
+
+    return true;
+}
+
+void
+ThreadPool::parallel_for(size_t no_of_items, size_t max_parallel,
+                         std::function<void(size_t)> f)
+{
+    if (no_of_items == 0)
+        return;
+
+    auto loop = std::make_shared<parallel_loop>();
+
+    loop->no_of_items = no_of_items;
+    loop->f           = std::move(f);
+
+    size_t no_of_helpers = std::min({std::max<size_t>(max_parallel, 1) - 1,
+                                     no_of_items - 1,
+                                     workers.size()});
+
+    // workers that start after all items were taken
+    // just return, so we dont wait for them
+    for (size_t i = 0; i < no_of_helpers; ++i)
+        if (!try_submit([loop]() { run_parallel_loop(*loop); }))
+            break;
+
+    run_parallel_loop(*loop);
+
+    std::unique_lock<std::mutex> lck (loop->mtx);
+
+    loop->done_cv.wait(lck, [&loop]() {
+        return loop->no_of_done == loop->no_of_items;
+    });
+
+    if (loop->error)
+        std::rethrow_exception(loop->error);
+}
+
+void
+ThreadPool::run_parallel_loop(parallel_loop& loop)
+{
+    size_t i;
+
+    while ((i = loop.next_item++) < loop.no_of_items)
+    {
+        std::exception_ptr item_error;
+
+        try
+        {
+            loop.f(i);
+        }
+        catch (...)
+        {
+            item_error = std::current_exception();
+        }
+
+        Guard lck (loop.mtx);
+
+        if (item_error && !loop.error)
+            loop.error = item_error;
+
+        if (++loop.no_of_done == loop.no_of_items)
+            loop.done_cv.notify_all();
+    }
+}
+
+void
+ThreadPool::stop()
+{
+    {
+        Guard lck (tasks_mtx);
+
+        if (stopping)
+            return;
+
+        stopping = true;
+    }
+
+    tasks_cv.notify_all();
+
+    // workers finish tasks that are still
+    // in the queue before they exit
+    for (boost::thread& worker: workers)
+        if (worker.joinable())
+            worker.join();
+}
+
+ThreadPool::stats
+ThreadPool::get_stats() const
+{
+    stats current_stats;
+
+    {
+        Guard lck (tasks_mtx);
+        current_stats.queue_depth = tasks.size();
+    }
+
+    current_stats.no_of_threads       = workers.size();
+    current_stats.max_queue_size      = max_queue_size;
+    current_stats.tasks_submitted     = tasks_submitted;
+    current_stats.tasks_completed     = tasks_completed;
+    current_stats.tasks_run_in_caller = tasks_run_in_caller;
+    current_stats.total_wait_time     = total_wait_time;
+    current_stats.max_wait_time       = max_wait_time;
+    current_stats.total_run_time      = total_run_time;
+    current_stats.max_run_time        = max_run_time;
+
+    return current_stats;
+}
+
+void
+ThreadPool::worker_loop()
+{
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+
+    while (true)
+    {
+        queued_task next_task;
+
+        {
+            std::unique_lock<std::mutex> lck (tasks_mtx);
+
+            tasks_cv.wait(lck, [this]() {
+                return stopping || !tasks.empty();
+            });
+
+            if (tasks.empty())
+                return; // stopping and nothing left to do
+
+            next_task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        clock::time_point start_time = clock::now();
+
+        uint64_t wait_time = duration_cast<microseconds>(
+                start_time - next_task.submit_time).count();
+
+        total_wait_time += wait_time;
+        update_max(max_wait_time, wait_time);
+
+        try
+        {
+            next_task.task();
+        }
+        catch (std::exception const& e)
+        {
+            std::cerr << "Task in thread pool failed: " << e.what() << std::endl;
+        }
+
+        uint64_t run_time = duration_cast<microseconds>(
+                clock::now() - start_time).count();
+
+        total_run_time += run_time;
+        update_max(max_run_time, run_time);
+
+        ++tasks_completed;
+    }
+}
+
+void
+ThreadPool::update_max(std::atomic<uint64_t>& max_value, uint64_t value)
+{
+    uint64_t current_max = max_value;
+
+    while (value > current_max
+           && !max_value.compare_exchange_weak(current_max, value))
+    {}
+}
+
+}
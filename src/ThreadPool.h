@@ -0,0 +1,182 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_THREADPOOL_H
+#define XMRBLOCKS_THREADPOOL_H
+
+#include <boost/thread/thread.hpp>
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include <type_traits>
+#include <exception>
+
+namespace xmreg
+{
+
+/**
+ * Fixed number of worker threads with bounded task queue.
+ *
+ * Used instead of std::async, so that we dont create new
+ * threads for each request. When the queue is full, submit()
+ * executes the task in the calling thread, so that under
+ * overload we just lose parallelism, rather than creating
+ * more and more threads or failing requests.
+ */
+class ThreadPool
+{
+    using Guard = std::lock_guard<std::mutex>;
+    using clock = std::chrono::steady_clock;
+
+    struct queued_task
+    {
+        std::function<void()> task;
+        clock::time_point submit_time;
+    };
+
+    // state of parallel_for shared by the caller and the workers
+    struct parallel_loop
+    {
+        size_t no_of_items;
+        std::function<void(size_t)> f;
+
+        std::atomic<size_t> next_item {0};
+
+        // guarded by mtx
+        size_t no_of_done {0};
+        std::exception_ptr error;
+
+        std::mutex mtx;
+        std::condition_variable done_cv;
+    };
+
+public:
+
+    struct stats
+    {
+        uint64_t no_of_threads {0};
+        uint64_t max_queue_size {0};
+        uint64_t queue_depth {0};
+        uint64_t tasks_submitted {0};
+        uint64_t tasks_completed {0};
+        uint64_t tasks_run_in_caller {0};
+
+        // time tasks spent waiting in the queue,
+        // and time it took to execute them, in microseconds
+        uint64_t total_wait_time {0};
+        uint64_t max_wait_time {0};
+        uint64_t total_run_time {0};
+        uint64_t max_run_time {0};
+    };
+
+    // no_of_threads equal 0 means number of cpu cores
+    ThreadPool(size_t _no_of_threads = 0,
+               size_t _max_queue_size = 256);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    /**
+     * Execute f in one of the worker threads,
+     * or in the calling thread if the queue is full.
+     *
+     * @return future for the result of f
+     */
+    template <typename F>
+    std::future<typename std::result_of<F()>::type>
+    submit(F f)
+    {
+        using result_t = typename std::result_of<F()>::type;
+
+        auto task = std::make_shared<std::packaged_task<result_t()>>(
+                std::move(f));
+
+        std::future<result_t> task_ftr = task->get_future();
+
+        if (!try_submit([task]() { (*task)(); }))
+        {
+            ++tasks_run_in_caller;
+            (*task)();
+        }
+
+        return task_ftr;
+    }
+
+    /**
+     * Call f(i) for each i from 0 to no_of_items - 1, using
+     * at most max_parallel threads, including the calling one.
+     *
+     * The calling thread processes items as well, so the loop
+     * progresses even if all workers are busy with other
+     * requests. Returns when all items are done. If f throws,
+     * the first exception is rethrown here.
+     */
+    void
+    parallel_for(size_t no_of_items, size_t max_parallel,
+                 std::function<void(size_t)> f);
+
+    /**
+     * Add task to the queue.
+     *
+     * @return false if the queue is full or
+     *         the pool is stopping
+     */
+    bool
+    try_submit(std::function<void()> task);
+
+    stats
+    get_stats() const;
+
+    size_t
+    get_no_of_threads() const
+    {
+        return workers.size();
+    }
+
+    void
+    stop();
+
+private:
+
+    void
+    worker_loop();
+
+    static void
+    run_parallel_loop(parallel_loop& loop);
+
+    static void
+    update_max(std::atomic<uint64_t>& max_value, uint64_t value);
+
+    size_t max_queue_size;
+
+    std::deque<queued_task> tasks;
+
+    mutable std::mutex tasks_mtx;
+    std::condition_variable tasks_cv;
+
+    bool stopping {false};
+
+    std::vector<boost::thread> workers;
+
+    std::atomic<uint64_t> tasks_submitted {0};
+    std::atomic<uint64_t> tasks_completed {0};
+    std::atomic<uint64_t> tasks_run_in_caller {0};
+    std::atomic<uint64_t> total_wait_time {0};
+    std::atomic<uint64_t> max_wait_time {0};
+    std::atomic<uint64_t> total_run_time {0};
+    std::atomic<uint64_t> max_run_time {0};
+};
+
+}
+
+#endif //XMRBLOCKS_THREADPOOL_H
@@ -0,0 +1,63 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+#ifndef XMRBLOCKS_UNIQUEKEYS_H
+#define XMRBLOCKS_UNIQUEKEYS_H
+
+#include <vector>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+#include <cstddef>
+
+namespace xmreg
+{
+
+/**
+ * Keys, e.g., hashes of txs used in rings, each kept once in
+ * order of their first use, with index of each one.
+ *
+ * Used to work on each of them only once, e.g., with
+ * executor->parallel_for over the indices, however many
+ * times they were added.
+ */
+template <typename Key, typename Hash = std::hash<Key>>
+class UniqueKeys
+{
+public:
+
+    // index of the key and true if it was not added before
+    std::pair<size_t, bool>
+    add(const Key& key)
+    {
+        auto it = indices.emplace(key, keys.size());
+
+        if (it.second)
+            keys.push_back(key);
+
+        return {it.first->second, it.second};
+    }
+
+    const Key&
+    operator[](size_t index) const
+    {
+        return keys[index];
+    }
+
+    size_t
+    size() const
+    {
+        return keys.size();
+    }
+
+private:
+
+    std::unordered_map<Key, size_t, Hash> indices;
+
+    std::vector<Key> keys;
+};
+
+}
+
+#endif //XMRBLOCKS_UNIQUEKEYS_H
@@ -26,6 +26,12 @@
 
 #include "CurrentBlockchainStatus.h"
 #include "MempoolStatus.h"
+#include "ShardedLruCache.h"
+#include "ThreadPool.h"
+#include "UniqueKeys.h"
+#include "HeaderIndex.h"
+#include "ChainTipWatcher.h"
+#include "JsonWriter.h"
 
 #include "../ext/crow/crow.h"
 
@@ -44,10 +50,14 @@ extern "C" void me_rx_slow_hash(const uint64_t mainheight, const uint64_t seedhe
 
 extern  __thread randomx_vm *rx_vm;
 
+#include <boost/chrono/thread_clock.hpp>
+
 #include <algorithm>
 #include <limits>
 #include <ctime>
 #include <future>
+#include <deque>
+#include <unordered_map>
 #include <type_traits>
 
 
@@ -75,6 +85,55 @@ extern  __thread randomx_vm *rx_vm;
 #define TMPL_MY_RAWOUTPUTKEYS       TMPL_DIR "/rawoutputkeys.html"
 #define TMPL_MY_CHECKRAWOUTPUTKEYS  TMPL_DIR "/checkrawoutputkeys.html"
 
+// limits of /api/outputsblocks. Blocks are scanned until
+// either of them is reached. Cpu time limit is in milliseconds,
+// summed over the threads doing the scanning.
+#define OUTPUTSBLOCKS_MAX_NO_OF_BLOCKS  500
+#define OUTPUTSBLOCKS_CPU_TIME_LIMIT    2000
+
+// max number of txs scanned for outputs in one batch
+#define OUTPUTS_SCAN_BATCH_SIZE         64
+
+// max number of threads, including the request's own one,
+// scanning txs for outputs for a single request
+#define OUTPUTS_SCAN_MAX_THREADS        4
+
+// key images are checked in parallel only if there
+// are at least that many of them for each thread
+#define KEY_IMAGES_CHECK_BATCH_SIZE     4096
+
+// number of key images checked for each part
+// of streamed /api/checkrawkeyimgs response
+#define KEY_IMAGES_STREAM_BATCH_SIZE    256
+
+// max number of threads, including the request's own one, decoding
+// blocks not yet in block_summary_cache for a single request
+#define BLOCK_DECODE_MAX_THREADS        4
+
+// max number of threads, including the request's own one, scanning
+// txs used in rings of a tx checked in show_my_outputs
+#define RING_SCAN_MAX_THREADS           4
+
+// max number of blocks added to the header index in one
+// read transaction, when it is loaded at startup
+#define HEADER_INDEX_BATCH_SIZE         10000
+
+// streamed json responses are sent in chunks of about that many bytes
+#define JSON_STREAM_CHUNK_SIZE          16384
+
+// txs and blocks with that many confirmations are assumed not to
+// change anymore, so their hex and raw json get immutable ETags
+#define IMMUTABLE_CONFIRMATIONS         10
+
+// pages of such txs and blocks show their age and confirmations,
+// so their weak ETags change every that many blocks. Cached copies
+// show age at most that much behind.
+#define PAGE_ETAG_CONFIRMATIONS_BUCKET  30
+
+// pages are rendered into buffer of the worker thread, which keeps
+// its capacity between requests, unless it grew larger than that
+#define RENDER_BUFFER_MAX_CAPACITY      (4 * 1024 * 1024)
+
 #define ONIONEXPLORER_RPC_VERSION_MAJOR 1
 #define ONIONEXPLORER_RPC_VERSION_MINOR 2
 #define MAKE_ONIONEXPLORER_RPC_VERSION(major,minor) (((major)<<16)|(minor))
@@ -192,8 +251,6 @@ using namespace cryptonote;
 using namespace crypto;
 using namespace std;
 
-using epee::string_tools::pod_to_hex;
-using epee::string_tools::hex_to_pod;
 
 template< typename T >
 std::string as_hex(T i)
@@ -271,7 +328,7 @@ me_get_block_longhash(const Blockchain *pbc,
   if (height == 202612)
   {
     static const std::string longhash_202612 = "84f64766475d51837ac9efbef1926486e58563c95a19fef4aec3254f03000000";
-    epee::string_tools::hex_to_pod(longhash_202612, res);
+    hex_to_pod(longhash_202612, res);
     return true;
   }
   blobdata bd = get_block_hashing_blob(b);
@@ -407,8 +464,8 @@ struct tx_details
     string
     get_extra_str() const
     {
-        return epee::string_tools::buff_to_hex_nodelimer(
-                string{reinterpret_cast<const char*>(extra.data()), extra.size()});
+        return buff_to_hex(boost::string_ref{
+                reinterpret_cast<const char*>(extra.data()), extra.size()});
     }
 
 
@@ -435,18 +492,253 @@ struct tx_details
     string
     print_signature(const signature& sig)
     {
-        stringstream ss;
+        char c_hex[2 * sizeof(sig.c)];
+        char r_hex[2 * sizeof(sig.r)];
+
+        pod_to_hex(sig.c, c_hex);
+        pod_to_hex(sig.r, r_hex);
+
+        string sig_hex;
+
+        sig_hex.reserve(sizeof(c_hex) + sizeof(r_hex));
 
-        ss << epee::string_tools::pod_to_hex(sig.c)
-           << epee::string_tools::pod_to_hex(sig.r);
+        sig_hex.append(c_hex, sizeof(c_hex))
+               .append(r_hex, sizeof(r_hex));
 
-        return ss.str();
+        return sig_hex;
     }
 
     ~tx_details() {};
 };
 
 
+/**
+* @brief The block_summary struct
+*
+* Rows of txs in a given block, as shown on the front
+* page and returned by /api/transactions. Apart from
+* age and number of confirmations, these never change
+* for a given block hash, so they can be cached.
+*/
+struct block_summary
+{
+    uint64_t height {0};
+    crypto::hash hash;
+    uint64_t timestamp {0};
+    uint64_t weight {0}; // in bytes
+
+    // one row for each tx for the index page,
+    // without age and confirmations
+    vector<mstch::map> tx_rows;
+
+    // the same txs for json api
+    json txs_json;
+};
+
+
+/**
+* @brief The index_snapshot struct
+*
+* Front page context prepared in advance by index
+* snapshot thread, so that requests only need to set
+* ages and render it.
+*/
+struct index_snapshot
+{
+    // what the snapshot was made for. if any of
+    // these change, a new snapshot is made
+    uint64_t chain_generation {0};
+    uint64_t height {0};
+    uint64_t mempool_generation {0};
+    uint64_t emission_blk_no {0};
+    MempoolStatus::network_info network_info;
+
+    mstch::map context;
+
+    // index of the first tx row of each block
+    // in context["txs"] and block's timestamp
+    vector<pair<size_t, uint64_t>> block_rows;
+
+    mstch::map mempool_context;
+};
+
+
+/**
+* @brief The ring_member struct
+*
+* Output used as a ring member, resolved from its amount
+* and global index, together with a summary of its tx,
+* as shown in mixin details of a tx.
+*/
+struct ring_member
+{
+    // to check that the output at given global
+    // index did not change due to reorg
+    public_key output_pubkey;
+
+    crypto::hash tx_hash;
+    uint64_t out_idx {0};
+    uint64_t height {0};
+    uint64_t timestamp {0};
+
+    uint64_t mixin_no {0};
+    uint64_t no_of_inputs {0};
+    uint64_t no_of_outputs {0};
+};
+
+// hash of <amount, global output index> pair
+struct output_index_hash
+{
+    size_t
+    operator()(pair<uint64_t, uint64_t> const& amount_idx) const
+    {
+        return std::hash<uint64_t>{}(
+                amount_idx.second ^ (amount_idx.first * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+/**
+* @brief The mixin_tx_scan struct
+*
+* Tx used in rings of a tx checked in show_my_outputs,
+* with its outputs checked against the given address.
+*/
+struct mixin_tx_scan
+{
+    struct output
+    {
+        public_key pub_key;
+        uint64_t out_idx {0};
+
+        // decoded from ringct for our outputs
+        uint64_t amount {0};
+
+        bool mine {false};
+    };
+
+    crypto::hash tx_hash;
+    public_key tx_pub_key;
+    uint64_t version {0};
+
+    // false if the tx cant be read
+    bool found {false};
+
+    // false if key derivation failed
+    bool derived {false};
+
+    vector<output> outputs;
+};
+
+
+/**
+* @brief The output_scan_tx struct
+*
+* Tx to be scanned for outputs of given address
+* and where it comes from.
+*/
+struct output_scan_tx
+{
+    const transaction* tx {nullptr};
+    uint64_t block_no {0};
+    bool is_mempool {false};
+};
+
+
+/**
+* Producer of json response sent with chunked transfer
+* encoding. Each call appends next part of the response
+* and returns false after the last one. The string can
+* already have earlier parts in it, so parts are limited
+* by how much a call adds, not by the size of the string.
+*/
+using json_stream = std::function<bool(string&)>;
+
+// stream of already complete json response, e.g., an error
+inline json_stream
+make_json_stream(json const& j_response)
+{
+    string response_str = j_response.dump();
+
+    return [response_str](string& chunk)
+    {
+        chunk += response_str;
+        return false;
+    };
+}
+
+// producer of other response bodies, sent
+// in the same way as json_stream
+using body_stream = std::function<bool(string&)>;
+
+inline body_stream
+make_text_stream(string text)
+{
+    return [text](string& chunk)
+    {
+        chunk += text;
+        return false;
+    };
+}
+
+// hex of the blob, encoded part by part as
+// it is sent, rather than all at once
+inline body_stream
+make_hex_stream(string&& blob)
+{
+    shared_ptr<const string> blob_ptr
+            = make_shared<const string>(std::move(blob));
+
+    size_t pos {0};
+
+    return [blob_ptr, pos](string& chunk) mutable
+    {
+        size_t no_of_bytes = std::min<size_t>(
+                blob_ptr->size() - pos, JSON_STREAM_CHUNK_SIZE / 2);
+
+        size_t start = chunk.size();
+
+        chunk.resize(start + 2 * no_of_bytes);
+
+        if (no_of_bytes > 0)
+            hex_encode(blob_ptr->data() + pos, no_of_bytes, &chunk[start]);
+
+        pos += no_of_bytes;
+
+        return pos < blob_ptr->size();
+    };
+}
+
+
+/**
+* @brief The search_target struct
+*
+* What a search string refers to, found with a few
+* index probes, before anything is fetched or rendered.
+*/
+struct search_target
+{
+    enum class kind
+    {
+        not_found,
+        tx,
+        mempool_tx,
+        block_hash,
+        block_height,
+        address,
+        integrated_address,
+        invalid_address
+    };
+
+    kind what {kind::not_found};
+
+    crypto::hash hash {null_hash};
+    uint64_t block_height {0};
+
+    address_parse_info address_info;
+    cryptonote::network_type address_nettype {cryptonote::network_type::MAINNET};
+};
+
+
 class page
 {
 
@@ -454,7 +746,13 @@ static const bool FULL_AGE_FORMAT {true};
 
 MicroCore* mcore;
 Blockchain* core_storage;
-rpccalls rpc;
+
+// connections to the deamon, shared with MempoolStatus
+rpccalls* rpc;
+
+// shared worker threads for things that we dont want
+// to wait for in crow's threads, e.g., rpc calls to the deamon
+ThreadPool* executor;
 
 atomic<time_t> server_timestamp;
 
@@ -487,6 +785,37 @@ string mainnet_url;
 string js_html_files;
 string js_html_files_all_in_one;
 
+// decoding of blocks and their txs for the front page
+// and /api/transactions is cached here. key is block height,
+// and the cached block hash is checked on each access, so
+// that old entries are not used after reorgs.
+ShardedLruCache<uint64_t, shared_ptr<const block_summary>> block_summary_cache;
+
+// ring members resolved for mixin details of txs. key is
+// <amount, global output index>. ring members of popular txs
+// overlap a lot, so most of them are found here.
+ShardedLruCache<pair<uint64_t, uint64_t>, ring_member,
+                output_index_hash> ring_member_cache;
+
+// in index snapshot mode, the first page of the index is
+// prepared in advance by index_snapshot_thread whenever
+// blockchain, mempool, network info or emission change.
+bool enable_index_snapshot;
+
+boost::thread index_snapshot_thread;
+
+// use std::atomic_load/atomic_store to access it
+shared_ptr<const index_snapshot> current_index_snapshot;
+
+// hash, timestamp, weight, etc. of each block, kept up to
+// date by header_index_thread. Heights it does not have yet
+// are read from the blockchain.
+bool enable_header_index;
+
+boost::thread header_index_thread;
+
+HeaderIndex header_index;
+
 // instead of constatnly reading template files
 // from hard drive for each request, we can read
 // them only once, when the explorer starts into this map
@@ -494,11 +823,18 @@ string js_html_files_all_in_one;
 // read operation in OS
 map<string, string> template_file;
 
+// template_file entries tokenized once at startup, with
+// partials they use, so that pages are not parsed again
+// on every request
+map<string, mstch::compiled_template> compiled_templates;
+
+// part of ETags of pages rendered from the templates
+string templates_version;
+
 public:
 
 page(MicroCore* _mcore,
      Blockchain* _core_storage,
-     string _deamon_url,
      cryptonote::network_type _nettype,
      bool _enable_pusher,
      bool _enable_randomx,
@@ -512,10 +848,16 @@ page(MicroCore* _mcore,
      string _testnet_url,
      string _stagenet_url,
      string _mainnet_url,
-     rpccalls::login_opt _daemon_rpc_login)
+     rpccalls* _rpc,
+     ThreadPool* _executor,
+     size_t _block_cache_size = 1000,
+     bool _enable_index_snapshot = false,
+     size_t _ring_member_cache_size = 100000,
+     bool _enable_header_index = false)
         : mcore {_mcore},
           core_storage {_core_storage},
-          rpc {_deamon_url, _daemon_rpc_login},
+          rpc {_rpc},
+          executor {_executor},
           server_timestamp {std::time(nullptr)},
           nettype {_nettype},
           enable_pusher {_enable_pusher},
@@ -529,7 +871,11 @@ page(MicroCore* _mcore,
           mempool_info_timeout {_mempool_info_timeout},
           testnet_url {_testnet_url},
           stagenet_url {_stagenet_url},
-          mainnet_url {_mainnet_url}
+          mainnet_url {_mainnet_url},
+          block_summary_cache {_block_cache_size},
+          ring_member_cache {_ring_member_cache_size},
+          enable_index_snapshot {_enable_index_snapshot},
+          enable_header_index {_enable_header_index}
 {
     mainnet = nettype == cryptonote::network_type::MAINNET;
     testnet = nettype == cryptonote::network_type::TESTNET;
@@ -564,6 +910,18 @@ page(MicroCore* _mcore,
     template_file["tx_details"]      = xmreg::read(string(TMPL_PARIALS_DIR) + "/tx_details.html");
     template_file["tx_table_header"] = xmreg::read(string(TMPL_PARIALS_DIR) + "/tx_table_header.html");
     template_file["tx_table_row"]    = xmreg::read(string(TMPL_PARIALS_DIR) + "/tx_table_row.html");
+
+    compile_templates();
+
+    // templates are read at startup, so they can change without
+    // rebuilding the explorer. Their hash is in ETags of pages.
+    string all_templates;
+
+    for (auto const& tmpl: template_file)
+        all_templates += tmpl.second;
+
+    templates_version = pod_to_hex(crypto::cn_fast_hash(
+            all_templates.data(), all_templates.size())).substr(0, 16);
 }
 
 /**
@@ -575,23 +933,26 @@ page(MicroCore* _mcore,
 string
 index2(uint64_t page_no = 0, bool refresh_page = false)
 {
-
-    // we get network info, such as current hash rate
-    // but since this makes a rpc call to deamon, we make it as an async
-    // call. this way we dont have to wait with execution of the rest of the
-    // index2 method, until deamon gives as the required result.
-    std::future<json> network_info_ftr = std::async(std::launch::async, [&]
+    // in snapshot mode, the first page is prepared in advance
+    // by the index snapshot thread. so we just fill in ages
+    // and render it, as long as it is for the current height.
+    if (page_no == 0 && enable_index_snapshot)
     {
-        json j_info;
-
-        get_monero_network_info(j_info);
-
-        return j_info;
-    });
+        shared_ptr<const index_snapshot> snapshot
+                = std::atomic_load(&current_index_snapshot);
 
+        if (snapshot && snapshot->chain_generation
+                == ChainTipWatcher::generation)
+        {
+            return render_index_snapshot(*snapshot, refresh_page);
+        }
+    }
 
-    // get mempool for the front page also using async future
-    std::future<string> mempool_ftr = std::async(std::launch::async, [&]
+    // get mempool for the front page in the executor's thread,
+    // so that we dont wait for it if it takes too long.
+    // network info is not fetched here, as it is already
+    // cached by MempoolStatus thread.
+    std::future<string> mempool_ftr = executor->submit([this]()
     {
         // get memory pool rendered template
         return mempool(false, no_of_mempool_tx_of_frontpage);
@@ -603,365 +964,236 @@ index2(uint64_t page_no = 0, bool refresh_page = false)
     uint64_t local_copy_server_timestamp = server_timestamp;
 
     // get the current blockchain height. Just to check
-    uint64_t height = core_storage->get_current_blockchain_height();
+    uint64_t height = ChainTipWatcher::get_height();
 
-    // number of last blocks to show
-    uint64_t no_of_last_blocks = std::min(no_blocks_on_index + 1, height);
+    // get current network info from MemoryStatus thread.
+    MempoolStatus::network_info current_network_info
+        = MempoolStatus::current_network_info;
 
-    // initalise page tempate map with basic info about blockchain
-    mstch::map context {
-            {"testnet"                  , testnet},
-            {"stagenet"                 , stagenet},
-            {"testnet_url"              , testnet_url},
-            {"stagenet_url"             , stagenet_url},
-            {"mainnet_url"              , mainnet_url},
-            {"refresh"                  , refresh_page},
-            {"height"                   , height},
-            {"server_timestamp"         , xmreg::timestamp_to_str_gm(local_copy_server_timestamp)},
-            {"age_format"               , string("[h:m:d]")},
-            {"page_no"                  , page_no},
-            {"total_page_no"            , (height / no_of_last_blocks)},
-            {"is_page_zero"             , !bool(page_no)},
-            {"no_of_last_blocks"        , no_of_last_blocks},
-            {"next_page"                , (page_no + 1)},
-            {"prev_page"                , (page_no > 0 ? page_no - 1 : 0)},
-            {"enable_pusher"            , enable_pusher},
-            {"enable_key_image_checker" , enable_key_image_checker},
-            {"enable_output_key_checker", enable_output_key_checker},
-            {"enable_autorefresh_option", enable_autorefresh_option}
-    };
+    // rows with the first tx of each block and block's timestamp
+    vector<pair<size_t, uint64_t>> block_rows;
 
-    context.emplace("txs", mstch::array()); // will keep tx to show
+    mstch::map context = get_index_context(page_no, refresh_page,
+                                           height,
+                                           current_network_info,
+                                           block_rows);
 
-    // get reference to txs mstch map to be field below
-    mstch::array& txs = boost::get<mstch::array>(context["txs"]);
+    set_index_ages(context, block_rows,
+                   current_network_info,
+                   local_copy_server_timestamp);
 
-    // calculate starting and ending block numbers to show
-    int64_t start_height = height - no_of_last_blocks * (page_no + 1);
+    string mempool_html {"Cant get mempool_pool"};
 
-    // check if start height is not below range
-    start_height = start_height < 0 ? 0 : start_height;
+    // get mempool data for the front page, if ready. If not, then just skip.
+    std::future_status mempool_ftr_status = mempool_ftr.wait_for(
+            std::chrono::milliseconds(mempool_info_timeout));
 
-    int64_t end_height = start_height + no_of_last_blocks - 1;
+    if (mempool_ftr_status == std::future_status::ready)
+    {
+        mempool_html = mempool_ftr.get();
+    }
+    else
+    {
+        cerr  << "mempool future not ready yet, skipping." << endl;
+        mempool_html = render_page(compiled_templates.at("mempool_error"), context);
+    }
 
-    vector<double> blk_sizes;
+    // append mempool_html to the index context map
+    context["mempool_info"] = mempool_html;
 
-    // loop index
-    int64_t i = end_height;
+    // render the page
+    return render_page(compiled_templates.at("index2"), context);
+}
 
-    // iterate over last no_of_last_blocks of blocks
-    while (i >= start_height)
-    {
-        // get block at the given height i
-        block blk;
+/**
+ * Render mempool data
+ */
+string
+mempool(bool add_header_and_footer = false, uint64_t no_of_mempool_tx = 25)
+{
+    mstch::map context = get_mempool_context(add_header_and_footer,
+                                             no_of_mempool_tx);
 
-        if (!mcore->get_block_by_height(i, blk))
-        {
-            cerr << "Cant get block: " << i << endl;
-            --i;
-            continue;
-        }
+    set_mempool_ages(context, server_timestamp);
 
-        // get block's hash
-        crypto::hash blk_hash = core_storage->get_block_id_by_height(i);
+    if (add_header_and_footer)
+    {
+        // render the page
+        return render_page(compiled_templates.at("mempool_full"), context);
+    }
 
-        // get block size in kB
-        double blk_size = static_cast<double>(core_storage->get_db().get_block_weight(i))/1024.0;
+    // render the page
+    return render_page(compiled_templates.at("mempool"), context);
+}
 
-        string blk_size_str = fmt::format("{:0.2f}", blk_size);
+/**
+ * Start thread which keeps current_index_snapshot
+ * up to date with the blockchain, mempool, network info
+ * and emission. The snapshot is rebuilt only if any of
+ * these changed.
+ */
+void
+start_index_snapshot_thread()
+{
+    if (!enable_index_snapshot || index_snapshot_thread.joinable())
+        return;
 
-        blk_sizes.push_back(blk_size);
+    index_snapshot_thread = boost::thread{[this]()
+    {
+        try
+        {
+            while (true)
+            {
+                uint64_t tip_generation = ChainTipWatcher::generation;
 
-        // remove "<" and ">" from the hash string
-        string blk_hash_str = pod_to_hex(blk_hash);
+                shared_ptr<const index_snapshot> snapshot
+                        = std::atomic_load(&current_index_snapshot);
 
-        // get block age
-        pair<string, string> age = get_age(local_copy_server_timestamp, blk.timestamp);
+                MempoolStatus::network_info current_network_info
+                        = MempoolStatus::current_network_info;
 
-        context["age_format"] = age.second;
+                uint64_t emission_blk_no {0};
 
-        // start measure time here
-        auto start = std::chrono::steady_clock::now();
+                if (CurrentBlockchainStatus::is_thread_running())
+                    emission_blk_no = CurrentBlockchainStatus::get_emission().blk_no;
 
-        // get all transactions in the block found
-        // initialize the first list with transaction for solving
-        // the block i.e. coinbase.
-        vector<cryptonote::transaction> blk_txs {blk.miner_tx};
-        vector<crypto::hash> missed_txs;
+                if (!snapshot
+                    || snapshot->chain_generation != tip_generation
+                    || snapshot->mempool_generation != MempoolStatus::mempool_generation
+                    || snapshot->network_info.info_timestamp != current_network_info.info_timestamp
+                    || snapshot->emission_blk_no != emission_blk_no)
+                {
+                    try
+                    {
+                        std::atomic_store(&current_index_snapshot,
+                                          make_index_snapshot());
+                    }
+                    catch (std::exception const& e)
+                    {
+                        cerr << "Cant make index snapshot: " << e.what() << endl;
+                    }
+                }
 
-        if (!core_storage->get_transactions(blk.tx_hashes, blk_txs, missed_txs))
+                // new block wakes us up right away. mempool, network
+                // info and emission are checked twice a second.
+                ChainTipWatcher::wait_for_new_tip(
+                        tip_generation, boost::chrono::milliseconds(500));
+            }
+        }
+        catch (boost::thread_interrupted&)
         {
-            cerr << "Cant get transactions in block: " << i << endl;
-            --i;
-            continue;
+            cout << "Index snapshot thread interrupted." << endl;
+            return;
         }
+    }};
+}
+
+void
+stop_index_snapshot_thread()
+{
+    if (!index_snapshot_thread.joinable())
+        return;
 
-        uint64_t tx_i {0};
+    index_snapshot_thread.interrupt();
+    index_snapshot_thread.join();
+}
 
-        //          tx_hash     , txd_map
-        vector<pair<crypto::hash, mstch::node>> txd_pairs;
+/**
+ * Loads the header index and then keeps adding
+ * new blocks to it, and dropping reorganized ones.
+ */
+void
+start_header_index_thread()
+{
+    if (!enable_header_index || header_index_thread.joinable())
+        return;
 
-        for(auto it = blk_txs.begin(); it != blk_txs.end(); ++it)
+    header_index_thread = boost::thread{[this]()
+    {
+        try
         {
-            const cryptonote::transaction& tx = *it;
+            bool loaded {false};
 
-            const tx_details& txd = get_tx_details(tx, false, i, height);
+            while (true)
+            {
+                uint64_t tip_generation = ChainTipWatcher::generation;
 
-            mstch::map txd_map = txd.get_mstch_map();
+                bool updated = header_index.update(core_storage->get_db(),
+                                                   HEADER_INDEX_BATCH_SIZE);
 
-            //add age to the txd mstch map
-            txd_map.insert({"height"    , i});
-            txd_map.insert({"blk_hash"  , blk_hash_str});
-            txd_map.insert({"age"       , age.first});
-            txd_map.insert({"is_ringct" , (tx.version > 1)});
-            txd_map.insert({"rct_type"  , tx.rct_signatures.type});
-            txd_map.insert({"blk_size"  , blk_size_str});
+                boost::this_thread::interruption_point();
 
+                // initial scan is done in batches, so that the thread
+                // can be interrupted and lookups use what is already
+                // in the index
+                if (updated && header_index.size()
+                        < ChainTipWatcher::get_height())
+                {
+                    continue;
+                }
 
-            // do not show block info for other than first tx in a block
-            if (tx_i > 0)
-            {
-                txd_map["height"]     = string("");
-                txd_map["age"]        = string("");
-                txd_map["blk_size"]   = string("");
-            }
+                if (updated && !loaded)
+                {
+                    cout << "Header index loaded: " << header_index.size()
+                         << " blocks, "
+                         << header_index.memory_usage() / (1024 * 1024)
+                         << " MB" << endl;
 
-            txd_pairs.emplace_back(txd.hash, txd_map);
-
-            ++tx_i;
-
-        } // for(list<cryptonote::transaction>::reverse_iterator rit = blk_txs.rbegin();
+                    loaded = true;
+                }
 
-        // copy tx maps from txs_maps_tmp into txs array,
-        // that will go to templates
-        for (const pair<crypto::hash, mstch::node>& txd_pair: txd_pairs)
+                // new blocks are added as soon as they arrive. the
+                // timeout is only to retry if the update failed.
+                ChainTipWatcher::wait_for_new_tip(
+                        tip_generation, boost::chrono::seconds(10));
+            }
+        }
+        catch (boost::thread_interrupted&)
         {
-            txs.push_back(boost::get<mstch::map>(txd_pair.second));
+            cout << "Header index thread interrupted." << endl;
+            return;
         }
+    }};
+}
 
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>
-                (std::chrono::steady_clock::now() - start);
-
-        --i; // go to next block number
-
-    } // while (i <= end_height)
-
-    // calculate median size of the blocks shown
-    //double blk_size_median = xmreg::calc_median(blk_sizes.begin(), blk_sizes.end());
-
-    // get current network info from MemoryStatus thread.
-    MempoolStatus::network_info current_network_info
-        = MempoolStatus::current_network_info;
-
-    // perapre network info mstch::map for the front page
-    string hash_rate;
-
-    double hr_d;
-    char metric_prefix;
-
-    cryptonote::difficulty_type hr = make_difficulty(
-            current_network_info.hash_rate, 
-            current_network_info.hash_rate_top64);
-
-    get_metric_prefix(hr, hr_d, metric_prefix);
-
-    if (metric_prefix != 0)
-        hash_rate = fmt::format("{:0.3f} {:c}H/s", hr_d, metric_prefix);
-    else
-        hash_rate = fmt::format("{:s} H/s", hr.str());
-
-    pair<string, string> network_info_age = get_age(local_copy_server_timestamp,
-                                                    current_network_info.info_timestamp);
-
-    // if network info is younger than 2 minute, assume its current. No sense
-    // showing that it is not current if its less then block time.
-    if (local_copy_server_timestamp - current_network_info.info_timestamp < 120)
-    {
-        current_network_info.current = true;
-    }
-
-    context["network_info"] = mstch::map {
-            {"difficulty"        , current_network_info.difficulty},
-            {"hash_rate"         , hash_rate},
-            {"fee_per_kb"        , print_money(current_network_info.fee_per_kb)},
-            {"alt_blocks_no"     , current_network_info.alt_blocks_count},
-            {"have_alt_block"    , (current_network_info.alt_blocks_count > 0)},
-            {"tx_pool_size"      , current_network_info.tx_pool_size},
-            {"block_size_limit"  , string {current_network_info.block_size_limit_str}},
-            {"block_size_median" , string {current_network_info.block_size_median_str}},
-            {"is_current_info"   , current_network_info.current},
-            {"is_pool_size_zero" , (current_network_info.tx_pool_size == 0)},
-            {"current_hf_version", current_network_info.current_hf_version},
-            {"age"               , network_info_age.first},
-            {"age_format"        , network_info_age.second},
-    };
-
-    // median size of 100 blocks
-    context["blk_size_median"] = string {current_network_info.block_size_median_str};
-
-    string mempool_html {"Cant get mempool_pool"};
-
-    // get mempool data for the front page, if ready. If not, then just skip.
-    std::future_status mempool_ftr_status = mempool_ftr.wait_for(
-            std::chrono::milliseconds(mempool_info_timeout));
-
-    if (mempool_ftr_status == std::future_status::ready)
-    {
-        mempool_html = mempool_ftr.get();
-    }
-    else
-    {
-        cerr  << "mempool future not ready yet, skipping." << endl;
-        mempool_html = mstch::render(template_file["mempool_error"], context);
-    }
-
-    if (CurrentBlockchainStatus::is_thread_running())
-    {
-        CurrentBlockchainStatus::Emission current_values
-                = CurrentBlockchainStatus::get_emission();
-
-        string emission_blk_no   = std::to_string(current_values.blk_no - 1);
-        string emission_coinbase = xmr_amount_to_str(current_values.coinbase, "{:0.3f}");
-        string emission_fee      = xmr_amount_to_str(current_values.fee, "{:0.3f}");
-
-        context["emission"] = mstch::map {
-                {"blk_no"    , emission_blk_no},
-                {"amount"    , emission_coinbase},
-                {"fee_amount", emission_fee}
-        };
-    }
-    else
-    {
-        cerr  << "emission thread not running, skipping." << endl;
-    }
-
-
-    // get memory pool rendered template
-    //string mempool_html = mempool(false, no_of_mempool_tx_of_frontpage);
-
-    // append mempool_html to the index context map
-    context["mempool_info"] = mempool_html;
-
-    add_css_style(context);
+void
+stop_header_index_thread()
+{
+    if (!header_index_thread.joinable())
+        return;
 
-    // render the page
-    return mstch::render(template_file["index2"], context);
+    header_index_thread.interrupt();
+    header_index_thread.join();
 }
 
 /**
- * Render mempool data
+ * Drops cached blocks, ring members and the index snapshot
+ * from fork_height up. Called by ChainTipWatcher right after
+ * it finds reorganization, so that they dont wait to be
+ * pushed out of the caches. Lookups check hashes of cached
+ * entries anyway, so this frees their memory rather than
+ * making them correct.
  */
-string
-mempool(bool add_header_and_footer = false, uint64_t no_of_mempool_tx = 25)
+void
+evict_reorged_blocks(uint64_t fork_height)
 {
-    std::vector<MempoolStatus::mempool_tx> mempool_txs;
-
-    if (add_header_and_footer)
-    {
-        // get all memmpool txs
-        mempool_txs = MempoolStatus::get_mempool_txs();
-        no_of_mempool_tx = mempool_txs.size();
-    }
-    else
-    {
-        // get only first no_of_mempool_tx txs
-        mempool_txs = MempoolStatus::get_mempool_txs(no_of_mempool_tx);
-        no_of_mempool_tx = std::min<uint64_t>(no_of_mempool_tx, mempool_txs.size());
-    }
-
-    // total size of mempool in bytes
-    uint64_t mempool_size_bytes = MempoolStatus::mempool_size;
-
-    // reasign this number, in case no of txs in mempool is smaller
-    // than what we requested or we want all txs.
-
-
-    uint64_t total_no_of_mempool_tx = MempoolStatus::mempool_no;
-
-    // initalise page tempate map with basic info about mempool
-    mstch::map context {
-            {"mempool_size"          , static_cast<uint64_t>(total_no_of_mempool_tx)}, // total no of mempool txs
-            {"mempool_refresh_time"  , MempoolStatus::mempool_refresh_time}
-    };
-
-    context.emplace("mempooltxs" , mstch::array());
-
-    // get reference to blocks template map to be field below
-    mstch::array& txs = boost::get<mstch::array>(context["mempooltxs"]);
-
-    uint64_t local_copy_server_timestamp = server_timestamp;
-
-    // for each transaction in the memory pool
-    for (size_t i = 0; i < no_of_mempool_tx; ++i)
+    block_summary_cache.erase_if(
+            [fork_height](uint64_t const& blk_height,
+                          shared_ptr<const block_summary> const&)
     {
-        // get transaction info of the tx in the mempool
-        const MempoolStatus::mempool_tx& mempool_tx = mempool_txs.at(i);
-
-        // calculate difference between tx in mempool and server timestamps
-        array<size_t, 5> delta_time = timestamp_difference(
-                local_copy_server_timestamp,
-                mempool_tx.receive_time);
-
-        // use only hours, so if we have days, add
-        // it to hours
-        uint64_t delta_hours {delta_time[1]*24 + delta_time[2]};
-
-        string age_str = fmt::format("{:02d}:{:02d}:{:02d}",
-                                     delta_hours,
-                                     delta_time[3], delta_time[4]);
-
-        // if more than 99 hourse, change formating
-        // for the template
-        if (delta_hours > 99)
-        {
-            age_str = fmt::format("{:03d}:{:02d}:{:02d}",
-                                  delta_hours,
-                                  delta_time[3], delta_time[4]);
-        }
-
-
-        // set output page template map
-        txs.push_back(mstch::map {
-                {"timestamp_no"    , mempool_tx.receive_time},
-                {"timestamp"       , mempool_tx.timestamp_str},
-                {"age"             , age_str},
-                {"hash"            , pod_to_hex(mempool_tx.tx_hash)},
-                {"fee"             , mempool_tx.fee_micro_str},
-                {"payed_for_kB"    , mempool_tx.payed_for_kB_micro_str},
-                {"xmr_inputs"      , mempool_tx.xmr_inputs_str},
-                {"xmr_outputs"     , mempool_tx.xmr_outputs_str},
-                {"no_inputs"       , mempool_tx.no_inputs},
-                {"no_outputs"      , mempool_tx.no_outputs},
-                {"no_nonrct_inputs", mempool_tx.num_nonrct_inputs},
-                {"mixin"           , mempool_tx.mixin_no},
-                {"txsize"          , mempool_tx.txsize}
-        });
-    }
-
-    context.insert({"mempool_size_kB",
-                    fmt::format("{:0.2f}",
-                                static_cast<double>(mempool_size_bytes)/1024.0)});
+        return blk_height >= fork_height;
+    });
 
-    if (add_header_and_footer)
+    ring_member_cache.erase_if(
+            [fork_height](pair<uint64_t, uint64_t> const&,
+                          ring_member const& member)
     {
-        // this is when mempool is on its own page, /mempool
-        add_css_style(context);
-
-        context["partial_mempool_shown"] = false;
-
-        // render the page
-        return mstch::render(template_file["mempool_full"], context);
-    }
-
-    // this is for partial disply on front page.
-
-    context["mempool_fits_on_front_page"]    = (total_no_of_mempool_tx <= mempool_txs.size());
-    context["no_of_mempool_tx_of_frontpage"] = no_of_mempool_tx;
-
-    context["partial_mempool_shown"] = true;
+        return member.height >= fork_height;
+    });
 
-    // render the page
-    return mstch::render(template_file["mempool"], context);
+    // its top blocks are reorganized, so it must be made again
+    std::atomic_store(&current_index_snapshot,
+                      shared_ptr<const index_snapshot> {});
 }
 
 
@@ -978,22 +1210,29 @@ altblocks()
 
     uint64_t local_copy_server_timestamp = server_timestamp;
 
-    // get reference to alt blocks template map to be field below
-    mstch::array& blocks = boost::get<mstch::array>(context["blocks"]);
-
     vector<string> atl_blks_hashes;
 
-    if (!rpc.get_alt_blocks(atl_blks_hashes))
+    std::function<bool(vector<string>&)> alt_blocks_call
+            = [this](vector<string>& hashes)
+    {
+        return rpc->get_alt_blocks(hashes);
+    };
+
+    if (!call_rpc(alt_blocks_call, atl_blks_hashes))
     {
-        cerr << "rpc.get_alt_blocks(atl_blks_hashes) failed" << endl;
+        cerr << "rpc->get_alt_blocks(atl_blks_hashes) failed" << endl;
     }
 
     context.emplace("no_alt_blocks", (uint64_t)atl_blks_hashes.size());
 
+    // get reference to alt blocks template map to be field below.
+    // taken after all keys are in the context, as adding new
+    // keys would invalidate it.
+    mstch::array& blocks = boost::get<mstch::array>(context["blocks"]);
+
     for (const string& alt_blk_hash: atl_blks_hashes)
     {
         block alt_blk;
-        string error_msg;
 
         int64_t no_of_txs {-1};
         int64_t blk_height {-1};
@@ -1001,8 +1240,15 @@ altblocks()
         // get block age
         pair<string, string> age {"-1", "-1"};
 
+        // the hash is copied, as the call can outlive this loop
+        std::function<bool(block&)> get_block_call
+                = [this, alt_blk_hash](block& blk)
+        {
+            string error_msg;
+            return rpc->get_block(alt_blk_hash, blk, error_msg);
+        };
 
-        if (rpc.get_block(alt_blk_hash, alt_blk, error_msg))
+        if (call_rpc(get_block_call, alt_blk))
         {
             no_of_txs  = alt_blk.tx_hashes.size();
 
@@ -1023,13 +1269,15 @@ altblocks()
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["altblocks"], context);
+    return render_page(compiled_templates.at("altblocks"), context);
 }
 
 
 string
 show_block(uint64_t _blk_height)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     // get block at the given height i
     block blk;
 
@@ -1055,8 +1303,9 @@ show_block(uint64_t _blk_height)
         return fmt::format("Cant get block {:d}!", _blk_height);
     }
 
-    // get block's hash
-    crypto::hash blk_hash = core_storage->get_block_id_by_height(_blk_height);
+    // get block's hash. not from the header index, as after a
+    // reorg it can still have the old block at this height.
+    crypto::hash blk_hash = get_block_hash(blk);
 
     crypto::hash prev_hash = blk.prev_id;
     crypto::hash next_hash = null_hash;
@@ -1087,15 +1336,14 @@ show_block(uint64_t _blk_height)
 
     if (have_prev_hash)
     {
-        block prev_blk = core_storage->get_db().get_block(prev_hash);
-
-        pair<string, string> delta_diff = get_age(blk.timestamp, prev_blk.timestamp);
+        pair<string, string> delta_diff = get_age(blk.timestamp,
+                                                  get_blk_timestamp(_blk_height - 1));
 
         delta_time = delta_diff.first;
     }
 
     // get block size in bytes
-    uint64_t blk_size = core_storage->get_db().get_block_weight(_blk_height);
+    uint64_t blk_size = get_blk_weight(_blk_height);
 
     // miner reward tx
     transaction coinbase_tx = blk.miner_tx;
@@ -1115,7 +1363,7 @@ show_block(uint64_t _blk_height)
     // initalise page tempate map with basic info about blockchain
 
     string blk_pow_hash_str = pod_to_hex(get_block_longhash(core_storage, blk, _blk_height, 0));
-    cryptonote::difficulty_type blk_difficulty = core_storage->get_db().get_block_difficulty(_blk_height);
+    cryptonote::difficulty_type blk_difficulty = get_blk_difficulty(_blk_height);
 
     mstch::map context {
             {"testnet"              , testnet},
@@ -1207,13 +1455,15 @@ show_block(uint64_t _blk_height)
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["block"], context);
+    return render_page(compiled_templates.at("block"), context);
 }
 
 
 string
 show_block(string _blk_hash)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     crypto::hash blk_hash;
 
     if (!xmreg::parse_str_secret_key(_blk_hash, blk_hash))
@@ -1240,6 +1490,8 @@ show_block(string _blk_hash)
 string
 show_randomx(uint64_t _blk_height)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     if (enable_randomx == false)
     {
         return "RandomX code generation disabled! Use --enable-randomx"
@@ -1298,12 +1550,13 @@ show_randomx(uint64_t _blk_height)
     
     add_css_style(context);
 
-    return mstch::render(template_file["randomx"], context);
+    return render_page(compiled_templates.at("randomx"), context);
 }
 
 string
 show_tx(string tx_hash_str, uint16_t with_ring_signatures = 0, bool refresh_page = false)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
 
     // parse tx hash string to hash object
     crypto::hash tx_hash;
@@ -1329,20 +1582,20 @@ show_tx(string tx_hash_str, uint16_t with_ring_signatures = 0, bool refresh_page
         cerr << "Cant get tx in blockchain: " << tx_hash
              << ". \n Check mempool now" << endl;
 
-        vector<MempoolStatus::mempool_tx> found_txs;
+        vector<MempoolStatus::mempool_tx_ptr> found_txs;
 
         search_mempool(tx_hash, found_txs);
 
         if (!found_txs.empty())
         {
             // there should be only one tx found
-            tx = found_txs.at(0).tx;
+            tx = found_txs.at(0)->tx;
 
             // since its tx in mempool, it has no blk yet
             // so use its recive_time as timestamp to show
 
             uint64_t tx_recieve_timestamp
-                    = found_txs.at(0).receive_time;
+                    = found_txs.at(0)->receive_time;
 
             blk_timestamp = xmreg::timestamp_to_str_gm(tx_recieve_timestamp);
 
@@ -1382,68 +1635,185 @@ show_tx(string tx_hash_str, uint16_t with_ring_signatures = 0, bool refresh_page
 
     boost::get<mstch::array>(context["txs"]).push_back(tx_context);
 
-    map<string, string> partials {
-            {"tx_details", template_file["tx_details"]},
-    };
-
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["tx"], context, partials);
+    return render_page(compiled_templates.at("tx"), context);
 }
 
+/**
+ * ETags of content which does not change anymore, e.g., hex or
+ * raw json of a tx or a block with at least IMMUTABLE_CONFIRMATIONS.
+ * Only index lookups are done, so that a repeated request can be
+ * answered with 304 without reading the tx or block itself. Version
+ * of the explorer is part of the ETag, as it can change the content.
+ * Empty string if the content can still change or was not found.
+ */
 string
-show_tx_hex(string tx_hash_str)
+get_immutable_tx_etag(string const& tx_hash_str)
 {
-    transaction tx;
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     crypto::hash tx_hash;
+    uint64_t tx_blk_height {0};
 
-    if (!get_tx(tx_hash_str, tx, tx_hash))
-        return string {"Cant get tx: "} +  tx_hash_str;
+    if (!find_tx_block_height(tx_hash_str, tx_hash, tx_blk_height))
+        return string {};
 
-    try
-    {
-        return tx_to_hex(tx);
-    }
-    catch (std::exception const& e)
-    {
-        cerr << e.what() << endl;
-        return string {"Failed to obtain hex of tx due to: "} + e.what();
-    }
+    return make_immutable_etag(tx_hash, tx_blk_height);
 }
 
 string
-show_block_hex(size_t block_height, bool complete_blk)
+get_immutable_block_etag(uint64_t blk_height)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
 
-    // get transaction
-    block blk;
+    crypto::hash blk_hash;
 
-    if (!mcore->get_block_by_height(block_height, blk))
-    {
-        cerr << "Cant get block in blockchain: " << block_height
-             << ". \n Check mempool now\n";
-    }
+    if (!find_block_hash(blk_height, blk_hash))
+        return string {};
 
-    try
-    {
-        if (complete_blk == false)
-        {
-            // get only block data as hex
+    return make_immutable_etag(blk_hash, blk_height);
+}
 
-            return epee::string_tools::buff_to_hex_nodelimer(
-                        t_serializable_object_to_blob(blk));
-        }
-        else
-        {
-            // get block_complete_entry (block and its txs) as hex
+string
+get_immutable_block_etag(string const& blk_hash_str)
+{
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
 
-            block_complete_entry complete_block_data;
+    crypto::hash blk_hash;
+    uint64_t blk_height {0};
 
-            if (!mcore->get_block_complete_entry(blk, complete_block_data))
-            {
+    if (!find_block_height(blk_hash_str, blk_hash, blk_height))
+        return string {};
+
+    return make_immutable_etag(blk_hash, blk_height);
+}
+
+/**
+ * Weak ETags of tx and block pages, and their json, with at least
+ * IMMUTABLE_CONFIRMATIONS. Such pages change only in age and
+ * confirmations, so the ETag changes every
+ * PAGE_ETAG_CONFIRMATIONS_BUCKET blocks, and with the version
+ * of the explorer and of its templates.
+ */
+string
+get_tx_page_etag(string const& tx_hash_str)
+{
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
+    crypto::hash tx_hash;
+    uint64_t tx_blk_height {0};
+
+    if (!find_tx_block_height(tx_hash_str, tx_hash, tx_blk_height))
+        return string {};
+
+    return make_page_etag(tx_hash, tx_blk_height);
+}
+
+string
+get_block_page_etag(uint64_t blk_height)
+{
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
+    crypto::hash blk_hash;
+
+    if (!find_block_hash(blk_height, blk_hash))
+        return string {};
+
+    return make_page_etag(blk_hash, blk_height);
+}
+
+string
+get_block_page_etag(string const& blk_hash_str)
+{
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
+    crypto::hash blk_hash;
+    uint64_t blk_height {0};
+
+    if (!find_block_height(blk_hash_str, blk_hash, blk_height))
+        return string {};
+
+    return make_page_etag(blk_hash, blk_height);
+}
+
+/**
+ * Hex of the tx blob as it is stored in the blockchain,
+ * without parsing and serializing the tx again. Txs in
+ * the mempool are already parsed, so they are serialized.
+ */
+body_stream
+show_tx_hex(string tx_hash_str)
+{
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
+    crypto::hash tx_hash;
+
+    if (!hex_to_pod(tx_hash_str, tx_hash))
+        return make_text_stream("Cant get tx: " + tx_hash_str);
+
+    blobdata tx_blob;
+
+    if (mcore->get_tx_blob(tx_hash, tx_blob))
+        return make_hex_stream(std::move(tx_blob));
+
+    vector<MempoolStatus::mempool_tx_ptr> found_txs;
+
+    search_mempool(tx_hash, found_txs);
+
+    if (found_txs.empty())
+        return make_text_stream("Cant get tx: " + tx_hash_str);
+
+    try
+    {
+        return make_hex_stream(
+                t_serializable_object_to_blob(found_txs.at(0)->tx));
+    }
+    catch (std::exception const& e)
+    {
+        cerr << e.what() << endl;
+        return make_text_stream(
+                string {"Failed to obtain hex of tx due to: "} + e.what());
+    }
+}
+
+/**
+ * Hex of the block blob, or of block_complete_entry with blobs
+ * of its txs, read as blobs from the blockchain.
+ */
+body_stream
+show_block_hex(size_t block_height, bool complete_blk)
+{
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
+    try
+    {
+        if (complete_blk == false)
+        {
+            // get only block data as hex
+
+            blobdata blk_blob;
+
+            if (!mcore->get_block_blob(block_height, blk_blob))
+            {
+                return make_text_stream(
+                        fmt::format("Cant get block: {:d}", block_height));
+            }
+
+            return make_hex_stream(std::move(blk_blob));
+        }
+        else
+        {
+            // get block_complete_entry (block and its txs) as hex
+
+            block_complete_entry complete_block_data;
+
+            if (!mcore->get_block_complete_entry(block_height,
+                                                 complete_block_data))
+            {
                 cerr << "Failed to obtain complete block data " << endl;
-                return string {"Failed to obtain complete block data "};
+                return make_text_stream("Failed to obtain complete block data ");
             }
 
             std::string complete_block_data_str;
@@ -1452,23 +1822,25 @@ show_block_hex(size_t block_height, bool complete_blk)
                         complete_block_data, complete_block_data_str))
             {
                 cerr << "Failed to serialize complete_block_data\n";
-                return string {"Failed to obtain complete block data"};
+                return make_text_stream("Failed to obtain complete block data");
             }
 
-            return epee::string_tools
-                    ::buff_to_hex_nodelimer(complete_block_data_str);
+            return make_hex_stream(std::move(complete_block_data_str));
         }
     }
     catch (std::exception const& e)
     {
         cerr << e.what() << endl;
-        return string {"Failed to obtain hex of a block due to: "} + e.what();
+        return make_text_stream(
+                string {"Failed to obtain hex of a block due to: "} + e.what());
     }
 }
 
 string
 show_ringmembers_hex(string const& tx_hash_str)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     transaction tx;
     crypto::hash tx_hash;
 
@@ -1534,13 +1906,14 @@ show_ringmembers_hex(string const& tx_hash_str)
     archive << all_mixin_outputs;
 
     // return as all_mixin_outputs vector hex
-    return epee::string_tools
-            ::buff_to_hex_nodelimer(oss.str());
+    return buff_to_hex(oss.str());
 }
 
 string
 show_ringmemberstx_hex(string const& tx_hash_str)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     transaction tx;
     crypto::hash tx_hash;
 
@@ -1607,7 +1980,7 @@ show_ringmemberstx_hex(string const& tx_hash_str)
            }
 
            // serialize tx
-           string tx_hex = epee::string_tools::buff_to_hex_nodelimer(
+           string tx_hex = buff_to_hex(
                                    t_serializable_object_to_blob(mixin_tx));
 
            all_mixin_txs[map_key].push_back(
@@ -1627,8 +2000,7 @@ show_ringmemberstx_hex(string const& tx_hash_str)
     archive << all_mixin_txs;
 
     // return as all_mixin_outputs vector hex
-    return epee::string_tools
-            ::buff_to_hex_nodelimer(oss.str());
+    return buff_to_hex(oss.str());
 }
 
 /**
@@ -1644,6 +2016,8 @@ show_ringmemberstx_hex(string const& tx_hash_str)
 json
 show_ringmemberstx_jsonhex(string const& tx_hash_str)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     transaction tx;
     crypto::hash tx_hash;
 
@@ -1758,8 +2132,7 @@ show_ringmemberstx_jsonhex(string const& tx_hash_str)
     tx_json["payment_id8"] = pod_to_hex(txd.payment_id8);
     tx_json["payment_id8e"] = pod_to_hex(txd.payment_id8);
 
-    tx_json["block"] = epee::string_tools
-             ::buff_to_hex_nodelimer(complete_block_data_str);
+    tx_json["block"] = buff_to_hex(complete_block_data_str);
 
     tx_json["block_version"] = json {blk.major_version, blk.minor_version};
 
@@ -1850,7 +2223,7 @@ show_ringmemberstx_jsonhex(string const& tx_hash_str)
            }
 
            // serialize tx
-           string tx_hex = epee::string_tools::buff_to_hex_nodelimer(
+           string tx_hex = buff_to_hex(
                                    t_serializable_object_to_blob(mixin_tx));
 
            ring_members.push_back(
@@ -1886,6 +2259,7 @@ show_my_outputs(string tx_hash_str,
                 string domain,
                 bool tx_prove = false)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
 
     // remove white characters
     boost::trim(tx_hash_str);
@@ -1979,7 +2353,7 @@ show_my_outputs(string tx_hash_str,
 
         cryptonote::blobdata tx_data_blob;
 
-        if (!epee::string_tools::parse_hexstr_to_binbuff(raw_tx_data, tx_data_blob))
+        if (!hex_to_buff(raw_tx_data, tx_data_blob))
         {
             string msg = fmt::format("Cant obtain tx_data_blob from raw_tx_data");
 
@@ -2009,20 +2383,20 @@ show_my_outputs(string tx_hash_str,
         cerr << "Cant get tx in blockchain: " << tx_hash
              << ". \n Check mempool now" << endl;
 
-        vector<MempoolStatus::mempool_tx> found_txs;
+        vector<MempoolStatus::mempool_tx_ptr> found_txs;
 
         search_mempool(tx_hash, found_txs);
 
         if (!found_txs.empty())
         {
             // there should be only one tx found
-            tx = found_txs.at(0).tx;
+            tx = found_txs.at(0)->tx;
 
             // since its tx in mempool, it has no blk yet
             // so use its recive_time as timestamp to show
 
             uint64_t tx_recieve_timestamp
-                    = found_txs.at(0).receive_time;
+                    = found_txs.at(0)->receive_time;
 
             blk_timestamp = xmreg::timestamp_to_str_gm(tx_recieve_timestamp);
 
@@ -2295,33 +2669,54 @@ show_my_outputs(string tx_hash_str,
     //                     public_key    , amount
     std::vector<std::pair<crypto::public_key, uint64_t>> all_possible_mixins;
 
+    // ring of an input, with the txs of its members
+    struct input_ring
+    {
+        txin_to_key const* in_key;
+
+        std::vector<uint64_t> absolute_offsets;
+
+        // public keys of outputs used in the ring
+        std::vector<cryptonote::output_data_t> mixin_outputs;
+
+        // index in mixin_txs of tx of each ring member. if tx of
+        // some member is not found, the following ones are skipped
+        std::vector<size_t> mixin_tx_indices;
+    };
+
+    std::vector<input_ring> rings;
+
+    // txs used in the rings. The same tx is often used in many
+    // rings, so each one is read and scanned only once
+    std::vector<mixin_tx_scan> mixin_txs;
+
+    UniqueKeys<crypto::hash> mixin_tx_hashes;
+
     for (const txin_to_key& in_key: input_key_imgs)
     {
+        input_ring ring;
+
+        ring.in_key = &in_key;
+
         // get absolute offsets of mixins
-        std::vector<uint64_t> absolute_offsets
+        ring.absolute_offsets
                 = cryptonote::relative_output_offsets_to_absolute(
                         in_key.key_offsets);
 
-        // get public keys of outputs used in the mixins that match to the offests
-        std::vector<cryptonote::output_data_t> mixin_outputs;
-
-
         try
         {
             // before proceeding with geting the outputs based on
             // the amount and absolute offset
             // check how many outputs there are for that amount
             // go to next input if a too large offset was found
-            if (are_absolute_offsets_good(absolute_offsets, in_key) == false)
+            if (are_absolute_offsets_good(ring.absolute_offsets, in_key) == false)
                 continue;
 
-            //core_storage->get_db().get_output_key(in_key.amount,
-                                                  //absolute_offsets,
-                                                  //mixin_outputs);
-            
+            // get public keys of outputs used in the mixins
+            // that match to the offests
             get_output_key<BlockchainDB>(in_key.amount,
-                                           absolute_offsets,
-                                           mixin_outputs);
+                                         ring.absolute_offsets,
+                                         ring.mixin_outputs);
         }
         catch (const OUTPUT_DNE& e)
         {
@@ -2329,6 +2724,55 @@ show_my_outputs(string tx_hash_str,
             continue;
         }
 
+        for (const uint64_t& abs_offset: ring.absolute_offsets)
+        {
+            tx_out_index tx_out_idx;
+
+            try
+            {
+                // get pair pair<crypto::hash, uint64_t> where first is tx hash
+                // and second is local index of the output i in that tx
+                tx_out_idx = core_storage->get_db()
+                        .get_output_tx_and_index(in_key.amount, abs_offset);
+            }
+            catch (const OUTPUT_DNE& e)
+            {
+
+                string out_msg = fmt::format(
+                        "Output with amount {:d} and index {:d} does not exist!",
+                        in_key.amount, abs_offset);
+
+                cerr << out_msg << '\n';
+
+                break;
+            }
+
+            auto added = mixin_tx_hashes.add(tx_out_idx.first);
+
+            if (added.second)
+            {
+                mixin_txs.emplace_back();
+                mixin_txs.back().tx_hash = tx_out_idx.first;
+            }
+
+            ring.mixin_tx_indices.push_back(added.first);
+        }
+
+        rings.push_back(std::move(ring));
+    }
+
+    // read mixin txs and check which of their outputs are ours
+    executor->parallel_for(mixin_txs.size(), RING_SCAN_MAX_THREADS,
+            [&](size_t i)
+    {
+        scan_mixin_tx(mixin_txs[i], prv_view_key,
+                      address_info.address.m_spend_public_key);
+    });
+
+    for (const input_ring& ring: rings)
+    {
+        const txin_to_key& in_key = *ring.in_key;
+
         inputs.push_back(mstch::map{
                 {"key_image"       , pod_to_hex(in_key.k_image)},
                 {"key_image_amount", xmreg::xmr_amount_to_str(in_key.amount)},
@@ -2339,12 +2783,6 @@ show_my_outputs(string tx_hash_str,
                 boost::get<mstch::map>(inputs.back())["mixins"]
         );
 
-        // to store our mixins found for the given key image
-        vector<map<string, string>> our_mixins_found;
-
-        // mixin counter
-        size_t count = 0;
-
         // there can be more than one our output used for mixin in a single
         // input. For example, if two outputs are matched (marked by *) in html,
         // one of them will be our real spending, and second will be used as a fake
@@ -2361,55 +2799,32 @@ show_my_outputs(string tx_hash_str,
         size_t no_of_output_matches_found {0};
 
         // for each found output public key check if its ours or not
-        for (const uint64_t& abs_offset: absolute_offsets)
+        for (size_t count = 0; count < ring.mixin_tx_indices.size(); ++count)
         {
-
             // get basic information about mixn's output
-            cryptonote::output_data_t output_data = mixin_outputs.at(count);
-
-            tx_out_index tx_out_idx;
-
-            try
-            {
-                // get pair pair<crypto::hash, uint64_t> where first is tx hash
-                // and second is local index of the output i in that tx
-                tx_out_idx = core_storage->get_db()
-                        .get_output_tx_and_index(in_key.amount, abs_offset);
-            }
-            catch (const OUTPUT_DNE& e)
-            {
-
-                string out_msg = fmt::format(
-                        "Output with amount {:d} and index {:d} does not exist!",
-                        in_key.amount, abs_offset);
-
-                cerr << out_msg << '\n';
+            const cryptonote::output_data_t& output_data
+                    = ring.mixin_outputs.at(count);
 
-                break;
-            }
+            const mixin_tx_scan& mixin_tx
+                    = mixin_txs[ring.mixin_tx_indices[count]];
 
             string out_pub_key_str = pod_to_hex(output_data.pubkey);
 
-            //cout << "out_pub_key_str: " << out_pub_key_str << endl;
-
-
-            // get mixin transaction
-            transaction mixin_tx;
-
-            if (!mcore->get_tx(tx_out_idx.first, mixin_tx))
+            if (!mixin_tx.found)
             {
-                cerr << "Cant get tx: " << tx_out_idx.first << endl;
+                cerr << "Cant get tx: " << mixin_tx.tx_hash << endl;
                 break;
             }
 
-            string mixin_tx_hash_str = pod_to_hex(tx_out_idx.first);
-
             mixins.push_back(mstch::map{
                     {"mixin_pub_key"      , out_pub_key_str},
                     make_pair<string, mstch::array>("mixin_outputs"
                                                     , mstch::array{}),
                     {"has_mixin_outputs"  , false}});
 
+            if (!mixin_tx.derived)
+                continue;
+
             mstch::array& mixin_outputs = boost::get<mstch::array>(
                     boost::get<mstch::map>(mixins.back())["mixin_outputs"]);
 
@@ -2418,52 +2833,9 @@ show_my_outputs(string tx_hash_str,
 
             bool found_something {false};
 
-            public_key mixin_tx_pub_key
-                    = xmreg::get_tx_pub_key_from_received_outs(mixin_tx);
-
-            std::vector<public_key> mixin_additional_tx_pub_keys
-                    = cryptonote::get_additional_tx_pub_keys_from_extra(mixin_tx);
-
-            string mixin_tx_pub_key_str = pod_to_hex(mixin_tx_pub_key);
-
-            // public transaction key is combined with our viewkey
-            // to create, so called, derived key.
-            key_derivation derivation;
-
-            std::vector<key_derivation> additional_derivations(
-                        mixin_additional_tx_pub_keys.size());
-
-            if (!generate_key_derivation(mixin_tx_pub_key,
-                                         prv_view_key, derivation))
-            {
-                cerr << "Cant get derived key for: "  << "\n"
-                     << "pub_tx_key: " << mixin_tx_pub_key << " and "
-                     << "prv_view_key" << prv_view_key << endl;
-
-                continue;
-            }
-            for (size_t i = 0; i < mixin_additional_tx_pub_keys.size(); ++i)
-            {
-                if (!generate_key_derivation(mixin_additional_tx_pub_keys[i],
-                                             prv_view_key,
-                                             additional_derivations[i]))
-                {
-                    cerr << "Cant get derived key for: "  << "\n"
-                         << "pub_tx_key: " << mixin_additional_tx_pub_keys[i]
-                         << " and prv_view_key" << prv_view_key << endl;
-
-                    continue;
-                }
-            }
-
-            //          <public_key  , amount  , out idx>
-            vector<tuple<txout_to_key, uint64_t, uint64_t>> output_pub_keys;
-
-            output_pub_keys = xmreg::get_ouputs_tuple(mixin_tx);
-
             mixin_outputs.push_back(mstch::map{
-                    {"mix_tx_hash"      , mixin_tx_hash_str},
-                    {"mix_tx_pub_key"   , mixin_tx_pub_key_str},
+                    {"mix_tx_hash"      , pod_to_hex(mixin_tx.tx_hash)},
+                    {"mix_tx_pub_key"   , pod_to_hex(mixin_tx.tx_pub_key)},
                     make_pair<string, mstch::array>("found_outputs"
                                                     , mstch::array{}),
                     {"has_found_outputs", false}
@@ -2482,81 +2854,14 @@ show_my_outputs(string tx_hash_str,
 
             // for each output in mixin tx, find the one from key_image
             // and check if its ours.
-            for (const auto& mix_out: output_pub_keys)
+            for (const mixin_tx_scan::output& mix_out: mixin_tx.outputs)
             {
+                bool mine_output = mix_out.mine;
 
-                txout_to_key const& txout_k      = std::get<0>(mix_out);
-                uint64_t amount           = std::get<1>(mix_out);
-                uint64_t output_idx_in_tx = std::get<2>(mix_out);             
-
-                //cout << " - " << pod_to_hex(txout_k.key) << endl;
-
-//                        // analyze only those output keys
-//                        // that were used in mixins
-//                        if (txout_k.key != output_data.pubkey)
-//                        {
-//                            continue;
-//                        }
-
-                // get the tx output public key
-                // that normally would be generated for us,
-                // if someone had sent us some xmr.
-                public_key tx_pubkey_generated;
-
-                derive_public_key(derivation,
-                                  output_idx_in_tx,
-                                  address_info.address.m_spend_public_key,
-                                  tx_pubkey_generated);
-
-                // check if generated public key matches the current output's key
-                bool mine_output = (txout_k.key == tx_pubkey_generated);
-
-                bool with_additional = false;
-
-                if (!mine_output && mixin_additional_tx_pub_keys.size()
-                        == output_pub_keys.size())
-                {
-                    derive_public_key(additional_derivations[output_idx_in_tx],
-                                      output_idx_in_tx,
-                                      address_info.address.m_spend_public_key,
-                                      tx_pubkey_generated);
-
-                    mine_output = (txout_k.key == tx_pubkey_generated);
-
-                    with_additional = true;
-                }
-
-
-                if (mine_output && mixin_tx.version == 2)
-                {
-                    // cointbase txs have amounts in plain sight.
-                    // so use amount from ringct, only for non-coinbase txs
-                    if (!is_coinbase(mixin_tx))
-                    {
-                        // initialize with regular amount
-                        uint64_t rct_amount = amount;
-
-                        bool r;
-
-                        r = decode_ringct(
-                                    mixin_tx.rct_signatures,
-                                    with_additional
-                                    ? additional_derivations[output_idx_in_tx] : derivation,
-                                    output_idx_in_tx,
-                                    mixin_tx.rct_signatures.ecdhInfo[output_idx_in_tx].mask,
-                                    rct_amount);
-
-                        if (!r)
-                            cerr << "show_my_outputs: key images: "
-                                    "Cant decode RingCT!\n";
-
-                        amount = rct_amount;
-
-                    } // if (mine_output && mixin_tx.version == 2)
-                }
+                uint64_t amount  = mix_out.amount;
 
                 // makre only
-                bool output_match = (txout_k.key == output_data.pubkey);
+                bool output_match = (mix_out.pub_key == output_data.pubkey);
 
                 // mark only first output_match as the "real" one
                 // due to luck of better method of gussing which output
@@ -2565,27 +2870,25 @@ show_my_outputs(string tx_hash_str,
 
                 // save our mixnin's public keys
                 found_outputs.push_back(mstch::map {
-                        {"my_public_key"   , pod_to_hex(txout_k.key)},
+                        {"my_public_key"   , pod_to_hex(mix_out.pub_key)},
                         {"tx_hash"         , tx_hash_str},
                         {"mine_output"     , mine_output},
-                        {"out_idx"         , output_idx_in_tx},
+                        {"out_idx"         , mix_out.out_idx},
                         {"formed_output_pk", out_pub_key_str},
                         {"out_in_match"    , output_match},
                         {"amount"          , xmreg::xmr_amount_to_str(amount)}
                 });
 
-                //cout << "txout_k.key == output_data.pubkey" << endl;
-
                 if (mine_output)
                 {
                     found_something = true;
-                    show_key_images = true;                   
+                    show_key_images = true;
 
                     // increase sum_mixin_xmr only when
                     // public key of an outputs used in ring signature,
                     // matches a public key in a mixin_tx
-                    if (txout_k.key != output_data.pubkey)
-                        continue;              
+                    if (mix_out.pub_key != output_data.pubkey)
+                        continue;
 
                     // sum up only first output matched found in each input
                     if (no_of_output_matches_found == 0)
@@ -2609,48 +2912,24 @@ show_my_outputs(string tx_hash_str,
                         no_of_matched_mixins++;
                     }
 
-
-                    // generate key_image using this output
-                    // just to see how would having spend keys worked
-//                        crypto::key_image key_img;
-//
-//                        if (!xmreg::generate_key_image(derivation,
-//                                                       output_idx_in_tx, /* position in the tx */
-//                                                       prv_spend_key,
-//                                                       address.m_spend_public_key,
-//                                                       key_img)) {
-//                            cerr << "Cant generate key image for output: "
-//                                 << pod_to_hex(output_data.pubkey) << endl;
-//                            break;
-//                        }
-//
-//                        cout    << "output_data.pubkey: " << pod_to_hex(output_data.pubkey)
-//                                << ", key_img: " << pod_to_hex(key_img)
-//                                << ", key_img == input_key: " << (key_img == in_key.k_image)
-//                                << endl;
-
                     no_of_output_matches_found++;
 
                 } // if (mine_output)
 
-            } // for (const pair<txout_to_key, uint64_t>& mix_out: txd.output_pub_keys)
+            } // for (const mixin_tx_scan::output& mix_out: mixin_tx.outputs)
 
             has_found_outputs = !found_outputs.empty();
 
             has_mixin_outputs = found_something;
 
-            //   all_possible_mixins_amount += amount;
-
             if (found_something)
                 all_possible_mixins.push_back(
-                    {mixin_tx_pub_key,
+                    {mixin_tx.tx_pub_key,
                      in_key.amount == 0 ? ringct_amount : in_key.amount});
 
-            ++count;
-
-        } // for (const cryptonote::output_data_t& output_data: mixin_outputs)
+        } // for (size_t count = 0; count < ring.mixin_tx_indices.size(); ++count)
 
-    } //  for (const txin_to_key& in_key: input_key_imgs)
+    } //  for (const input_ring& ring: rings)
 
 
     context.emplace("outputs", outputs);
@@ -2701,7 +2980,7 @@ show_my_outputs(string tx_hash_str,
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["my_outputs"], context);
+    return render_page(compiled_templates.at("my_outputs"), context);
 }
 
 string
@@ -2730,12 +3009,14 @@ show_rawtx()
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["rawtx"], context);
+    return render_page(compiled_templates.at("rawtx"), context);
 }
 
 string
 show_checkrawtx(string raw_tx_data, string action)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     clean_post_data(raw_tx_data);
 
     string decoded_raw_tx_data = epee::string_encoding::base64_decode(raw_tx_data);
@@ -2766,7 +3047,8 @@ show_checkrawtx(string raw_tx_data, string action)
 
     context.emplace("txs", mstch::array{});
 
-    string full_page = template_file["checkrawtx"];
+    const mstch::compiled_template& full_page
+            = compiled_templates.at("checkrawtx");
 
     add_css_style(context);
 
@@ -2855,7 +3137,6 @@ show_checkrawtx(string raw_tx_data, string action)
                             {"real_out_tx_key"            , pod_to_hex(tx_source.real_out_tx_key)},
                             {"real_output_in_tx_index"    , static_cast<uint64_t>(tx_source.real_output_in_tx_index)},
                     };
-                    single_dest_source.emplace("outputs", mstch::array{});
 
                     sum_outputs_amounts += tx_source.amount;
 
@@ -2909,7 +3190,10 @@ show_checkrawtx(string raw_tx_data, string action)
                     //cout << "real_txd.pk: "      << pod_to_hex(real_txd.pk) << endl;
                     //cout << "real_out_pub_key: " << pod_to_hex(real_out_pub_key) << endl;
 
-                    mstch::array& outputs = boost::get<mstch::array>(single_dest_source["outputs"]);
+                    // filled in first and added to single_dest_source after the
+                    // loop, as the loop inserts into single_dest_source, which
+                    // would invalidate reference to array kept inside it
+                    mstch::array outputs;
 
                     vector<uint64_t> mixin_timestamps;
 
@@ -2955,16 +3239,10 @@ show_checkrawtx(string raw_tx_data, string action)
                         public_key out_pub_key = txd.output_pub_keys[toi.second].first.key;
 
 
-                        // get block cointaining this tx
-                        block blk;
-
-                        if (!mcore->get_block_by_height(txd.blk_height, blk))
-                        {
-                            cerr << "Cant get block: " << txd.blk_height << endl;
-                            return string("Cant get block: "  + to_string(txd.blk_height));
-                        }
+                        // get timestamp of block cointaining this tx
+                        uint64_t blk_timestamp = get_blk_timestamp(txd.blk_height);
 
-                        pair<string, string> age = get_age(server_timestamp, blk.timestamp);
+                        pair<string, string> age = get_age(server_timestamp, blk_timestamp);
 
                         mstch::map single_output {
                                 {"out_index"          , oe.first},
@@ -2979,12 +3257,14 @@ show_checkrawtx(string raw_tx_data, string action)
 
                         outputs.push_back(single_output);
 
-                        mixin_timestamps.push_back(blk.timestamp);
+                        mixin_timestamps.push_back(blk_timestamp);
 
                         ++output_i;
 
                     } // for(const tx_source_entry::output_entry& oe: tx_source.outputs)
 
+                    single_dest_source.emplace("outputs", std::move(outputs));
+
                     dest_sources.push_back(single_dest_source);
 
                     mixin_timestamp_groups.push_back(mixin_timestamps);
@@ -3051,7 +3331,7 @@ show_checkrawtx(string raw_tx_data, string action)
 
             cryptonote::blobdata tx_data_blob;
 
-            if (!epee::string_tools::parse_hexstr_to_binbuff(raw_tx_data, tx_data_blob))
+            if (!hex_to_buff(raw_tx_data, tx_data_blob))
             {
                 string msg = fmt::format("The data is neither unsigned, signed tx or raw tx! "
                                                  "Its prefix is: {:s}",
@@ -3081,7 +3361,7 @@ show_checkrawtx(string raw_tx_data, string action)
                 context["has_error"] = true;
                 context["error_msg"] = error_msg;
 
-                return mstch::render(full_page, context);
+                return render_page(full_page, context);
             }
 
             //cout << "tx_from_blob.vout.size(): " << tx_from_blob.vout.size() << endl;
@@ -3104,21 +3384,21 @@ show_checkrawtx(string raw_tx_data, string action)
             tx_context["show_more_details_link"] = false;
 
             context["data_prefix"] = string("none as this is pure raw tx data");
-            context["tx_json"]     = obj_to_json_str(tx_from_blob);
+            string tx_json;
+
+            write_tx_json(tx_from_blob, tx_json, true);
+
+            context["tx_json"]     = tx_json;
 
             context.emplace("txs"     , mstch::array{});
 
             boost::get<mstch::array>(context["txs"]).push_back(tx_context);
 
-            map<string, string> partials {
-                    {"tx_details", template_file["tx_details"]},
-            };
-
             add_css_style(context);
 
 
             // render the page
-            return mstch::render(template_file["checkrawtx"], context, partials);
+            return render_page(compiled_templates.at("checkrawtx"), context);
 
         } // if (strncmp(decoded_raw_tx_data.c_str(), SIGNED_TX_PREFIX, magiclen) != 0)
 
@@ -3324,7 +3604,7 @@ show_checkrawtx(string raw_tx_data, string action)
 
                 key_image key_imgage;
 
-                if (epee::string_tools::hex_to_pod(in_key_img_str, key_imgage))
+                if (hex_to_pod(in_key_img_str, key_imgage))
                 {
                     input_map["already_spent"] = core_storage->get_db().has_key_image(key_imgage);
                 }
@@ -3363,13 +3643,8 @@ show_checkrawtx(string raw_tx_data, string action)
 
     }
 
-
-    map<string, string> partials {
-            {"tx_details", template_file["tx_details"]},
-    };
-
     // render the page
-    return mstch::render(full_page, context, partials);
+    return render_page(full_page, context);
 }
 
 string
@@ -3387,7 +3662,8 @@ show_pushrawtx(string raw_tx_data, string action)
     };
 
     // add header and footer
-    string full_page = template_file["pushrawtx"];
+    const mstch::compiled_template& full_page
+            = compiled_templates.at("pushrawtx");
 
     add_css_style(context);
 
@@ -3397,7 +3673,7 @@ show_pushrawtx(string raw_tx_data, string action)
     std::string tx_blob;
     cryptonote::transaction parsed_tx;
     crypto::hash parsed_tx_hash, parsed_tx_prefixt_hash;
-    if (epee::string_tools::parse_hexstr_to_binbuff(raw_tx_data, tx_blob) && parse_and_validate_tx_from_blob(tx_blob, parsed_tx, parsed_tx_hash, parsed_tx_prefixt_hash))
+    if (hex_to_buff(raw_tx_data, tx_blob) && parse_and_validate_tx_from_blob(tx_blob, parsed_tx, parsed_tx_hash, parsed_tx_prefixt_hash))
     {
         ptx_vector.push_back({});
         ptx_vector.back().tx = parsed_tx;
@@ -3421,7 +3697,7 @@ show_pushrawtx(string raw_tx_data, string action)
             context["has_error"] = true;
             context["error_msg"] = error_msg;
 
-            return mstch::render(full_page, context);
+            return render_page(full_page, context);
         }
 
         if (this->enable_pusher == false)
@@ -3433,7 +3709,7 @@ show_pushrawtx(string raw_tx_data, string action)
             context["has_error"] = true;
             context["error_msg"] = error_msg;
 
-            return mstch::render(full_page, context);
+            return render_page(full_page, context);
         }
 
         bool r {false};
@@ -3464,7 +3740,7 @@ show_pushrawtx(string raw_tx_data, string action)
             context["has_error"] = true;
             context["error_msg"] = error_msg;
 
-            return mstch::render(full_page, context);
+            return render_page(full_page, context);
         }
 
         ptx_vector = signed_txs.ptx;
@@ -3488,7 +3764,7 @@ show_pushrawtx(string raw_tx_data, string action)
         };
 
         // check in mempool already contains tx to be submited
-        vector<MempoolStatus::mempool_tx> found_mempool_txs;
+        vector<MempoolStatus::mempool_tx_ptr> found_mempool_txs;
 
         search_mempool(txd.hash, found_mempool_txs);
 
@@ -3555,7 +3831,14 @@ show_pushrawtx(string raw_tx_data, string action)
             break;
         }
 
-        if (!rpc.commit_tx(ptx, rpc_error_msg))
+        // ptx is copied, as the call can outlive this loop
+        std::function<bool(string&)> commit_tx_call
+                = [this, ptx](string& error_msg) mutable
+        {
+            return rpc->commit_tx(ptx, error_msg);
+        };
+
+        if (!call_rpc(commit_tx_call, rpc_error_msg))
         {
             string error_msg = fmt::format(
                     "Submitting signed tx {:s} to daemon failed: {:s}\n",
@@ -3574,7 +3857,7 @@ show_pushrawtx(string raw_tx_data, string action)
     }
 
     // render the page
-    return mstch::render(full_page, context);
+    return render_page(full_page, context);
 }
 
 
@@ -3590,7 +3873,7 @@ show_rawkeyimgs()
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["rawkeyimgs"], context);
+    return render_page(compiled_templates.at("rawkeyimgs"), context);
 }
 
 string
@@ -3605,12 +3888,13 @@ show_rawoutputkeys()
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["rawoutputkeys"], context);
+    return render_page(compiled_templates.at("rawoutputkeys"), context);
 }
 
 string
 show_checkrawkeyimgs(string raw_data, string viewkey_str)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
 
     clean_post_data(raw_data);
 
@@ -3629,7 +3913,8 @@ show_checkrawkeyimgs(string raw_data, string viewkey_str)
     };
 
     // add header and footer
-    string full_page = template_file["checkrawkeyimgs"];
+    const mstch::compiled_template& full_page
+            = compiled_templates.at("checkrawkeyimgs");
 
     add_css_style(context);
 
@@ -3641,7 +3926,7 @@ show_checkrawkeyimgs(string raw_data, string viewkey_str)
         context["has_error"] = true;
         context["error_msg"] = error_msg;
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
     if (!xmreg::parse_str_secret_key(viewkey_str, prv_view_key))
@@ -3651,7 +3936,7 @@ show_checkrawkeyimgs(string raw_data, string viewkey_str)
         context["has_error"] = true;
         context["error_msg"] = error_msg;
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
     const size_t magiclen = strlen(KEY_IMAGE_EXPORT_FILE_MAGIC);
@@ -3660,104 +3945,68 @@ show_checkrawkeyimgs(string raw_data, string viewkey_str)
 
     context["data_prefix"] = data_prefix;
 
-    if (strncmp(decoded_raw_data.c_str(), KEY_IMAGE_EXPORT_FILE_MAGIC, magiclen) != 0)
-    {
-        string error_msg = fmt::format("This does not seem to be key image export data.");
+    address_parse_info address_info;
 
+    vector<crypto::key_image> key_images;
+    vector<crypto::signature> signatures;
+
+    string error_msg;
+
+    if (!decrypt_raw_key_images(decoded_raw_data, prv_view_key,
+                                address_info, key_images, signatures,
+                                error_msg))
+    {
         context["has_error"] = true;
         context["error_msg"] = error_msg;
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
-    // decrypt key images data using private view key
-    decoded_raw_data = xmreg::decrypt(
-            std::string(decoded_raw_data, magiclen),
-            prv_view_key, true);
+    vector<bool> spent;
 
-    if (decoded_raw_data.empty())
+    if (!are_key_images_spent(key_images, spent))
     {
-        string error_msg = fmt::format("Failed to authenticate key images data. "
-                                               "Maybe wrong viewkey was porvided?");
-
         context["has_error"] = true;
-        context["error_msg"] = error_msg;
+        context["error_msg"] = string {"Cant check if key images are spent"};
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
-    // header is public spend and keys
-    const size_t header_lenght = 2 * sizeof(crypto::public_key);
-    const size_t key_img_size  = sizeof(crypto::key_image);
-    const size_t record_lenght = key_img_size + sizeof(crypto::signature);
-    const size_t chacha_length = sizeof(crypto::chacha_key);
-
-    if (decoded_raw_data.size() < header_lenght)
-    {
-        string error_msg = fmt::format("Bad data size from submitted key images raw data.");
-
-        context["has_error"] = true;
-        context["error_msg"] = error_msg;
-
-        return mstch::render(full_page, context);
-
-    }
-
-    // get xmr address stored in this key image file
-    const account_public_address* xmr_address =
-            reinterpret_cast<const account_public_address*>(
-                    decoded_raw_data.data());
-
-    address_parse_info address_info {*xmr_address, false};
+    string address_str = xmreg::print_address(address_info, nettype);
 
-
-    context.insert({"address"        , REMOVE_HASH_BRAKETS(
-            xmreg::print_address(address_info, nettype))});
+    context.insert({"address"        , REMOVE_HASH_BRAKETS(address_str)});
     context.insert({"viewkey"        , REMOVE_HASH_BRAKETS(
             fmt::format("{:s}", prv_view_key))});
     context.insert({"has_total_xmr"  , false});
     context.insert({"total_xmr"      , string{}});
     context.insert({"key_imgs"       , mstch::array{}});
 
-
-    size_t no_key_images = (decoded_raw_data.size() - header_lenght) / record_lenght;
-
-    //vector<pair<crypto::key_image, crypto::signature>> signed_key_images;
-
     mstch::array& key_imgs_ctx = boost::get<mstch::array>(context["key_imgs"]);
 
-    for (size_t n = 0; n < no_key_images; ++n)
-    {
-        const char* record_ptr = decoded_raw_data.data() + header_lenght + n * record_lenght;
-
-        crypto::key_image key_image
-                = *reinterpret_cast<const crypto::key_image*>(record_ptr);
-
-        crypto::signature signature
-                = *reinterpret_cast<const crypto::signature*>(record_ptr + key_img_size);
+    key_imgs_ctx.reserve(key_images.size());
 
-        mstch::map key_img_info {
+    for (size_t n = 0; n < key_images.size(); ++n)
+    {
+        key_imgs_ctx.push_back(mstch::map {
                 {"key_no"              , fmt::format("{:03d}", n)},
-                {"key_image"           , pod_to_hex(key_image)},
-                {"signature"           , fmt::format("{:s}", signature)},
-                {"address"             , xmreg::print_address(
-                                            address_info, nettype)},
-                {"is_spent"            , core_storage->have_tx_keyimg_as_spent(key_image)},
+                {"key_image"           , pod_to_hex(key_images[n])},
+                {"signature"           , fmt::format("{:s}", signatures[n])},
+                {"address"             , address_str},
+                {"is_spent"            , static_cast<bool>(spent[n])},
                 {"tx_hash"             , string{}}
-        };
-
-
-        key_imgs_ctx.push_back(key_img_info);
+        });
 
-    } // for (size_t n = 0; n < no_key_images; ++n)
+    } // for (size_t n = 0; n < key_images.size(); ++n)
 
     // render the page
-    return mstch::render(full_page, context);
+    return render_page(full_page, context);
 }
 
 string
 show_checkcheckrawoutput(string raw_data, string viewkey_str)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     clean_post_data(raw_data);
 
     // remove white characters
@@ -3775,7 +4024,8 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
     };
 
     // add header and footer
-    string full_page = template_file["checkoutputkeys"];
+    const mstch::compiled_template& full_page
+            = compiled_templates.at("checkoutputkeys");
 
     add_css_style(context);
 
@@ -3787,7 +4037,7 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
         context["has_error"] = true;
         context["error_msg"] = error_msg;
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
     if (!xmreg::parse_str_secret_key(viewkey_str, prv_view_key))
@@ -3797,7 +4047,7 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
         context["has_error"] = true;
         context["error_msg"] = error_msg;
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
     const size_t magiclen = strlen(OUTPUT_EXPORT_FILE_MAGIC);
@@ -3813,7 +4063,7 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
         context["has_error"] = true;
         context["error_msg"] = error_msg;
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
 
@@ -3831,7 +4081,7 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
         context["has_error"] = true;
         context["error_msg"] = error_msg;
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
 
@@ -3851,6 +4101,7 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
     context.insert({"has_total_xmr"  , false});
     context.insert({"total_xmr"      , string{}});
     context.insert({"output_keys"    , mstch::array{}});
+    context.insert({"are_key_images_known", false});
 
     mstch::array& output_keys_ctx = boost::get<mstch::array>(context["output_keys"]);
 
@@ -3876,14 +4127,12 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
         context["has_error"] = true;
         context["error_msg"] = error_msg;
 
-        return mstch::render(full_page, context);
+        return render_page(full_page, context);
     }
 
     uint64_t total_xmr {0};
     uint64_t output_no {0};
 
-    context["are_key_images_known"] = false;
-
     for (const tools::wallet2::transfer_details& td: outputs)
     {
 
@@ -3908,7 +4157,7 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
                 context["has_error"] = true;
                 context["error_msg"] = error_msg;
 
-                return mstch::render(full_page, context);
+                return render_page(full_page, context);
             }
 
             public_key tx_pub_key = xmreg::get_tx_pub_key_from_received_outs(tx);
@@ -3941,15 +4190,14 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
                     context["has_error"] = true;
                     context["error_msg"] = error_msg;
 
-                    return mstch::render(full_page, context);
+                    return render_page(full_page, context);
                 }
 
             } //  if (!is_coinbase(tx))
 
         } // if (td.is_rct())
 
-        uint64_t blk_timestamp = core_storage
-                ->get_db().get_block_timestamp(td.m_block_height);
+        uint64_t blk_timestamp = get_blk_timestamp(td.m_block_height);
 
         const key_image* output_key_img;
 
@@ -3992,113 +4240,47 @@ show_checkcheckrawoutput(string raw_data, string viewkey_str)
         context["total_xmr"] = xmreg::xmr_amount_to_str(total_xmr);
     }
 
-    return mstch::render(full_page, context);;
+    return render_page(full_page, context);;
 }
 
 
 string
 search(string search_text)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     // remove white characters
     boost::trim(search_text);
 
-    string default_txt {"No such thing found: " + search_text};
-
-    string result_html {default_txt};
-
-    uint64_t search_str_length = search_text.length();
-
-    // first let try searching for tx
-    result_html = show_tx(search_text);
-
-    // nasty check if output is "Cant get" as a sign of
-    // a not found tx. Later need to think of something better.
-    if (result_html.find("Cant get") == string::npos)
-    {
-        return result_html;
-    }
-
-
-    // first check if searching for block of given height
-    if (search_text.size() < 12)
-    {
-        uint64_t blk_height;
-
-        try
-        {
-            blk_height = boost::lexical_cast<uint64_t>(search_text);
-
-            result_html = show_block(blk_height);
-
-            // nasty check if output is "Cant get" as a sign of
-            // a not found tx. Later need to think of something better.
-            if (result_html.find("Cant get") == string::npos)
-            {
-                return result_html;
-            }
-        }
-        catch(boost::bad_lexical_cast &e)
-        {
-            cerr << fmt::format("Parsing {:s} into uint64_t failed", search_text)
-                 << endl;
-        }
-    }
-
-    // if tx search not successful, check if we are looking
-    // for a block with given hash
-    result_html = show_block(search_text);
-
-    if (result_html.find("Cant get") == string::npos)
-    {
-        return result_html;
-    }
-
-    result_html = default_txt;
+    search_target target = classify_search(search_text);
 
-
-    // check if monero address is given based on its length
-    // if yes, then we can only show its public components
-    if (search_str_length == 95)
+    switch (target.what)
     {
-        // parse string representing given monero address
-        address_parse_info address_info;
-
-        cryptonote::network_type nettype_addr {cryptonote::network_type::MAINNET};
-
-        if (search_text[0] == '9' || search_text[0] == 'A' || search_text[0] == 'B')
-            nettype_addr = cryptonote::network_type::TESTNET;
-        if (search_text[0] == '5' || search_text[0] == '7')
-            nettype_addr = cryptonote::network_type::STAGENET;
-
-        if (!xmreg::parse_str_address(search_text, address_info, nettype_addr))
-        {
-            cerr << "Cant parse string address: " << search_text << endl;
-            return string("Cant parse address (probably incorrect format): ")
-                   + search_text;
-        }
+        case search_target::kind::tx:
+        case search_target::kind::mempool_tx:
+            return show_tx(search_text);
 
-        return show_address_details(address_info, nettype_addr);
-    }
+        case search_target::kind::block_hash:
+            return show_block(search_text);
 
-    // check if integrated monero address is given based on its length
-    // if yes, then show its public components search tx based on encrypted id
-    if (search_str_length == 106)
-    {
+        case search_target::kind::block_height:
+            return show_block(target.block_height);
 
-        cryptonote::account_public_address address;
+        case search_target::kind::address:
+            return show_address_details(target.address_info,
+                                        target.address_nettype);
 
-        address_parse_info address_info;
+        case search_target::kind::integrated_address:
+            return show_integrated_address_details(target.address_info,
+                                                   target.address_info.payment_id,
+                                                   target.address_nettype);
 
-        if (!get_account_address_from_str(address_info, nettype, search_text))
-        {
-            cerr << "Cant parse string integerated address: " << search_text << endl;
+        case search_target::kind::invalid_address:
             return string("Cant parse address (probably incorrect format): ")
                    + search_text;
-        }
 
-        return show_integrated_address_details(address_info,
-                                               address_info.payment_id,
-                                               nettype);
+        default:
+            break;
     }
 
     // all_possible_tx_hashes was field using custom lmdb database
@@ -4106,9 +4288,7 @@ search(string search_text)
     // for now
     vector<pair<string, vector<string>>> all_possible_tx_hashes;
 
-    result_html = show_search_results(search_text, all_possible_tx_hashes);
-
-    return result_html;
+    return show_search_results(search_text, all_possible_tx_hashes);
 }
 
 string
@@ -4131,7 +4311,7 @@ show_address_details(const address_parse_info& address_info, cryptonote::network
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["address"], context);
+    return render_page(compiled_templates.at("address"), context);
 }
 
 // ;
@@ -4159,7 +4339,7 @@ show_integrated_address_details(const address_parse_info& address_info,
     add_css_style(context);
 
     // render the page
-    return mstch::render(template_file["address"], context);
+    return render_page(compiled_templates.at("address"), context);
 }
 
 map<string, vector<string>>
@@ -4274,7 +4454,7 @@ show_search_results(const string& search_text,
 
                 crypto::hash tx_hash_pod;
 
-                epee::string_tools::hex_to_pod(tx_hash, tx_hash_pod);
+                hex_to_pod(tx_hash, tx_hash_pod);
 
                 transaction tx;
 
@@ -4290,22 +4470,21 @@ show_search_results(const string& search_text,
                     blk_height    = core_storage
                             ->get_db().get_tx_block_height(tx_hash_pod);
 
-                    blk_timestamp = core_storage
-                            ->get_db().get_block_timestamp(blk_height);
+                    blk_timestamp = get_blk_timestamp(blk_height);
 
                 }
                 else
                 {
                     // check in mempool if tx_hash not found in the
                     // blockchain
-                    vector<MempoolStatus::mempool_tx> found_txs;
+                    vector<MempoolStatus::mempool_tx_ptr> found_txs;
 
                     search_mempool(tx_hash_pod, found_txs);
 
                     if (!found_txs.empty())
                     {
                         // there should be only one tx found
-                        tx = found_txs.at(0).tx;
+                        tx = found_txs.at(0)->tx;
                     }
                     else
                     {
@@ -4314,7 +4493,7 @@ show_search_results(const string& search_text,
 
                     // tx in mempool have no blk_timestamp
                     // but can use their recive time
-                    blk_timestamp = found_txs.at(0).receive_time;
+                    blk_timestamp = found_txs.at(0)->receive_time;
 
                 }
 
@@ -4344,18 +4523,13 @@ show_search_results(const string& search_text,
     }
 
     // add header and footer
-    string full_page = template_file["search_results"];
-
-    // read partial for showing details of tx(s) found
-    map<string, string> partials {
-            {"tx_table_head", template_file["tx_table_header"]},
-            {"tx_table_row" , template_file["tx_table_row"]}
-    };
+    const mstch::compiled_template& full_page
+            = compiled_templates.at("search_results");
 
     add_css_style(context);
 
     // render the page
-    return  mstch::render(full_page, context, partials);
+    return  render_page(full_page, context);
 }
 
 string
@@ -4377,6 +4551,8 @@ get_js_file(string const& fname)
 json
 json_transaction(string tx_hash_str)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     json j_response {
             {"status", "fail"},
             {"data"  , json {}}
@@ -4570,9 +4746,11 @@ json_transaction(string tx_hash_str)
  * Lets use this json api convention for success and error
  * https://labs.omniti.com/labs/jsend
  */
-json
+string
 json_rawtransaction(string tx_hash_str)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     json j_response {
             {"status", "fail"},
             {"data"  , json {}}
@@ -4586,7 +4764,7 @@ json_rawtransaction(string tx_hash_str)
     if (!xmreg::parse_str_secret_key(tx_hash_str, tx_hash))
     {
         j_data["title"] = fmt::format("Cant parse tx hash: {:s}", tx_hash_str);
-        return j_response;
+        return j_response.dump();
     }
 
     // get transaction
@@ -4602,7 +4780,7 @@ json_rawtransaction(string tx_hash_str)
     if (!find_tx(tx_hash, tx, found_in_mempool, tx_timestamp))
     {
         j_data["title"] = fmt::format("Cant find tx hash: {:s}", tx_hash_str);
-        return j_response;
+        return j_response.dump();
     }
 
     if (found_in_mempool == false)
@@ -4618,7 +4796,7 @@ json_rawtransaction(string tx_hash_str)
             if (!mcore->get_block_by_height(block_height, blk))
             {
                 j_data["title"] = fmt::format("Cant get block: {:d}", block_height);
-                return j_response;
+                return j_response.dump();
             }
         }
         catch (const exception& e)
@@ -4627,32 +4805,34 @@ json_rawtransaction(string tx_hash_str)
             j_response["message"] = fmt::format("Tx does not exist in blockchain, "
                                                 "but was there before: {:s}",
                                                 tx_hash_str);
-            return j_response;
+            return j_response.dump();
         }
     }
 
-    // get raw tx json as in monero
+    // jsend response with raw json of the tx written
+    // straight into it, rather than parsing it into json
+    // object only to dump it again. "data" and "status" are
+    // in the order in which json::dump() would put them.
+    string response_str {"{\"data\":"};
 
-    try
-    {
-        j_data = json::parse(obj_to_json_str(tx));
-    }
-    catch (std::invalid_argument& e)
+    if (!write_tx_json(tx, response_str))
     {
         j_response["status"]  = "error";
         j_response["message"] = "Faild parsing raw tx data into json";
-        return j_response;
+        return j_response.dump();
     }
 
-    j_response["status"] = "success";
+    response_str += ",\"status\":\"success\"}";
 
-    return j_response;
+    return response_str;
 }
 
 
 json
 json_detailedtransaction(string tx_hash_str)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     json j_response {
             {"status", "fail"},
             {"data"  , json {}}
@@ -4706,6 +4886,8 @@ json_detailedtransaction(string tx_hash_str)
 json
 json_block(string block_no_or_hash)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     json j_response {
             {"status", "fail"},
             {"data"  , json {}}
@@ -4750,7 +4932,7 @@ json_block(string block_no_or_hash)
             return j_response;
         }
 
-        blk_hash = core_storage->get_block_id_by_height(block_height);
+        blk_hash = get_block_hash(blk);
 
     }
     else if (block_no_or_hash.length() == 64)
@@ -4778,7 +4960,7 @@ json_block(string block_no_or_hash)
 
 
     // get block size in bytes
-    uint64_t blk_size = core_storage->get_db().get_block_weight(block_height);
+    uint64_t blk_size = get_blk_weight(block_height);
 
     // miner reward tx
     transaction coinbase_tx = blk.miner_tx;
@@ -4846,9 +5028,11 @@ json_block(string block_no_or_hash)
  * Lets use this json api convention for success and error
  * https://labs.omniti.com/labs/jsend
  */
-json
+string
 json_rawblock(string block_no_or_hash)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     json j_response {
             {"status", "fail"},
             {"data"  , json {}}
@@ -4876,7 +5060,7 @@ json_rawblock(string block_no_or_hash)
         {
             j_data["title"] = fmt::format(
                     "Cant parse block number: {:s}", block_no_or_hash);
-            return j_response;
+            return j_response.dump();
         }
 
         if (block_height > current_blockchain_height)
@@ -4884,16 +5068,16 @@ json_rawblock(string block_no_or_hash)
             j_data["title"] = fmt::format(
                     "Requested block is higher than blockchain:"
                             " {:d}, {:d}", block_height,current_blockchain_height);
-            return j_response;
+            return j_response.dump();
         }
 
         if (!mcore->get_block_by_height(block_height, blk))
         {
             j_data["title"] = fmt::format("Cant get block: {:d}", block_height);
-            return j_response;
+            return j_response.dump();
         }
 
-        blk_hash = core_storage->get_block_id_by_height(block_height);
+        blk_hash = get_block_hash(blk);
 
     }
     else if (block_no_or_hash.length() == 64)
@@ -4902,13 +5086,13 @@ json_rawblock(string block_no_or_hash)
         if (!xmreg::parse_str_secret_key(block_no_or_hash, blk_hash))
         {
             j_data["title"] = fmt::format("Cant parse blk hash: {:s}", block_no_or_hash);
-            return j_response;
+            return j_response.dump();
         }
 
         if (!core_storage->get_block_by_hash(blk_hash, blk))
         {
             j_data["title"] = fmt::format("Cant get block: {:s}", blk_hash);
-            return j_response;
+            return j_response.dump();
         }
 
         block_height = core_storage->get_db().get_block_height(blk_hash);
@@ -4916,25 +5100,25 @@ json_rawblock(string block_no_or_hash)
     else
     {
         j_data["title"] = fmt::format("Cant find blk using search string: {:s}", block_no_or_hash);
-        return j_response;
+        return j_response.dump();
     }
 
-    // get raw tx json as in monero
+    // jsend response with raw json of the block written
+    // straight into it, rather than parsing it into json
+    // object only to dump it again. "data" and "status" are
+    // in the order in which json::dump() would put them.
+    string response_str {"{\"data\":"};
 
-    try
-    {
-        j_data = json::parse(obj_to_json_str(blk));
-    }
-    catch (std::invalid_argument& e)
+    if (!write_block_json(blk, response_str))
     {
         j_response["status"]  = "error";
         j_response["message"] = "Faild parsing raw blk data into json";
-        return j_response;
+        return j_response.dump();
     }
 
-    j_response["status"] = "success";
+    response_str += ",\"status\":\"success\"}";
 
-    return j_response;
+    return response_str;
 }
 
 
@@ -4942,7 +5126,7 @@ json_rawblock(string block_no_or_hash)
  * Lets use this json api convention for success and error
  * https://labs.omniti.com/labs/jsend
  */
-json
+json_stream
 json_transactions(string _page, string _limit)
 {
     json j_response {
@@ -4966,7 +5150,7 @@ json_transactions(string _page, string _limit)
     {
         j_data["title"] = fmt::format(
                 "Cant parse page and/or limit numbers: {:s}, {:s}", _page, _limit);
-        return j_response;
+        return make_json_stream(j_response);
     }
 
     // enforce maximum number of blocks per page to 100
@@ -4990,75 +5174,106 @@ json_transactions(string _page, string _limit)
     // loop index
     int64_t i = end_height;
 
-    j_data["blocks"] = json::array();
-    json& j_blocks = j_data["blocks"];
+    bool first_part {true};
 
-    // iterate over last no_of_last_blocks of blocks
-    while (i >= start_height)
+    // blocks are decoded and sent one chunk at a time, so that
+    // the first of them go out before the last ones are read, and
+    // we dont keep json of all of them in memory. Keys are in the
+    // same order as json::dump() would put them.
+    return [=](string& chunk) mutable -> bool
     {
-        // get block at the given height i
-        block blk;
-
-        if (!mcore->get_block_by_height(i, blk))
-        {
-            j_response["status"]  = "error";
-            j_response["message"] = fmt::format("Cant get block: {:d}", i);
-            return j_response;
-        }
+        // the producer is called after json_transactions returns,
+        // so each chunk is read in its own transaction
+        ReadTxnScope rtxn_scope {core_storage->get_db()};
 
-        // get block size in bytes
-        double blk_size = core_storage->get_db().get_block_weight(i);
+        // chunk can already have something in it, so
+        // the size of what we add here is what is limited
+        size_t chunk_start = chunk.size();
 
-        crypto::hash blk_hash = core_storage->get_block_id_by_height(i);
+        while (i >= start_height
+               && chunk.size() - chunk_start < JSON_STREAM_CHUNK_SIZE)
+        {
+            // get next few decoded blocks from the cache, or
+            // decode them now in parallel if not there yet
+            int64_t batch_start = std::max<int64_t>(
+                    i - BLOCK_DECODE_MAX_THREADS + 1, start_height);
 
-        // get block age
-        pair<string, string> age = get_age(local_copy_server_timestamp, blk.timestamp);
-
-        j_blocks.push_back(json {
-                {"height"       , i},
-                {"hash"         , pod_to_hex(blk_hash)},
-                {"age"          , age.first},
-                {"size"         , blk_size},
-                {"timestamp"    , blk.timestamp},
-                {"timestamp_utc", xmreg::timestamp_to_str_gm(blk.timestamp)},
-                {"txs"          , json::array()}
-        });
+            vector<shared_ptr<const block_summary>> blk_summaries
+                    = get_block_summaries(batch_start, i, height);
 
-        json& j_txs = j_blocks.back()["txs"];
+            for (size_t n = 0; n < blk_summaries.size(); ++n)
+            {
+                if (blk_summaries[n])
+                    continue;
 
-        vector<cryptonote::transaction> blk_txs {blk.miner_tx};
-        vector<crypto::hash> missed_txs;
+                string error_msg = fmt::format("Cant get block: {:d}", i - n);
 
-        if (!core_storage->get_transactions(blk.tx_hashes, blk_txs, missed_txs))
-        {
-            j_response["status"]  = "error";
-            j_response["message"] = fmt::format("Cant get transactions in block: {:d}", i);
-            return j_response;
-        }
+                // if nothing was sent yet, we can
+                // still respond with an error
+                if (i == end_height)
+                {
+                    j_response["status"]  = "error";
+                    j_response["message"] = error_msg;
 
-        (void) missed_txs;
+                    chunk += j_response.dump();
+                    return false;
+                }
 
-        for(auto it = blk_txs.begin(); it != blk_txs.end(); ++it)
-        {
-            const cryptonote::transaction &tx = *it;
+                // otherwise crow closes the connection
+                // without sending the rest
+                throw std::runtime_error(error_msg);
+            }
 
-            const tx_details& txd = get_tx_details(tx, false, i, height);
+            if (first_part)
+            {
+                chunk += "{\"data\":{\"blocks\":[";
+                first_part = false;
+            }
 
-            j_txs.push_back(get_tx_json(tx, txd));
+            for (const shared_ptr<const block_summary>& blk_summary: blk_summaries)
+            {
+                // get block size in bytes
+                double blk_size = blk_summary->weight;
+
+                // get block age
+                pair<string, string> age = get_age(local_copy_server_timestamp,
+                                                   blk_summary->timestamp);
+
+                if (i != end_height)
+                    chunk += ',';
+
+                chunk += json {
+                        {"height"       , i},
+                        {"hash"         , pod_to_hex(blk_summary->hash)},
+                        {"age"          , age.first},
+                        {"size"         , blk_size},
+                        {"timestamp"    , blk_summary->timestamp},
+                        {"timestamp_utc", xmreg::timestamp_to_str_gm(blk_summary->timestamp)},
+                        {"txs"          , blk_summary->txs_json}
+                }.dump();
+
+                --i;
+            }
         }
 
-        --i;
-    }
-
-    j_data["page"]           = page;
-    j_data["limit"]          = limit;
-    j_data["current_height"] = height;
+        // page without blocks
+        if (first_part)
+        {
+            chunk += "{\"data\":{\"blocks\":[";
+            first_part = false;
+        }
 
-    j_data["total_page_no"]  = limit > 0 ? (height / limit) : 0;
+        if (i >= start_height)
+            return true;
 
-    j_response["status"] = "success";
+        chunk += "],\"current_height\":" + std::to_string(height)
+                 + ",\"limit\":"         + std::to_string(limit)
+                 + ",\"page\":"          + std::to_string(page)
+                 + ",\"total_page_no\":" + std::to_string(limit > 0 ? (height / limit) : 0)
+                 + "},\"status\":\"success\"}";
 
-    return j_response;
+        return false;
+    };
 }
 
 
@@ -5066,7 +5281,7 @@ json_transactions(string _page, string _limit)
 * Lets use this json api convention for success and error
 * https://labs.omniti.com/labs/jsend
 */
-json
+json_stream
 json_mempool(string _page, string _limit)
 {
     json j_response {
@@ -5090,7 +5305,7 @@ json_mempool(string _page, string _limit)
     {
         j_data["title"] = fmt::format(
                 "Cant parse page and/or limit numbers: {:s}, {:s}", _page, _limit);
-        return j_response;
+        return make_json_stream(j_response);
     }
 
     //get current server timestamp
@@ -5100,11 +5315,11 @@ json_mempool(string _page, string _limit)
 
     uint64_t height = core_storage->get_current_blockchain_height();
 
-    // get mempool tx from mempoolstatus thread
-    vector<MempoolStatus::mempool_tx> mempool_data
-            = MempoolStatus::get_mempool_txs();
+    // get mempool snapshot from mempoolstatus thread
+    std::shared_ptr<const MempoolStatus::mempool_snapshot> mempool
+            = MempoolStatus::get_mempool_snapshot();
 
-    uint64_t no_mempool_txs = mempool_data.size();
+    uint64_t no_mempool_txs = mempool->txs.size();
 
     // calculate starting and ending block numbers to show
     int64_t start_height = limit * page;
@@ -5121,48 +5336,55 @@ json_mempool(string _page, string _limit)
     // loop index
     int64_t i = start_height;
 
-    json j_txs = json::array();
+    bool first_part {true};
 
-    // for each transaction in the memory pool in current page
-    while (i < end_height)
+    // txs are sent one chunk at a time. The snapshot is kept
+    // by the stream, so it does not change while being sent.
+    return [=](string& chunk) mutable -> bool
     {
-        const MempoolStatus::mempool_tx* mempool_tx {nullptr};
+        size_t chunk_start = chunk.size();
 
-        try
+        if (first_part)
         {
-            mempool_tx = &(mempool_data.at(i));
+            chunk += "{\"data\":{\"limit\":"   + std::to_string(limit)
+                     + ",\"page\":"          + std::to_string(page)
+                     + ",\"total_page_no\":" + std::to_string(limit > 0 ? (no_mempool_txs / limit) : 0)
+                     + ",\"txs\":[";
+
+            first_part = false;
         }
-        catch (const std::out_of_range& e)
+
+        // for each transaction in the memory pool in current page
+        while (i < end_height
+               && chunk.size() - chunk_start < JSON_STREAM_CHUNK_SIZE)
         {
-            j_response["status"]  = "error";
-            j_response["message"] = fmt::format("Getting mempool txs failed due to std::out_of_range");
+            const MempoolStatus::mempool_tx* mempool_tx = mempool->txs[i].get();
 
-            return j_response;
-        }
+            const tx_details& txd = get_tx_details(mempool_tx->tx, false, 1, height); // 1 is dummy here
 
-        const tx_details& txd = get_tx_details(mempool_tx->tx, false, 1, height); // 1 is dummy here
+            // get basic tx info
+            json j_tx = get_tx_json(mempool_tx->tx, txd);
 
-        // get basic tx info
-        json j_tx = get_tx_json(mempool_tx->tx, txd);
+            // we add some extra data, for mempool txs, such as recieve timestamp
+            j_tx["timestamp"]     = mempool_tx->receive_time;
+            j_tx["timestamp_utc"] = mempool_tx->timestamp_str;
 
-        // we add some extra data, for mempool txs, such as recieve timestamp
-        j_tx["timestamp"]     = mempool_tx->receive_time;
-        j_tx["timestamp_utc"] = mempool_tx->timestamp_str;
+            if (i != start_height)
+                chunk += ',';
 
-        j_txs.push_back(j_tx);
+            chunk += j_tx.dump();
 
-       ++i;
-    }
+           ++i;
+        }
 
-    j_data["txs"]            = j_txs;
-    j_data["page"]           = page;
-    j_data["limit"]          = limit;
-    j_data["txs_no"]         = no_mempool_txs;
-    j_data["total_page_no"]  = limit > 0 ? (no_mempool_txs / limit) : 0;
+        if (i < end_height)
+            return true;
 
-    j_response["status"] = "success";
+        chunk += "],\"txs_no\":" + std::to_string(no_mempool_txs)
+                 + "},\"status\":\"success\"}";
 
-    return j_response;
+        return false;
+    };
 }
 
 
@@ -5173,6 +5395,8 @@ json_mempool(string _page, string _limit)
 json
 json_search(const string& search_text)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     json j_response {
             {"status", "fail"},
             {"data",   json {}}
@@ -5185,49 +5409,37 @@ json_search(const string& search_text)
 
     uint64_t local_copy_server_timestamp = server_timestamp;
 
-    uint64_t height = core_storage->get_current_blockchain_height();
+    search_target target = classify_search(search_text);
 
-    uint64_t search_str_length = search_text.length();
+    json j_found;
 
-    // first let check if the search_text matches any tx or block hash
-    if (search_str_length == 64)
+    switch (target.what)
     {
-        // first check for tx
-        json j_tx = json_transaction(search_text);
-
-        if (j_tx["status"] == "success")
-        {
-            j_response["data"]   = j_tx["data"];
-            j_response["data"]["title"]  = "transaction";
-            j_response["status"] = "success";
-            return j_response;
-        }
+        case search_target::kind::tx:
+        case search_target::kind::mempool_tx:
+            j_found = json_transaction(search_text);
+            j_found["data"]["title"] = "transaction";
+            break;
 
-        // now check for block
+        case search_target::kind::block_hash:
+            j_found = json_block(search_text);
+            j_found["data"]["title"] = "block";
+            break;
 
-        json j_block = json_block(search_text);
+        case search_target::kind::block_height:
+            j_found = json_block(std::to_string(target.block_height));
+            j_found["data"]["title"] = "block";
+            break;
 
-        if (j_block["status"] == "success")
-        {
-            j_response["data"]  = j_block["data"];
-            j_response["data"]["title"]  = "block";
-            j_response["status"] = "success";
-            return j_response;
-        }
+        default:
+            break;
     }
 
-    // now lets see if this is a block number
-    if (search_str_length <= 8)
+    if (j_found.count("status") && j_found["status"] == "success")
     {
-        json j_block = json_block(search_text);
-
-        if (j_block["status"] == "success")
-        {
-            j_response["data"]   = j_block["data"];
-            j_response["data"]["title"]  = "block";
-            j_response["status"] = "success";
-            return j_response;
-        }
+        j_response["data"]   = j_found["data"];
+        j_response["status"] = "success";
+        return j_response;
     }
 
     j_data["title"] = "Nothing was found that matches search string: " + search_text;
@@ -5241,6 +5453,8 @@ json_outputs(string tx_hash_str,
              string viewkey_str,
              bool tx_prove = false)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     boost::trim(tx_hash_str);
     boost::trim(address_str);
     boost::trim(viewkey_str);
@@ -5440,9 +5654,7 @@ json_outputs(string tx_hash_str,
     // if we don't already have the tx_timestamp from the mempool
     // then read it from the block that the transaction is in
     if (!tx_timestamp && txd.blk_height > 0) {
-        block blk;
-        mcore->get_block_by_height(txd.blk_height, blk);
-        tx_timestamp = blk.timestamp;
+        tx_timestamp = get_blk_timestamp(txd.blk_height);
     }
 
     // return parsed values. can be use to double
@@ -5468,6 +5680,8 @@ json_outputsblocks(string _limit,
                    string viewkey_str,
                    bool in_mempool_aswell = false)
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     boost::trim(_limit);
     boost::trim(address_str);
     boost::trim(viewkey_str);
@@ -5492,8 +5706,8 @@ json_outputsblocks(string _limit,
         return j_response;
     }
 
-    // maxium five last blocks
-    no_of_last_blocks = std::min<uint64_t>(no_of_last_blocks, 5ul);
+    no_of_last_blocks = std::min<uint64_t>(no_of_last_blocks,
+                                           OUTPUTSBLOCKS_MAX_NO_OF_BLOCKS);
 
     if (address_str.empty())
     {
@@ -5536,41 +5750,29 @@ json_outputsblocks(string _limit,
     j_data["outputs"] = json::array();
     json& j_outptus   = j_data["outputs"];
 
+    // cpu time the threads can spend together on the scanning.
+    // reading blocks here is limited to the same wall time.
+    std::chrono::microseconds cpu_budget
+            = std::chrono::milliseconds {OUTPUTSBLOCKS_CPU_TIME_LIMIT};
 
-    if (in_mempool_aswell)
-    {
-        // first check if there is something for us in the mempool
-        // get mempool tx from mempoolstatus thread
-        vector<MempoolStatus::mempool_tx> mempool_txs
-                = MempoolStatus::get_mempool_txs();
-
-        uint64_t no_mempool_txs = mempool_txs.size();
-
-        // need to use vector<transactions>,
-        // not vector<MempoolStatus::mempool_tx>
-        vector<transaction> tmp_vector;
-        tmp_vector.reserve(no_mempool_txs);
+    std::chrono::steady_clock::time_point reading_deadline
+            = std::chrono::steady_clock::now() + cpu_budget;
 
-        for (size_t i = 0; i < no_mempool_txs; ++i)
-        {
-            // get transaction info of the tx in the mempool
-            tmp_vector.push_back(std::move(mempool_txs.at(i).tx));
-        }
+    // first check if there is something for us in the mempool
+    // get mempool snapshot from mempoolstatus thread
+    std::shared_ptr<const MempoolStatus::mempool_snapshot> mempool;
 
-        if (!find_our_outputs(
-                address_info.address, prv_view_key,
-                0 /* block_no */, true /*is mempool*/,
-                tmp_vector.cbegin(), tmp_vector.cend(),
-                j_outptus /* found outputs are pushed to this*/,
-                error_msg))
-        {
-            j_response["status"] = "error";
-            j_response["message"] = error_msg;
-            return j_response;
-        }
+    // txs from the mempool and the blocks, in the
+    // order in which found outputs are returned
+    vector<output_scan_tx> scan_txs;
 
-    } // if (in_mempool_aswell)
+    if (in_mempool_aswell)
+    {
+        mempool = MempoolStatus::get_mempool_snapshot();
 
+        for (const MempoolStatus::mempool_tx_ptr& mempool_tx: mempool->txs)
+            scan_txs.push_back({&mempool_tx->tx, 0 /* block_no */, true});
+    }
 
     // and now serach for outputs in last few blocks in the blockchain
 
@@ -5587,9 +5789,17 @@ json_outputsblocks(string _limit,
     // loop index
     int64_t block_no = end_height;
 
+    // txs of the read blocks. deque, so that
+    // scan_txs can point to them.
+    std::deque<cryptonote::transaction> blk_txs;
 
-    // iterate over last no_of_last_blocks of blocks
-    while (block_no >= start_height)
+    // index in scan_txs after the last tx of each read block
+    vector<size_t> blocks_ends;
+
+    // read last no_of_last_blocks of blocks, or as many as
+    // we can in the time we have
+    while (block_no >= start_height
+           && std::chrono::steady_clock::now() < reading_deadline)
     {
         // get block at the given height block_no
         block blk;
@@ -5602,10 +5812,10 @@ json_outputsblocks(string _limit,
         }
 
         // get transactions in the given block
-        vector<cryptonote::transaction> blk_txs{blk.miner_tx};
+        vector<cryptonote::transaction> txs {blk.miner_tx};
         vector<crypto::hash> missed_txs;
 
-        if (!core_storage->get_transactions(blk.tx_hashes, blk_txs, missed_txs))
+        if (!core_storage->get_transactions(blk.tx_hashes, txs, missed_txs))
         {
             j_response["status"] = "error";
             j_response["message"] = fmt::format("Cant get transactions in block: {:d}", block_no);
@@ -5614,22 +5824,38 @@ json_outputsblocks(string _limit,
 
         (void) missed_txs;
 
-        if (!find_our_outputs(
-                address_info.address, prv_view_key,
-                block_no, false /*is mempool*/,
-                blk_txs.cbegin(), blk_txs.cend(),
-                j_outptus /* found outputs are pushed to this*/,
-                error_msg))
+        for (cryptonote::transaction& tx: txs)
         {
-            j_response["status"] = "error";
-            j_response["message"] = error_msg;
-            return j_response;
+            blk_txs.push_back(std::move(tx));
+            scan_txs.push_back({&blk_txs.back(),
+                                static_cast<uint64_t>(block_no), false});
         }
 
+        blocks_ends.push_back(scan_txs.size());
+
         --block_no;
 
     }  //  while (block_no >= start_height)
 
+    uint64_t no_of_scanned_txs {0};
+
+    if (!scan_txs_for_outputs(
+            address_info.address, prv_view_key,
+            scan_txs, cpu_budget,
+            j_outptus /* found outputs are pushed to this*/,
+            no_of_scanned_txs,
+            error_msg))
+    {
+        j_response["status"] = "error";
+        j_response["message"] = error_msg;
+        return j_response;
+    }
+
+    // number of blocks, from the top, which were fully scanned
+    uint64_t no_of_scanned_blocks = std::upper_bound(
+            blocks_ends.begin(), blocks_ends.end(), no_of_scanned_txs)
+                                    - blocks_ends.begin();
+
     // return parsed values. can be use to double
     // check if submited data in the request
     // matches to what was used to produce response.
@@ -5639,6 +5865,12 @@ json_outputsblocks(string _limit,
     j_data["height"]   = height;
     j_data["mempool"]  = in_mempool_aswell;
 
+    // if we run out of time, not all requested
+    // blocks or mempool txs are scanned
+    j_data["scanned_blocks"] = no_of_scanned_blocks;
+    j_data["complete"]       = (no_of_scanned_txs == scan_txs.size()
+                                && block_no < start_height);
+
     j_response["status"] = "success";
 
     return j_response;
@@ -5698,6 +5930,8 @@ json_networkinfo()
 json
 json_emission()
 {
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
+
     json j_response {
             {"status", "fail"},
             {"data",   json {}}
@@ -5726,6 +5960,13 @@ json_emission()
                 {"blk_no"  , current_values.blk_no - 1},
                 {"coinbase", current_values.coinbase},
                 {"fee"     , current_values.fee},
+                {"scan"    , json {
+                        {"blockchain_height" , CurrentBlockchainStatus::current_height.load()},
+                        {"scanned_blocks"    , CurrentBlockchainStatus::no_of_scanned_blocks.load()},
+                        {"blocks_per_second" , static_cast<uint64_t>(
+                                CurrentBlockchainStatus::scan_blocks_per_second.load())},
+                        {"threads"           , CurrentBlockchainStatus::no_of_scan_threads}
+                }}
         };
     }
 
@@ -5734,6 +5975,50 @@ json_emission()
     return j_response;
 }
 
+/*
+ * Lets use this json api convention for success and error
+ * https://labs.omniti.com/labs/jsend
+ */
+json
+json_emission_at(uint64_t blk_height)
+{
+    json j_response {
+            {"status", "fail"},
+            {"data",   json {}}
+    };
+
+    json& j_data = j_response["data"];
+
+    if (!CurrentBlockchainStatus::is_thread_running())
+    {
+        j_data["title"] = "Emission monitoring thread not enabled.";
+        return j_response;
+    }
+
+    // cumulative emission up to and including blk_height
+    EmissionIndex::entry emission;
+
+    if (!CurrentBlockchainStatus::emission_index.get(blk_height, emission))
+    {
+        j_data["title"] = fmt::format(
+                "Emission at block {:d} is not known yet. "
+                "Emission is known only for first {:d} blocks.",
+                blk_height,
+                CurrentBlockchainStatus::emission_index.size());
+        return j_response;
+    }
+
+    j_data = json {
+            {"blk_no"  , blk_height},
+            {"coinbase", emission.coinbase},
+            {"fee"     , emission.fee}
+    };
+
+    j_response["status"]  = "success";
+
+    return j_response;
+}
+
 
 /*
       * Lets use this json api convention for success and error
@@ -5764,853 +6049,2285 @@ json_version()
 }
 
 
-private:
-
-
-string
-get_payment_id_as_string(
-        tx_details const& txd,
-        secret_key const& prv_view_key)
+/*
+ * Internal counters of the explorer, to help with
+ * setting its options, e.g., --worker-threads
+ */
+json
+json_stats()
 {
-    string payment_id;
+    json j_response {
+            {"status", "fail"},
+            {"data",   json {}}
+    };
 
-    // decrypt encrypted payment id, as used in integreated addresses
-    crypto::hash8 decrypted_payment_id8 = txd.payment_id8;
+    json& j_data = j_response["data"];
 
-    if (decrypted_payment_id8 != null_hash8)
+    ThreadPool::stats executor_stats = executor->get_stats();
+
+    j_data["executor"] = json {
+            {"no_of_threads"      , executor_stats.no_of_threads},
+            {"max_queue_size"     , executor_stats.max_queue_size},
+            {"queue_depth"        , executor_stats.queue_depth},
+            {"tasks_submitted"    , executor_stats.tasks_submitted},
+            {"tasks_completed"    , executor_stats.tasks_completed},
+            {"tasks_run_in_caller", executor_stats.tasks_run_in_caller},
+            {"total_wait_time_us" , executor_stats.total_wait_time},
+            {"max_wait_time_us"   , executor_stats.max_wait_time},
+            {"total_run_time_us"  , executor_stats.total_run_time},
+            {"max_run_time_us"    , executor_stats.max_run_time}
+    };
+
+    rpccalls::pool_stats rpc_stats = rpc->get_pool_stats();
+
+    j_data["daemon_rpc"] = json {
+            {"no_of_connections" , rpc_stats.no_of_connections},
+            {"idle_connections"  , rpc_stats.idle_connections},
+            {"checkouts"         , rpc_stats.checkouts},
+            {"checkout_timeouts" , rpc_stats.checkout_timeouts},
+            {"reconnects"        , rpc_stats.reconnects},
+            {"failed_calls"      , rpc_stats.failed_calls},
+            {"total_wait_time_us", rpc_stats.total_wait_time},
+            {"max_wait_time_us"  , rpc_stats.max_wait_time}
+    };
+
+    j_data["block_cache"] = json {
+            {"size"    , block_summary_cache.size()},
+            {"capacity", block_summary_cache.get_capacity()},
+            {"hits"    , block_summary_cache.hits()},
+            {"misses"  , block_summary_cache.misses()}
+    };
+
+    j_data["ring_member_cache"] = json {
+            {"size"    , ring_member_cache.size()},
+            {"capacity", ring_member_cache.get_capacity()},
+            {"hits"    , ring_member_cache.hits()},
+            {"misses"  , ring_member_cache.misses()}
+    };
+
+    j_data["header_index"] = json {
+            {"enabled"     , enable_header_index},
+            {"no_of_blocks", header_index.size()},
+            {"memory_bytes", header_index.memory_usage()}
+    };
+
+    ReadTxnScope::stats rtxn_stats = ReadTxnScope::get_stats();
+
+    j_data["read_txns"] = json {
+            {"txns_started"      , rtxn_stats.txns_started},
+            {"txns_joined"       , rtxn_stats.txns_joined},
+            {"failed_starts"     , rtxn_stats.failed_starts},
+            {"open_txns"         , rtxn_stats.open_txns},
+            {"total_open_time_us", rtxn_stats.total_open_time},
+            {"max_open_time_us"  , rtxn_stats.max_open_time}
+    };
+
+    ChainTipWatcher::chain_tip tip = ChainTipWatcher::get_chain_tip();
+
+    j_data["hex_codec"] = hex_codec_name();
+
+    j_data["chain_tip"] = json {
+            {"generation"  , tip.generation},
+            {"height"      , tip.height},
+            {"top_hash"    , pod_to_hex(tip.top_hash)},
+            {"fork_height" , tip.fork_height}
+    };
+
+    j_response["status"]  = "success";
+
+    return j_response;
+}
+
+/*
+ * Lets use this json api convention for success and error
+ * https://labs.omniti.com/labs/jsend
+ */
+json_stream
+json_checkrawkeyimgs(string raw_data, string viewkey_str)
+{
+    clean_post_data(raw_data);
+
+    // remove white characters
+    boost::trim(viewkey_str);
+
+    json j_response {
+            {"status", "fail"},
+            {"data",   json {}}
+    };
+
+    json& j_data = j_response["data"];
+
+    secret_key prv_view_key;
+
+    if (!xmreg::parse_str_secret_key(viewkey_str, prv_view_key))
     {
-        if (mcore->get_device()->decrypt_payment_id(decrypted_payment_id8, txd.pk, prv_view_key))
-        {
-            payment_id = pod_to_hex(decrypted_payment_id8);
-        }
+        j_data["title"] = "Cant parse the private view key: " + viewkey_str;
+        return make_json_stream(j_response);
     }
-    else if(txd.payment_id != null_hash)
+
+    string decoded_raw_data = epee::string_encoding::base64_decode(raw_data);
+
+    address_parse_info address_info;
+
+    vector<crypto::key_image> key_images;
+    vector<crypto::signature> signatures;
+
+    string error_msg;
+
+    if (!decrypt_raw_key_images(decoded_raw_data, prv_view_key,
+                                address_info, key_images, signatures,
+                                error_msg))
     {
-        payment_id = pod_to_hex(txd.payment_id);
+        j_data["title"] = error_msg;
+        return make_json_stream(j_response);
     }
 
-    return payment_id;
-}
+    shared_ptr<const vector<crypto::key_image>> key_images_ptr
+            = make_shared<const vector<crypto::key_image>>(
+                    std::move(key_images));
 
-template <typename Iterator>
-bool
-find_our_outputs(
-        account_public_address const& address,
-        secret_key const& prv_view_key,
-        uint64_t const& block_no,
-        bool const& is_mempool,
-        Iterator const& txs_begin,
-        Iterator const& txs_end,
-        json& j_outptus,
-        string& error_msg)
-{
+    string address_str = pod_to_hex(address_info.address);
+    string viewkey_hex = pod_to_hex(prv_view_key);
+
+    // index of the next key image to check
+    size_t next_key_image {0};
 
-    // for each tx, perform output search using provided
-    // address and viewkey
-    for (auto it = txs_begin; it != txs_end; ++it)
+    uint64_t no_of_spent {0};
+
+    bool first_part {true};
+
+    // key images are checked and sent one batch at a time, so that
+    // results for the first ones go out before the last ones are
+    // checked, and we dont keep json of all of them in memory.
+    // Each batch is checked in its own read transaction. Keys are
+    // in the same order as json::dump() would put them.
+    return [=](string& chunk) mutable -> bool
     {
-        cryptonote::transaction const& tx = *it;
+        const vector<crypto::key_image>& all_key_images = *key_images_ptr;
 
-        tx_details txd = get_tx_details(tx);
+        size_t batch_end = std::min<size_t>(
+                next_key_image + KEY_IMAGES_STREAM_BATCH_SIZE,
+                all_key_images.size());
 
-        // public transaction key is combined with our viewkey
-        // to create, so called, derived key.
-        key_derivation derivation;
+        vector<crypto::key_image> batch(
+                all_key_images.begin() + next_key_image,
+                all_key_images.begin() + batch_end);
 
-        if (!generate_key_derivation(txd.pk, prv_view_key, derivation))
-        {
-            error_msg = "Cant calculate key_derivation";
-            return false;
-        }
+        vector<bool> spent;
 
-        std::vector<key_derivation> additional_derivations(txd.additional_pks.size());
-        for (size_t i = 0; i < txd.additional_pks.size(); ++i)
+        if (!mcore->are_key_images_spent(batch, spent))
         {
-            if (!generate_key_derivation(txd.additional_pks[i], prv_view_key, additional_derivations[i]))
+            // if nothing was sent yet, we can
+            // still respond with an error
+            if (first_part)
             {
-                error_msg = "Cant calculate key_derivation";
+                j_response["status"]  = "error";
+                j_response["message"] = "Cant check if key images are spent";
+
+                chunk += j_response.dump();
                 return false;
             }
+
+            // otherwise crow closes the connection
+            // without sending the rest
+            throw std::runtime_error("Cant check if key images are spent");
         }
 
-        uint64_t output_idx{0};
+        if (first_part)
+        {
+            chunk += "{\"data\":{\"address\":\"" + address_str
+                     + "\",\"key_images\":[";
+            first_part = false;
+        }
 
-        std::vector<uint64_t> money_transfered(tx.vout.size(), 0);
+        for (size_t n = 0; n < batch.size(); ++n)
+        {
+            if (next_key_image + n != 0)
+                chunk += ',';
 
-        //j_data["outputs"] = json::array();
-        //json& j_outptus   = j_data["outputs"];
+            chunk += json {
+                    {"key_image", pod_to_hex(batch[n])},
+                    {"is_spent" , static_cast<bool>(spent[n])}
+            }.dump();
 
-        for (pair<txout_to_key, uint64_t> &outp: txd.output_pub_keys)
-        {
+            no_of_spent += spent[n];
+        }
 
-            // get the tx output public key
-            // that normally would be generated for us,
-            // if someone had sent us some xmr.
-            public_key tx_pubkey;
+        next_key_image = batch_end;
 
-            derive_public_key(derivation,
-                              output_idx,
-                              address.m_spend_public_key,
-                              tx_pubkey);
+        if (next_key_image < all_key_images.size())
+            return true;
 
-            // check if generated public key matches the current output's key
-            bool mine_output = (outp.first.key == tx_pubkey);
-            bool with_additional = false;
-            if (!mine_output && txd.additional_pks.size() == txd.output_pub_keys.size())
-            {
-                derive_public_key(additional_derivations[output_idx],
-                                  output_idx,
-                                  address.m_spend_public_key,
-                                  tx_pubkey);
-                mine_output = (outp.first.key == tx_pubkey);
-                with_additional = true;
-            }
+        chunk += "],\"no_of_key_images\":" + std::to_string(all_key_images.size())
+                 + ",\"no_of_spent\":"      + std::to_string(no_of_spent)
+                 + ",\"viewkey\":\""        + viewkey_hex
+                 + "\"},\"status\":\"success\"}";
 
-            // if mine output has RingCT, i.e., tx version is 2
-            if (mine_output && tx.version == 2)
-            {
-                // cointbase txs have amounts in plain sight.
-                // so use amount from ringct, only for non-coinbase txs
-                if (!is_coinbase(tx))
-                {
+        return false;
+    };
+}
 
-                    // initialize with regular amount
-                    uint64_t rct_amount = money_transfered[output_idx];
 
-                    bool r {false};
+private:
 
-                    rct::key mask = tx.rct_signatures.ecdhInfo[output_idx].mask;
 
-                    r = decode_ringct(tx.rct_signatures,
-                                      with_additional ? additional_derivations[output_idx] : derivation,
-                                      output_idx,
-                                      mask,
-                                      rct_amount);
+// weak, as the same content can be sent compressed or not
+string
+make_immutable_etag(crypto::hash const& hash, uint64_t blk_height)
+{
+    if (blk_height + IMMUTABLE_CONFIRMATIONS
+            > core_storage->get_current_blockchain_height())
+        return string {};
 
-                    if (!r)
-                    {
-                        error_msg = "Cant decode ringct for tx: "
-                                                + pod_to_hex(txd.hash);
-                        return false;
-                    }
+    return fmt::format("W/\"{:s}-{:s}\"", pod_to_hex(hash),
+                       string {GIT_COMMIT_HASH});
+}
 
-                    outp.second = rct_amount;
-                    money_transfered[output_idx] = rct_amount;
+// height is in the ETag, as a tx can end up in
+// a different block after a deep reorg
+string
+make_page_etag(crypto::hash const& hash, uint64_t blk_height)
+{
+    uint64_t height = core_storage->get_current_blockchain_height();
 
-                } // if (!is_coinbase(tx))
+    if (blk_height + IMMUTABLE_CONFIRMATIONS > height)
+        return string {};
 
-            }  // if (mine_output && tx.version == 2)
+    uint64_t confirmations_bucket
+            = (height - blk_height) / PAGE_ETAG_CONFIRMATIONS_BUCKET;
 
-            if (mine_output)
-            {
-                string payment_id_str = get_payment_id_as_string(txd, prv_view_key);
-
-                j_outptus.push_back(json {
-                        {"output_pubkey" , pod_to_hex(outp.first.key)},
-                        {"amount"        , outp.second},
-                        {"block_no"      , block_no},
-                        {"in_mempool"    , is_mempool},
-                        {"output_idx"    , output_idx},
-                        {"tx_hash"       , pod_to_hex(txd.hash)},
-                        {"payment_id"    , payment_id_str}
-                });
-            }
+    return fmt::format("W/\"{:s}-{:d}-{:s}-{:s}-{:d}\"",
+                       pod_to_hex(hash), blk_height,
+                       string {GIT_COMMIT_HASH}, templates_version,
+                       confirmations_bucket);
+}
 
-            ++output_idx;
+// false if the tx is not in the blockchain
+bool
+find_tx_block_height(string const& tx_hash_str,
+                     crypto::hash& tx_hash,
+                     uint64_t& tx_blk_height)
+{
+    if (!hex_to_pod(tx_hash_str, tx_hash))
+        return false;
 
-        } //  for (pair<txout_to_key, uint64_t>& outp: txd.output_pub_keys)
+    try
+    {
+        if (!core_storage->get_db().tx_exists(tx_hash))
+            return false;
 
-    } // for (auto it = blk_txs.begin(); it != blk_txs.end(); ++it)
+        tx_blk_height = core_storage->get_db().get_tx_block_height(tx_hash);
+    }
+    catch (std::exception const& e)
+    {
+        cerr << "Cant get height of tx " << tx_hash_str
+             << ": " << e.what() << endl;
+        return false;
+    }
 
     return true;
 }
 
-json
-get_tx_json(const transaction& tx, const tx_details& txd)
+// false if there is no block at this height
+bool
+find_block_hash(uint64_t blk_height, crypto::hash& blk_hash)
 {
+    try
+    {
+        if (blk_height >= core_storage->get_current_blockchain_height())
+            return false;
 
-    json j_tx {
-            {"tx_hash"     , pod_to_hex(txd.hash)},
-            {"tx_fee"      , txd.fee},
-            {"mixin"       , txd.mixin_no},
-            {"tx_size"     , txd.size},
-            {"xmr_outputs" , txd.xmr_outputs},
-            {"xmr_inputs"  , txd.xmr_inputs},
-            {"tx_version"  , static_cast<uint64_t>(txd.version)},
-            {"rct_type"    , tx.rct_signatures.type},
-            {"coinbase"    , is_coinbase(tx)},
-            {"mixin"       , txd.mixin_no},
-            {"extra"       , txd.get_extra_str()},
-            {"payment_id"  , (txd.payment_id  != null_hash  ? pod_to_hex(txd.payment_id)  : "")},
-            {"payment_id8" , (txd.payment_id8 != null_hash8 ? pod_to_hex(txd.payment_id8) : "")},
-    };
+        blk_hash = core_storage->get_block_id_by_height(blk_height);
+    }
+    catch (std::exception const& e)
+    {
+        cerr << "Cant get hash of block " << blk_height
+             << ": " << e.what() << endl;
+        return false;
+    }
 
-    return j_tx;
+    return true;
 }
 
-
+// false if the block is not in the blockchain
 bool
-find_tx(const crypto::hash& tx_hash,
-        transaction& tx,
-        bool& found_in_mempool,
-        uint64_t& tx_timestamp)
+find_block_height(string const& blk_hash_str,
+                  crypto::hash& blk_hash,
+                  uint64_t& blk_height)
 {
+    if (!hex_to_pod(blk_hash_str, blk_hash))
+        return false;
 
-    found_in_mempool = false;
-
-    if (!mcore->get_tx(tx_hash, tx))
+    try
     {
-        cerr << "Cant get tx in blockchain: " << tx_hash
-             << ". \n Check mempool now" << endl;
-
-        vector<MempoolStatus::mempool_tx> found_txs;
-
-        search_mempool(tx_hash, found_txs);
-
-        if (!found_txs.empty())
-        {
-            // there should be only one tx found
-            tx = found_txs.at(0).tx;
-            found_in_mempool = true;
-            tx_timestamp = found_txs.at(0).receive_time;
-        }
-        else
-        {
-            // tx is nowhere to be found :-(
+        if (!core_storage->get_db().block_exists(blk_hash, &blk_height))
             return false;
-        }
+    }
+    catch (std::exception const& e)
+    {
+        cerr << "Cant get height of block " << blk_hash_str
+             << ": " << e.what() << endl;
+        return false;
     }
 
     return true;
 }
 
 
-void
-mark_real_mixins_on_timescales(
-        const vector<uint64_t>& real_output_indices,
-        mstch::map& tx_context)
+/**
+ * Finds out what the search string is: tx or block hash
+ * (one lmdb read txn, then the mempool snapshot), block
+ * height or an address, without fetching or rendering any
+ * of them, so that a miss costs only a few index probes.
+ */
+search_target
+classify_search(string const& search_text)
 {
-    // mark real mixing in the mixins timescale graph
-    mstch::array& mixins_timescales
-            = boost::get<mstch::array>(tx_context["timescales"]);
+    search_target target;
 
-    uint64_t idx {0};
+    uint64_t search_str_length = search_text.length();
 
-    for (mstch::node& timescale_node: mixins_timescales)
+    if (search_str_length == 64)
     {
+        if (!xmreg::parse_str_secret_key(search_text, target.hash))
+            return target;
 
-        string& timescale = boost::get<string>(
-                boost::get<mstch::map>(timescale_node)["timescale"]
-        );
+        bool is_tx {false};
+        bool is_block {false};
 
-        // claculated number of timescale points
-        // due to resolution, no of points might be lower than no of mixins
-        size_t no_points = std::count(timescale.begin(), timescale.end(), '*');
+        if (mcore->find_hash(target.hash, is_tx, is_block))
+        {
+            if (is_tx)
+            {
+                target.what = search_target::kind::tx;
+                return target;
+            }
 
-        size_t point_to_find = real_output_indices.at(idx);
+            if (is_block)
+            {
+                target.what = search_target::kind::block_hash;
+                return target;
+            }
+        }
 
-        // adjust point to find based on total number of points
-        if (point_to_find >= no_points)
-            point_to_find = no_points  - 1;
+        vector<MempoolStatus::mempool_tx_ptr> found_txs;
 
-        boost::iterator_range<string::iterator> r
-                = boost::find_nth(timescale, "*", point_to_find);
+        search_mempool(target.hash, found_txs);
 
-        *(r.begin()) = 'R';
+        if (!found_txs.empty())
+            target.what = search_target::kind::mempool_tx;
 
-        ++idx;
+        return target;
     }
-}
 
-mstch::map
-construct_tx_context(transaction tx, uint16_t with_ring_signatures = 0)
-{
-    tx_details txd = get_tx_details(tx);
+    if (search_str_length > 0 && search_str_length < 12
+            && std::all_of(search_text.begin(), search_text.end(),
+                           [](unsigned char c) {return std::isdigit(c);}))
+    {
+        target.block_height = boost::lexical_cast<uint64_t>(search_text);
 
-    const crypto::hash& tx_hash = txd.hash;
+        if (target.block_height < core_storage->get_current_blockchain_height())
+            target.what = search_target::kind::block_height;
 
-    string tx_hash_str = pod_to_hex(tx_hash);
+        return target;
+    }
 
-    uint64_t tx_blk_height {0};
+    // check if monero address is given based on its length
+    if (search_str_length == 95)
+    {
+        target.what = search_target::kind::address;
 
-    bool tx_blk_found {false};
+        if (search_text[0] == '9' || search_text[0] == 'A' || search_text[0] == 'B')
+            target.address_nettype = cryptonote::network_type::TESTNET;
+        if (search_text[0] == '5' || search_text[0] == '7')
+            target.address_nettype = cryptonote::network_type::STAGENET;
 
-    bool detailed_view {enable_mixins_details || static_cast<bool>(with_ring_signatures)};
+        if (!xmreg::parse_str_address(search_text, target.address_info,
+                                      target.address_nettype))
+        {
+            cerr << "Cant parse string address: " << search_text << endl;
+            target.what = search_target::kind::invalid_address;
+        }
 
-    if (core_storage->have_tx(tx_hash))
-    {
-        // currently get_tx_block_height seems to return a block hight
-        // +1. Before it was not like this.
-        tx_blk_height = core_storage->get_db().get_tx_block_height(tx_hash);
-        tx_blk_found = true;
+        return target;
     }
 
-    // get block cointaining this tx
-    block blk;
+    // check if integrated monero address is given based on its length
+    if (search_str_length == 106)
+    {
+        target.what = search_target::kind::integrated_address;
+        target.address_nettype = nettype;
 
-    if (tx_blk_found && !mcore->get_block_by_height(tx_blk_height, blk))
-    {
-        cerr << "Cant get block: " << tx_blk_height << endl;
+        if (!get_account_address_from_str(target.address_info,
+                                          nettype, search_text))
+        {
+            cerr << "Cant parse string integerated address: " << search_text << endl;
+            target.what = search_target::kind::invalid_address;
+        }
+
+        return target;
     }
 
-    string tx_blk_height_str {"N/A"};
+    return target;
+}
 
-    // tx age
-    pair<string, string> age;
 
-    string blk_timestamp {"N/A"};
+/**
+ * Decrypts key images exported from a wallet. Returns address
+ * stored in the export data and its key images with signatures.
+ */
+bool
+decrypt_raw_key_images(string const& decoded_raw_data,
+                       secret_key const& prv_view_key,
+                       address_parse_info& address_info,
+                       vector<crypto::key_image>& key_images,
+                       vector<crypto::signature>& signatures,
+                       string& error_msg)
+{
+    const size_t magiclen = strlen(KEY_IMAGE_EXPORT_FILE_MAGIC);
 
-    if (tx_blk_found)
+    if (strncmp(decoded_raw_data.c_str(), KEY_IMAGE_EXPORT_FILE_MAGIC, magiclen) != 0)
     {
-        // calculate difference between tx and server timestamps
-        age = get_age(server_timestamp, blk.timestamp, FULL_AGE_FORMAT);
-
-        blk_timestamp = xmreg::timestamp_to_str_gm(blk.timestamp);
-
-        tx_blk_height_str = std::to_string(tx_blk_height);
+        error_msg = "This does not seem to be key image export data.";
+        return false;
     }
 
-    // payments id. both normal and encrypted (payment_id8)
-    string pid_str   = pod_to_hex(txd.payment_id);
-    string pid8_str  = pod_to_hex(txd.payment_id8);
-
+    // decrypt key images data using private view key
+    string decrypted_data = xmreg::decrypt(
+            std::string(decoded_raw_data, magiclen),
+            prv_view_key, true);
 
-    string tx_json = obj_to_json_str(tx);
+    if (decrypted_data.empty())
+    {
+        error_msg = "Failed to authenticate key images data. "
+                    "Maybe wrong viewkey was porvided?";
+        return false;
+    }
 
-    double tx_size = static_cast<double>(txd.size) / 1024.0;
+    // header is public spend and keys
+    const size_t header_lenght = 2 * sizeof(crypto::public_key);
+    const size_t key_img_size  = sizeof(crypto::key_image);
+    const size_t record_lenght = key_img_size + sizeof(crypto::signature);
 
-    double payed_for_kB = XMR_AMOUNT(txd.fee) / tx_size;
+    if (decrypted_data.size() < header_lenght)
+    {
+        error_msg = "Bad data size from submitted key images raw data.";
+        return false;
+    }
 
-    // initalise page tempate map with basic info about blockchain
-    mstch::map context {
-            {"testnet"               , testnet},
-            {"stagenet"              , stagenet},
-            {"tx_hash"               , tx_hash_str},
-            {"tx_prefix_hash"        , string{}},
-            {"tx_pub_key"            , pod_to_hex(txd.pk)},
-            {"blk_height"            , tx_blk_height_str},
-            {"tx_blk_height"         , tx_blk_height},
-            {"tx_size"               , fmt::format("{:0.4f}", tx_size)},
-            {"tx_fee"                , xmreg::xmr_amount_to_str(txd.fee, "{:0.12f}", false)},
-            {"tx_fee_micro"          , xmreg::xmr_amount_to_str(txd.fee*1e6, "{:0.4f}", false)},
-            {"payed_for_kB"          , fmt::format("{:0.12f}", payed_for_kB)},
-            {"tx_version"            , static_cast<uint64_t>(txd.version)},
-            {"blk_timestamp"         , blk_timestamp},
-            {"blk_timestamp_uint"    , blk.timestamp},
-            {"delta_time"            , age.first},
-            {"inputs_no"             , static_cast<uint64_t>(txd.input_key_imgs.size())},
-            {"has_inputs"            , !txd.input_key_imgs.empty()},
-            {"outputs_no"            , static_cast<uint64_t>(txd.output_pub_keys.size())},
-            {"has_payment_id"        , txd.payment_id  != null_hash},
-            {"has_payment_id8"       , txd.payment_id8 != null_hash8},
-            {"confirmations"         , txd.no_confirmations},
-            {"payment_id"            , pid_str},
-            {"payment_id8"           , pid8_str},
-            {"extra"                 , txd.get_extra_str()},
-            {"with_ring_signatures"  , static_cast<bool>(
-                                               with_ring_signatures)},
-            {"tx_json"               , tx_json},
-            {"is_ringct"             , (tx.version > 1)},
-            {"rct_type"              , tx.rct_signatures.type},
-            {"has_error"             , false},
-            {"error_msg"             , string("")},
-            {"have_raw_tx"           , false},
-            {"show_more_details_link", true},
-            {"construction_time"     , string {}},
-    };
+    // get xmr address stored in this key image file
+    const account_public_address* xmr_address =
+            reinterpret_cast<const account_public_address*>(
+                    decrypted_data.data());
 
-    // append tx_json as in raw format to html
-    context["tx_json_raw"] = mstch::lambda{[=](const std::string& text) -> mstch::node {
-        return tx_json;
-    }};
+    address_info = address_parse_info {*xmr_address, false};
 
-    // append additional public tx keys, if there are any, to the html context
+    size_t no_key_images = (decrypted_data.size() - header_lenght) / record_lenght;
 
-    string add_tx_pub_keys;
+    key_images.resize(no_key_images);
+    signatures.resize(no_key_images);
 
-    for (auto const& apk: txd.additional_pks)
-        add_tx_pub_keys += pod_to_hex(apk) + ";";
+    for (size_t n = 0; n < no_key_images; ++n)
+    {
+        const char* record_ptr = decrypted_data.data() + header_lenght + n * record_lenght;
 
-    context["add_tx_pub_keys"] = add_tx_pub_keys;
+        memcpy(&key_images[n], record_ptr, key_img_size);
+        memcpy(&signatures[n], record_ptr + key_img_size, sizeof(crypto::signature));
+    }
 
-    string server_time_str = xmreg::timestamp_to_str_gm(server_timestamp, "%F");
+    return true;
+}
 
-    mstch::array inputs = mstch::array{};
+/**
+ * Checks spent status of key images. Large number of key images
+ * is split between executor's threads, each checking its part
+ * in one read transaction of lmdb.
+ */
+bool
+are_key_images_spent(vector<crypto::key_image> const& key_images,
+                     vector<bool>& spent)
+{
+    size_t no_of_parts = std::min<size_t>(
+            executor->get_no_of_threads(),
+            (key_images.size() + KEY_IMAGES_CHECK_BATCH_SIZE - 1)
+            / KEY_IMAGES_CHECK_BATCH_SIZE);
 
-    uint64_t input_idx {0};
+    if (no_of_parts <= 1)
+        return mcore->are_key_images_spent(key_images, spent);
 
-    uint64_t inputs_xmr_sum {0};
+    size_t part_size = (key_images.size() + no_of_parts - 1) / no_of_parts;
 
-    // ringct inputs can be mixture of known amounts (when old outputs)
-    // are spent, and unknown umounts (makrked in explorer by '?') when
-    // ringct outputs are spent. thus we totalling input amounts
-    // in such case, we need to show sum of known umounts, and
-    // indicate that this is minium sum, as we dont know the unknown
-    // umounts.
-    bool have_any_unknown_amount {false};
+    vector<vector<bool>> parts_spent(no_of_parts);
+    vector<std::future<bool>> parts;
 
-    uint64_t max_no_of_inputs_to_show {10};
+    for (size_t i = 0; i < no_of_parts; ++i)
+    {
+        size_t part_begin = std::min(i * part_size, key_images.size());
+        size_t part_end   = std::min(part_begin + part_size, key_images.size());
 
-    // if a tx has more inputs than max_no_of_inputs_to_show,
-    // we only show 10 first.
-    bool show_part_of_inputs = (txd.input_key_imgs.size() > max_no_of_inputs_to_show);
+        parts.push_back(executor->submit(
+                [this, &key_images, &parts_spent, i, part_begin, part_end]()
+        {
+            vector<crypto::key_image> part_key_images(
+                    key_images.begin() + part_begin,
+                    key_images.begin() + part_end);
 
-    // but if we show all details, i.e.,
-    // the show all inputs, regardless of their number
-    if (detailed_view)
-    {
-        show_part_of_inputs = false;
+            return mcore->are_key_images_spent(part_key_images, parts_spent[i]);
+        }));
     }
 
-    vector<vector<uint64_t>> mixin_timestamp_groups;
+    bool all_checked {true};
 
-    // make timescale maps for mixins in input
-    for (const txin_to_key &in_key: txd.input_key_imgs)
+    // parts refer to local variables, so we
+    // must wait for all of them
+    for (std::future<bool>& part: parts)
     {
-
-        if (show_part_of_inputs && (input_idx > max_no_of_inputs_to_show))
-            break;
-
-        // get absolute offsets of mixins
-        std::vector<uint64_t> absolute_offsets
-                = cryptonote::relative_output_offsets_to_absolute(
-                        in_key.key_offsets);
-
-        // get public keys of outputs used in the mixins that match to the offests
-        std::vector<cryptonote::output_data_t> outputs;
-
         try
         {
-            // before proceeding with geting the outputs based on the amount and absolute offset
-            // check how many outputs there are for that amount
-            // go to next input if a too large offset was found
-            if (are_absolute_offsets_good(absolute_offsets, in_key) == false)
-                continue;
-
-            // offsets seems good, so try to get the outputs for the amount and
-            // offsets given
-            //core_storage->get_db().get_output_key(in_key.amount,
-                                                  //absolute_offsets,
-                                                  //outputs);
-            
-            get_output_key<BlockchainDB>(in_key.amount,
-                                           absolute_offsets,
-                                           outputs);
+            all_checked &= part.get();
         }
-        catch (const std::exception& e)
+        catch (std::exception const& e)
         {
-            string out_msg = fmt::format(
-                    "Outputs with amount {:d} do not exist and indexes ",
-                    in_key.amount
-            );
+            cerr << "Checking key images failed: " << e.what() << endl;
+            all_checked = false;
+        }
+    }
 
-            for (auto offset: absolute_offsets)
-                out_msg += ", " + to_string(offset);
+    if (!all_checked)
+        return false;
 
-            out_msg += " don't exist! " + string {e.what()};
+    spent.clear();
+    spent.reserve(key_images.size());
 
-            cerr << out_msg << '\n';
+    for (vector<bool> const& part_spent: parts_spent)
+        spent.insert(spent.end(), part_spent.begin(), part_spent.end());
 
-            context["has_error"] = true;
-            context["error_msg"] = out_msg;
+    return true;
+}
 
-            return context;
-        }
 
-        inputs.push_back(mstch::map {
-                {"in_key_img"   , pod_to_hex(in_key.k_image)},
-                {"amount"       , xmreg::xmr_amount_to_str(in_key.amount)},
-                {"input_idx"    , fmt::format("{:02d}", input_idx)},
-                {"mixins"       , mstch::array{}},
-                {"ring_sigs"    , mstch::array{}},
-                {"already_spent", false} // placeholder for later
-        });
+string
+get_payment_id_as_string(
+        tx_details const& txd,
+        secret_key const& prv_view_key)
+{
+    string payment_id;
 
-        if (detailed_view)
+    // decrypt encrypted payment id, as used in integreated addresses
+    crypto::hash8 decrypted_payment_id8 = txd.payment_id8;
+
+    if (decrypted_payment_id8 != null_hash8)
+    {
+        if (mcore->get_device()->decrypt_payment_id(decrypted_payment_id8, txd.pk, prv_view_key))
         {
-            boost::get<mstch::map>(inputs.back())["ring_sigs"]
-                    = txd.get_ring_sig_for_input(input_idx);
+            payment_id = pod_to_hex(decrypted_payment_id8);
         }
+    }
+    else if(txd.payment_id != null_hash)
+    {
+        payment_id = pod_to_hex(txd.payment_id);
+    }
 
+    return payment_id;
+}
 
-        inputs_xmr_sum += in_key.amount;
+/**
+ * Scans given txs for outputs which belong to given address.
+ *
+ * Instead of building full tx_details for each tx, only tx public
+ * keys and output keys are used. Txs are split into batches which
+ * are scanned in parallel, by at most OUTPUTS_SCAN_MAX_THREADS
+ * threads. Scanning stops when the threads spend together more
+ * than cpu_budget on it, measured as cpu time of each thread,
+ * and only outputs from the txs before the first not scanned one
+ * are returned. no_of_scanned_txs tells how many of them it was.
+ */
+bool
+scan_txs_for_outputs(
+        account_public_address const& address,
+        secret_key const& prv_view_key,
+        vector<output_scan_tx> const& txs,
+        std::chrono::microseconds cpu_budget,
+        json& j_outptus,
+        uint64_t& no_of_scanned_txs,
+        string& error_msg)
+{
+    using boost::chrono::thread_clock;
+    using boost::chrono::microseconds;
+    using boost::chrono::duration_cast;
 
-        if (in_key.amount == 0)
-        {
-            // if any input has amount equal to zero,
-            // it is really an unkown amount
-            have_any_unknown_amount = true;
-        }
+    struct found_output
+    {
+        uint64_t output_idx;
+        public_key output_pubkey;
+        uint64_t amount;
+    };
 
-        vector<uint64_t> mixin_timestamps;
+    // outputs found in each tx, and if the tx was scanned
+    vector<vector<found_output>> found_outputs(txs.size());
+    vector<char> scanned(txs.size(), false);
 
-        // get reference to mixins array created above
-        mstch::array& mixins = boost::get<mstch::array>(
-                boost::get<mstch::map>(inputs.back())["mixins"]);
+    std::atomic<uint64_t> spent_us {0};
+    std::atomic<bool> failed {false};
 
-        // mixin counter
-        size_t count = 0;
+    // index of a tx which could not be scanned
+    std::atomic<size_t> failed_tx {0};
 
-        // for each found output public key find its block to get timestamp
-        for (const uint64_t& i: absolute_offsets)
+    auto scan_batch = [&](size_t batch_begin, size_t batch_end)
+    {
+        for (size_t i = batch_begin; i < batch_end; ++i)
         {
-            // get basic information about mixn's output
-            cryptonote::output_data_t output_data = outputs.at(count);
+            if (failed || spent_us > static_cast<uint64_t>(cpu_budget.count()))
+                return;
 
-            tx_out_index tx_out_idx;
-
-            try
-            {
-                // get pair pair<crypto::hash, uint64_t> where first is tx hash
-                // and second is local index of the output i in that tx
-                tx_out_idx = core_storage->get_db()
-                        .get_output_tx_and_index(in_key.amount, i);
-            }
-            catch (const OUTPUT_DNE &e)
-            {
+            thread_clock::time_point start_time = thread_clock::now();
 
-                string out_msg = fmt::format(
-                        "Output with amount {:d} and index {:d} does not exist!",
-                        in_key.amount, i
-                );
+            const transaction& tx = *txs[i].tx;
 
-                cerr << out_msg << endl;
+            public_key pk = xmreg::get_tx_pub_key_from_received_outs(tx);
+            vector<public_key> additional_pks
+                    = cryptonote::get_additional_tx_pub_keys_from_extra(tx);
 
-                context["has_error"] = true;
-                context["error_msg"] = out_msg;
+            // public transaction key is combined with our viewkey
+            // to create, so called, derived key.
+            key_derivation derivation;
 
-                return context;
+            if (!generate_key_derivation(pk, prv_view_key, derivation))
+            {
+                failed_tx = i;
+                failed = true;
+                return;
             }
 
+            vector<key_derivation> additional_derivations(additional_pks.size());
 
-            if (detailed_view)
+            for (size_t j = 0; j < additional_pks.size(); ++j)
             {
-                // get block of given height, as we want to get its timestamp
-                cryptonote::block blk;
-
-                if (!mcore->get_block_by_height(output_data.height, blk))
+                if (!generate_key_derivation(additional_pks[j], prv_view_key,
+                                             additional_derivations[j]))
                 {
-                    cerr << "- cant get block of height: " << output_data.height << endl;
-
-                    context["has_error"] = true;
-                    context["error_msg"] = fmt::format("- cant get block of height: {}",
-                                                       output_data.height);
+                    failed_tx = i;
+                    failed = true;
+                    return;
                 }
+            }
 
-                // get age of mixin relative to server time
-                pair<string, string> mixin_age = get_age(server_timestamp,
-                                                         blk.timestamp,
-                                                         FULL_AGE_FORMAT);
-                // get mixin transaction
-                transaction mixin_tx;
+            for (uint64_t output_idx = 0; output_idx < tx.vout.size(); ++output_idx)
+            {
+                const tx_out& txout = tx.vout[output_idx];
+
+                if (txout.target.type() != typeid(txout_to_key))
+                    continue;
+
+                const public_key& output_pubkey
+                        = boost::get<txout_to_key>(txout.target).key;
+
+                // get the tx output public key
+                // that normally would be generated for us,
+                // if someone had sent us some xmr.
+                public_key tx_pubkey;
+
+                derive_public_key(derivation,
+                                  output_idx,
+                                  address.m_spend_public_key,
+                                  tx_pubkey);
+
+                // check if generated public key matches the current output's key
+                bool mine_output = (output_pubkey == tx_pubkey);
+                bool with_additional = false;
 
-                if (!mcore->get_tx(tx_out_idx.first, mixin_tx))
+                if (!mine_output && additional_pks.size() == tx.vout.size())
                 {
-                    cerr << "Cant get tx: " << tx_out_idx.first << endl;
+                    derive_public_key(additional_derivations[output_idx],
+                                      output_idx,
+                                      address.m_spend_public_key,
+                                      tx_pubkey);
 
-                    context["has_error"] = true;
-                    context["error_msg"] = fmt::format("Cant get tx: {:s}", tx_out_idx.first);
+                    mine_output = (output_pubkey == tx_pubkey);
+                    with_additional = true;
                 }
 
-                // mixin tx details
-                tx_details mixin_txd = get_tx_details(mixin_tx, true);
+                if (!mine_output)
+                    continue;
 
-                mixins.push_back(mstch::map {
-                        {"mix_blk",        fmt::format("{:08d}", output_data.height)},
-                        {"mix_pub_key",    pod_to_hex(output_data.pubkey)},
-                        {"mix_tx_hash",    pod_to_hex(tx_out_idx.first)},
-                        {"mix_out_indx",   tx_out_idx.second},
-                        {"mix_timestamp",  xmreg::timestamp_to_str_gm(blk.timestamp)},
-                        {"mix_age",        mixin_age.first},
-                        {"mix_mixin_no",   mixin_txd.mixin_no},
-                        {"mix_inputs_no",  static_cast<uint64_t>(mixin_txd.input_key_imgs.size())},
-                        {"mix_outputs_no", static_cast<uint64_t>(mixin_txd.output_pub_keys.size())},
-                        {"mix_age_format", mixin_age.second},
-                        {"mix_idx",        fmt::format("{:02d}", count)},
-                        {"mix_is_it_real", false}, // a placeholder for future
-                });
+                uint64_t amount = txout.amount;
 
-                // get mixin timestamp from its orginal block
-                mixin_timestamps.push_back(blk.timestamp);
+                // cointbase txs have amounts in plain sight.
+                // so use amount from ringct, only for non-coinbase txs
+                if (tx.version == 2 && !is_coinbase(tx))
+                {
+                    rct::key mask = tx.rct_signatures.ecdhInfo[output_idx].mask;
+
+                    if (!decode_ringct(tx.rct_signatures,
+                                       with_additional
+                                       ? additional_derivations[output_idx]
+                                       : derivation,
+                                       output_idx,
+                                       mask,
+                                       amount))
+                    {
+                        failed_tx = i;
+                        failed = true;
+                        return;
+                    }
+                }
+
+                found_outputs[i].push_back({output_idx, output_pubkey, amount});
             }
-            else //  if (detailed_view)
-            {
-                mixins.push_back(mstch::map {
-                        {"mix_blk",        fmt::format("{:08d}", output_data.height)},
-                        {"mix_pub_key",    pod_to_hex(output_data.pubkey)},
-                        {"mix_idx",        fmt::format("{:02d}", count)},
-                        {"mix_is_it_real", false}, // a placeholder for future
-                });
 
-            } // else  if (enable_mixins_details)
+            scanned[i] = true;
 
-            ++count;
+            spent_us += duration_cast<microseconds>(
+                    thread_clock::now() - start_time).count();
+        }
+    };
 
-        } // for (const uint64_t &i: absolute_offsets)
+    // batches are taken in order, so if we run out of
+    // time, it is the last txs which are not scanned
+    size_t batch_size = std::max<size_t>(
+            (txs.size() + OUTPUTS_SCAN_MAX_THREADS - 1)
+            / OUTPUTS_SCAN_MAX_THREADS, 1);
 
-        mixin_timestamp_groups.push_back(mixin_timestamps);
+    batch_size = std::min<size_t>(batch_size, OUTPUTS_SCAN_BATCH_SIZE);
 
-        input_idx++;
+    size_t no_of_batches = (txs.size() + batch_size - 1) / batch_size;
 
-    } // for (const txin_to_key& in_key: txd.input_key_imgs)
+    executor->parallel_for(no_of_batches, OUTPUTS_SCAN_MAX_THREADS,
+            [&](size_t batch_no)
+    {
+        size_t batch_begin = batch_no * batch_size;
+        size_t batch_end   = std::min(batch_begin + batch_size, txs.size());
 
+        scan_batch(batch_begin, batch_end);
+    });
+
+    if (failed)
+    {
+        error_msg = "Cant calculate key_derivation or decode ringct for tx: "
+                    + pod_to_hex(get_transaction_hash(*txs[failed_tx].tx));
+        return false;
+    }
 
+    no_of_scanned_txs = 0;
 
-    if (detailed_view)
+    for (size_t i = 0; i < txs.size() && scanned[i]; ++i)
     {
-        uint64_t min_mix_timestamp {0};
-        uint64_t max_mix_timestamp {0};
+        ++no_of_scanned_txs;
 
-        pair<mstch::array, double> mixins_timescales
-                = construct_mstch_mixin_timescales(
-                        mixin_timestamp_groups,
-                        min_mix_timestamp,
-                        max_mix_timestamp
-                );
+        if (found_outputs[i].empty())
+            continue;
 
+        // full tx details only for the txs
+        // with our outputs, for its payment id
+        tx_details txd = get_tx_details(*txs[i].tx);
 
-        context["min_mix_time"]     = xmreg::timestamp_to_str_gm(min_mix_timestamp);
-        context["max_mix_time"]     = xmreg::timestamp_to_str_gm(max_mix_timestamp);
+        string payment_id_str = get_payment_id_as_string(txd, prv_view_key);
 
-        context.emplace("timescales", mixins_timescales.first);
+        for (const found_output& output: found_outputs[i])
+        {
+            j_outptus.push_back(json {
+                    {"output_pubkey" , pod_to_hex(output.output_pubkey)},
+                    {"amount"        , output.amount},
+                    {"block_no"      , txs[i].block_no},
+                    {"in_mempool"    , txs[i].is_mempool},
+                    {"output_idx"    , output.output_idx},
+                    {"tx_hash"       , pod_to_hex(txd.hash)},
+                    {"payment_id"    , payment_id_str}
+            });
+        }
+    }
 
+    return true;
+}
 
-        context["timescales_scale"] = fmt::format("{:0.2f}",
-                                                  mixins_timescales.second / 3600.0 / 24.0); // in days
+json
+get_tx_json(const transaction& tx, const tx_details& txd)
+{
 
-        context["tx_prefix_hash"] = pod_to_hex(get_transaction_prefix_hash(tx));
+    json j_tx {
+            {"tx_hash"     , pod_to_hex(txd.hash)},
+            {"tx_fee"      , txd.fee},
+            {"mixin"       , txd.mixin_no},
+            {"tx_size"     , txd.size},
+            {"xmr_outputs" , txd.xmr_outputs},
+            {"xmr_inputs"  , txd.xmr_inputs},
+            {"tx_version"  , static_cast<uint64_t>(txd.version)},
+            {"rct_type"    , tx.rct_signatures.type},
+            {"coinbase"    , is_coinbase(tx)},
+            {"mixin"       , txd.mixin_no},
+            {"extra"       , txd.get_extra_str()},
+            {"payment_id"  , (txd.payment_id  != null_hash  ? pod_to_hex(txd.payment_id)  : "")},
+            {"payment_id8" , (txd.payment_id8 != null_hash8 ? pod_to_hex(txd.payment_id8) : "")},
+    };
+
+    return j_tx;
+}
+
+
+bool
+find_tx(const crypto::hash& tx_hash,
+        transaction& tx,
+        bool& found_in_mempool,
+        uint64_t& tx_timestamp)
+{
+
+    found_in_mempool = false;
+
+    if (!mcore->get_tx(tx_hash, tx))
+    {
+        cerr << "Cant get tx in blockchain: " << tx_hash
+             << ". \n Check mempool now" << endl;
+
+        vector<MempoolStatus::mempool_tx_ptr> found_txs;
+
+        search_mempool(tx_hash, found_txs);
+
+        if (!found_txs.empty())
+        {
+            // there should be only one tx found
+            tx = found_txs.at(0)->tx;
+            found_in_mempool = true;
+            tx_timestamp = found_txs.at(0)->receive_time;
+        }
+        else
+        {
+            // tx is nowhere to be found :-(
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void
+mark_real_mixins_on_timescales(
+        const vector<uint64_t>& real_output_indices,
+        mstch::map& tx_context)
+{
+    // mark real mixing in the mixins timescale graph
+    mstch::array& mixins_timescales
+            = boost::get<mstch::array>(tx_context["timescales"]);
+
+    uint64_t idx {0};
+
+    for (mstch::node& timescale_node: mixins_timescales)
+    {
+
+        string& timescale = boost::get<string>(
+                boost::get<mstch::map>(timescale_node)["timescale"]
+        );
+
+        // claculated number of timescale points
+        // due to resolution, no of points might be lower than no of mixins
+        size_t no_points = std::count(timescale.begin(), timescale.end(), '*');
 
+        size_t point_to_find = real_output_indices.at(idx);
+
+        // adjust point to find based on total number of points
+        if (point_to_find >= no_points)
+            point_to_find = no_points  - 1;
+
+        boost::iterator_range<string::iterator> r
+                = boost::find_nth(timescale, "*", point_to_find);
+
+        *(r.begin()) = 'R';
+
+        ++idx;
     }
+}
 
+mstch::map
+construct_tx_context(transaction tx, uint16_t with_ring_signatures = 0)
+{
+    tx_details txd = get_tx_details(tx);
 
-    context["have_any_unknown_amount"]  = have_any_unknown_amount;
-    context["inputs_xmr_sum_not_zero"]  = (inputs_xmr_sum > 0);
-    context["inputs_xmr_sum"]           = xmreg::xmr_amount_to_str(inputs_xmr_sum);
-    context["server_time"]              = server_time_str;
-    context["enable_mixins_details"]    = detailed_view;
-    context["enable_as_hex"]            = enable_as_hex;
-    context["show_part_of_inputs"]      = show_part_of_inputs;
-    context["max_no_of_inputs_to_show"] = max_no_of_inputs_to_show;
+    const crypto::hash& tx_hash = txd.hash;
 
+    string tx_hash_str = pod_to_hex(tx_hash);
 
-    context.emplace("inputs", inputs);
+    uint64_t tx_blk_height {0};
 
-    // get indices of outputs in amounts tables
-    vector<uint64_t> out_amount_indices;
+    bool tx_blk_found {false};
 
-    try
+    bool detailed_view {enable_mixins_details || static_cast<bool>(with_ring_signatures)};
+
+    if (core_storage->have_tx(tx_hash))
+    {
+        // currently get_tx_block_height seems to return a block hight
+        // +1. Before it was not like this.
+        tx_blk_height = core_storage->get_db().get_tx_block_height(tx_hash);
+        tx_blk_found = true;
+    }
+
+    // get block cointaining this tx
+    block blk;
+
+    if (tx_blk_found && !mcore->get_block_by_height(tx_blk_height, blk))
+    {
+        cerr << "Cant get block: " << tx_blk_height << endl;
+    }
+
+    string tx_blk_height_str {"N/A"};
+
+    // tx age
+    pair<string, string> age;
+
+    string blk_timestamp {"N/A"};
+
+    if (tx_blk_found)
     {
+        // calculate difference between tx and server timestamps
+        age = get_age(server_timestamp, blk.timestamp, FULL_AGE_FORMAT);
+
+        blk_timestamp = xmreg::timestamp_to_str_gm(blk.timestamp);
+
+        tx_blk_height_str = std::to_string(tx_blk_height);
+    }
+
+    // payments id. both normal and encrypted (payment_id8)
+    string pid_str   = pod_to_hex(txd.payment_id);
+    string pid8_str  = pod_to_hex(txd.payment_id8);
+
+
+    // json of the tx is shown only with ring signatures
+    string tx_json;
+
+    if (with_ring_signatures)
+        write_tx_json(tx, tx_json, true);
+
+    double tx_size = static_cast<double>(txd.size) / 1024.0;
+
+    double payed_for_kB = XMR_AMOUNT(txd.fee) / tx_size;
+
+    // initalise page tempate map with basic info about blockchain
+    mstch::map context {
+            {"testnet"               , testnet},
+            {"stagenet"              , stagenet},
+            {"tx_hash"               , tx_hash_str},
+            {"tx_prefix_hash"        , string{}},
+            {"tx_pub_key"            , pod_to_hex(txd.pk)},
+            {"blk_height"            , tx_blk_height_str},
+            {"tx_blk_height"         , tx_blk_height},
+            {"tx_size"               , fmt::format("{:0.4f}", tx_size)},
+            {"tx_fee"                , xmreg::xmr_amount_to_str(txd.fee, "{:0.12f}", false)},
+            {"tx_fee_micro"          , xmreg::xmr_amount_to_str(txd.fee*1e6, "{:0.4f}", false)},
+            {"payed_for_kB"          , fmt::format("{:0.12f}", payed_for_kB)},
+            {"tx_version"            , static_cast<uint64_t>(txd.version)},
+            {"blk_timestamp"         , blk_timestamp},
+            {"blk_timestamp_uint"    , blk.timestamp},
+            {"delta_time"            , age.first},
+            {"inputs_no"             , static_cast<uint64_t>(txd.input_key_imgs.size())},
+            {"has_inputs"            , !txd.input_key_imgs.empty()},
+            {"outputs_no"            , static_cast<uint64_t>(txd.output_pub_keys.size())},
+            {"has_payment_id"        , txd.payment_id  != null_hash},
+            {"has_payment_id8"       , txd.payment_id8 != null_hash8},
+            {"confirmations"         , txd.no_confirmations},
+            {"payment_id"            , pid_str},
+            {"payment_id8"           , pid8_str},
+            {"extra"                 , txd.get_extra_str()},
+            {"with_ring_signatures"  , static_cast<bool>(
+                                               with_ring_signatures)},
+            {"tx_json"               , tx_json},
+            {"is_ringct"             , (tx.version > 1)},
+            {"rct_type"              , tx.rct_signatures.type},
+            {"has_error"             , false},
+            {"error_msg"             , string("")},
+            {"have_raw_tx"           , false},
+            {"show_more_details_link", true},
+            {"construction_time"     , string {}},
+    };
+
+    // append tx_json as in raw format to html
+    context["tx_json_raw"] = mstch::lambda{[=](const std::string& text) -> mstch::node {
+        return tx_json;
+    }};
+
+    // append additional public tx keys, if there are any, to the html context
+
+    string add_tx_pub_keys;
+
+    add_tx_pub_keys.reserve(txd.additional_pks.size() * (2 * sizeof(public_key) + 1));
+
+    for (auto const& apk: txd.additional_pks)
+    {
+        char apk_hex[2 * sizeof(public_key)];
+
+        pod_to_hex(apk, apk_hex);
+
+        add_tx_pub_keys.append(apk_hex, sizeof(apk_hex)).append(1, ';');
+    }
+
+    context["add_tx_pub_keys"] = add_tx_pub_keys;
+
+    string server_time_str = xmreg::timestamp_to_str_gm(server_timestamp, "%F");
+
+    mstch::array inputs = mstch::array{};
+
+    uint64_t input_idx {0};
+
+    uint64_t inputs_xmr_sum {0};
+
+    // ringct inputs can be mixture of known amounts (when old outputs)
+    // are spent, and unknown umounts (makrked in explorer by '?') when
+    // ringct outputs are spent. thus we totalling input amounts
+    // in such case, we need to show sum of known umounts, and
+    // indicate that this is minium sum, as we dont know the unknown
+    // umounts.
+    bool have_any_unknown_amount {false};
+
+    uint64_t max_no_of_inputs_to_show {10};
+
+    // if a tx has more inputs than max_no_of_inputs_to_show,
+    // we only show 10 first.
+    bool show_part_of_inputs = (txd.input_key_imgs.size() > max_no_of_inputs_to_show);
+
+    // but if we show all details, i.e.,
+    // the show all inputs, regardless of their number
+    if (detailed_view)
+    {
+        show_part_of_inputs = false;
+    }
+
+    vector<vector<uint64_t>> mixin_timestamp_groups;
+
+    // make timescale maps for mixins in input
+    for (const txin_to_key &in_key: txd.input_key_imgs)
+    {
+
+        if (show_part_of_inputs && (input_idx > max_no_of_inputs_to_show))
+            break;
+
+        // get absolute offsets of mixins
+        std::vector<uint64_t> absolute_offsets
+                = cryptonote::relative_output_offsets_to_absolute(
+                        in_key.key_offsets);
+
+        // get public keys of outputs used in the mixins that match to the offests
+        std::vector<cryptonote::output_data_t> outputs;
+
+        try
+        {
+            // before proceeding with geting the outputs based on the amount and absolute offset
+            // check how many outputs there are for that amount
+            // go to next input if a too large offset was found
+            if (are_absolute_offsets_good(absolute_offsets, in_key) == false)
+                continue;
+
+            // offsets seems good, so try to get the outputs for the amount and
+            // offsets given
+            //core_storage->get_db().get_output_key(in_key.amount,
+                                                  //absolute_offsets,
+                                                  //outputs);
+            
+            get_output_key<BlockchainDB>(in_key.amount,
+                                           absolute_offsets,
+                                           outputs);
+        }
+        catch (const std::exception& e)
+        {
+            string out_msg = fmt::format(
+                    "Outputs with amount {:d} do not exist and indexes ",
+                    in_key.amount
+            );
+
+            for (auto offset: absolute_offsets)
+                out_msg += ", " + to_string(offset);
+
+            out_msg += " don't exist! " + string {e.what()};
+
+            cerr << out_msg << '\n';
+
+            context["has_error"] = true;
+            context["error_msg"] = out_msg;
+
+            return context;
+        }
+
+        inputs.push_back(mstch::map {
+                {"in_key_img"   , pod_to_hex(in_key.k_image)},
+                {"amount"       , xmreg::xmr_amount_to_str(in_key.amount)},
+                {"input_idx"    , fmt::format("{:02d}", input_idx)},
+                {"mixins"       , mstch::array{}},
+                {"ring_sigs"    , mstch::array{}},
+                {"already_spent", false} // placeholder for later
+        });
+
+        if (detailed_view)
+        {
+            boost::get<mstch::map>(inputs.back())["ring_sigs"]
+                    = txd.get_ring_sig_for_input(input_idx);
+        }
+
+
+        inputs_xmr_sum += in_key.amount;
+
+        if (in_key.amount == 0)
+        {
+            // if any input has amount equal to zero,
+            // it is really an unkown amount
+            have_any_unknown_amount = true;
+        }
+
+        vector<uint64_t> mixin_timestamps;
+
+        // get reference to mixins array created above
+        mstch::array& mixins = boost::get<mstch::array>(
+                boost::get<mstch::map>(inputs.back())["mixins"]);
+
+        // mixin counter
+        size_t count = 0;
+
+        // for each found output public key find its block to get timestamp
+        for (const uint64_t& i: absolute_offsets)
+        {
+            // get basic information about mixn's output
+            cryptonote::output_data_t output_data = outputs.at(count);
+
+            if (detailed_view)
+            {
+                ring_member member;
+
+                string error_msg;
+
+                if (!get_ring_member(in_key.amount, i, output_data,
+                                     member, error_msg))
+                {
+                    cerr << error_msg << endl;
+
+                    context["has_error"] = true;
+                    context["error_msg"] = error_msg;
+
+                    return context;
+                }
+
+                // get age of mixin relative to server time
+                pair<string, string> mixin_age = get_age(server_timestamp,
+                                                         member.timestamp,
+                                                         FULL_AGE_FORMAT);
+
+                mixins.push_back(mstch::map {
+                        {"mix_blk",        fmt::format("{:08d}", output_data.height)},
+                        {"mix_pub_key",    pod_to_hex(output_data.pubkey)},
+                        {"mix_tx_hash",    pod_to_hex(member.tx_hash)},
+                        {"mix_out_indx",   member.out_idx},
+                        {"mix_timestamp",  xmreg::timestamp_to_str_gm(member.timestamp)},
+                        {"mix_age",        mixin_age.first},
+                        {"mix_mixin_no",   member.mixin_no},
+                        {"mix_inputs_no",  member.no_of_inputs},
+                        {"mix_outputs_no", member.no_of_outputs},
+                        {"mix_age_format", mixin_age.second},
+                        {"mix_idx",        fmt::format("{:02d}", count)},
+                        {"mix_is_it_real", false}, // a placeholder for future
+                });
+
+                // get mixin timestamp from its orginal block
+                mixin_timestamps.push_back(member.timestamp);
+            }
+            else //  if (detailed_view)
+            {
+                try
+                {
+                    // check if the output really exists
+                    core_storage->get_db()
+                            .get_output_tx_and_index(in_key.amount, i);
+                }
+                catch (const OUTPUT_DNE &e)
+                {
+
+                    string out_msg = fmt::format(
+                            "Output with amount {:d} and index {:d} does not exist!",
+                            in_key.amount, i
+                    );
+
+                    cerr << out_msg << endl;
+
+                    context["has_error"] = true;
+                    context["error_msg"] = out_msg;
+
+                    return context;
+                }
+
+                mixins.push_back(mstch::map {
+                        {"mix_blk",        fmt::format("{:08d}", output_data.height)},
+                        {"mix_pub_key",    pod_to_hex(output_data.pubkey)},
+                        {"mix_idx",        fmt::format("{:02d}", count)},
+                        {"mix_is_it_real", false}, // a placeholder for future
+                });
+
+            } // else  if (enable_mixins_details)
+
+            ++count;
+
+        } // for (const uint64_t &i: absolute_offsets)
+
+        mixin_timestamp_groups.push_back(mixin_timestamps);
+
+        input_idx++;
+
+    } // for (const txin_to_key& in_key: txd.input_key_imgs)
+
+
+
+    if (detailed_view)
+    {
+        uint64_t min_mix_timestamp {0};
+        uint64_t max_mix_timestamp {0};
+
+        pair<mstch::array, double> mixins_timescales
+                = construct_mstch_mixin_timescales(
+                        mixin_timestamp_groups,
+                        min_mix_timestamp,
+                        max_mix_timestamp
+                );
+
+
+        context["min_mix_time"]     = xmreg::timestamp_to_str_gm(min_mix_timestamp);
+        context["max_mix_time"]     = xmreg::timestamp_to_str_gm(max_mix_timestamp);
+
+        context.emplace("timescales", mixins_timescales.first);
+
+
+        context["timescales_scale"] = fmt::format("{:0.2f}",
+                                                  mixins_timescales.second / 3600.0 / 24.0); // in days
+
+        context["tx_prefix_hash"] = pod_to_hex(get_transaction_prefix_hash(tx));
+
+    }
+
+
+    context["have_any_unknown_amount"]  = have_any_unknown_amount;
+    context["inputs_xmr_sum_not_zero"]  = (inputs_xmr_sum > 0);
+    context["inputs_xmr_sum"]           = xmreg::xmr_amount_to_str(inputs_xmr_sum);
+    context["server_time"]              = server_time_str;
+    context["enable_mixins_details"]    = detailed_view;
+    context["enable_as_hex"]            = enable_as_hex;
+    context["show_part_of_inputs"]      = show_part_of_inputs;
+    context["max_no_of_inputs_to_show"] = max_no_of_inputs_to_show;
+
+
+    context.emplace("inputs", inputs);
+
+    // get indices of outputs in amounts tables
+    vector<uint64_t> out_amount_indices;
+
+    try
+    {
+
+        uint64_t tx_index;
+
+        if (core_storage->get_db().tx_exists(txd.hash, tx_index))
+        {
+            //out_amount_indices = core_storage->get_db()
+                    //.get_tx_amount_output_indices(tx_index).front();
+            get_tx_amount_output_indices<BlockchainDB>(
+                   out_amount_indices, 
+                   tx_index);
+        }
+        else
+        {
+            cerr << "get_tx_outputs_gindexs failed to find transaction with id = " << txd.hash;
+        }
+
+    }
+    catch(const exception& e)
+    {
+        cerr << e.what() << endl;
+    }
+
+    uint64_t output_idx {0};
+
+    mstch::array outputs;
+
+    uint64_t outputs_xmr_sum {0};
+
+    for (pair<txout_to_key, uint64_t>& outp: txd.output_pub_keys)
+    {
+
+        // total number of ouputs in the blockchain for this amount
+        uint64_t num_outputs_amount = core_storage->get_db()
+                .get_num_outputs(outp.second);
+
+        string out_amount_index_str {"N/A"};
+
+        // outputs in tx in them mempool dont have yet global indices
+        // thus for them, we print N/A
+        if (!out_amount_indices.empty())
+        {
+            out_amount_index_str
+                    = std::to_string(out_amount_indices.at(output_idx));
+        }
+
+        outputs_xmr_sum += outp.second;
+
+        outputs.push_back(mstch::map {
+                {"out_pub_key"           , pod_to_hex(outp.first.key)},
+                {"amount"                , xmreg::xmr_amount_to_str(outp.second)},
+                {"amount_idx"            , out_amount_index_str},
+                {"num_outputs"           , num_outputs_amount},
+                {"unformated_output_idx" , output_idx},
+                {"output_idx"            , fmt::format("{:02d}", output_idx++)}
+        });
+
+    } //  for (pair<txout_to_key, uint64_t>& outp: txd.output_pub_keys)
+
+    context["outputs_xmr_sum"] = xmreg::xmr_amount_to_str(outputs_xmr_sum);
+
+    context.emplace("outputs", outputs);
+
+
+    return context;
+}
+
+pair<mstch::array, double>
+construct_mstch_mixin_timescales(
+        const vector<vector<uint64_t>>& mixin_timestamp_groups,
+        uint64_t& min_mix_timestamp,
+        uint64_t& max_mix_timestamp
+)
+{
+    mstch::array mixins_timescales;
+
+    double timescale_scale {0.0};     // size of one '_' in days
+
+    // initialize with some large and some numbers
+    min_mix_timestamp = server_timestamp*2L;
+    max_mix_timestamp = 0;
+
+    // find min and maximum timestamps
+    for (const vector<uint64_t>& mixn_timestamps : mixin_timestamp_groups)
+    {
+
+        uint64_t min_found = *min_element(mixn_timestamps.begin(), mixn_timestamps.end());
+        uint64_t max_found = *max_element(mixn_timestamps.begin(), mixn_timestamps.end());
+
+        if (min_found < min_mix_timestamp)
+            min_mix_timestamp = min_found;
+
+        if (max_found > max_mix_timestamp)
+            max_mix_timestamp = max_found;
+    }
+
+
+    min_mix_timestamp -= 3600;
+    max_mix_timestamp += 3600;
+
+    // make timescale maps for mixins in input with adjusted range
+    for (auto& mixn_timestamps : mixin_timestamp_groups)
+    {
+        // get mixins in time scale for visual representation
+        pair<string, double> mixin_times_scale = xmreg::timestamps_time_scale(
+                mixn_timestamps,
+                max_mix_timestamp,
+                170,
+                min_mix_timestamp);
+
+        // save resolution of mixin timescales
+        timescale_scale = mixin_times_scale.second;
+
+        // save the string timescales for later to show
+        mixins_timescales.push_back(mstch::map {
+                {"timescale", mixin_times_scale.first}
+        });
+    }
+
+    return make_pair(mixins_timescales, timescale_scale);
+}
+
+
+tx_details
+get_tx_details(const transaction& tx,
+               bool coinbase = false,
+               uint64_t blk_height = 0,
+               uint64_t bc_height = 0)
+{
+    tx_details txd;
+
+    // get tx hash
+    
+    if (!tx.pruned)
+    {
+        txd.hash = get_transaction_hash(tx);
+    }
+    else
+    {
+        txd.hash = get_pruned_transaction_hash(tx, tx.prunable_hash);
+    }
+
+    // get tx public key from extra
+    // this check if there are two public keys
+    // due to previous bug with sining txs:
+    // https://github.com/monero-project/monero/pull/1358/commits/7abfc5474c0f86e16c405f154570310468b635c2
+    txd.pk = xmreg::get_tx_pub_key_from_received_outs(tx);
+    txd.additional_pks = cryptonote::get_additional_tx_pub_keys_from_extra(tx);
+
+
+    // sum xmr in inputs and ouputs in the given tx
+    const array<uint64_t, 4>& sum_data = summary_of_in_out_rct(
+            tx, txd.output_pub_keys, txd.input_key_imgs);
+
+    txd.xmr_outputs       = sum_data[0];
+    txd.xmr_inputs        = sum_data[1];
+    txd.mixin_no          = sum_data[2];
+    txd.num_nonrct_inputs = sum_data[3];
+
+    txd.fee = 0;
+
+    if (!coinbase &&  tx.vin.size() > 0)
+    {
+        // check if not miner tx
+        // i.e., for blocks without any user transactions
+        if (tx.vin.at(0).type() != typeid(txin_gen))
+        {
+            // get tx fee
+            txd.fee = get_tx_fee(tx);
+        }
+    }
+
+    get_payment_id(tx, txd.payment_id, txd.payment_id8);
+
+    // get tx size in bytes
+    txd.size = get_object_blobsize(tx);
+
+    txd.extra = tx.extra;
+
+    // get tx signatures for each input
+    txd.signatures = tx.signatures;
+
+    // get tx version
+    txd.version = tx.version;
+
+    // get unlock time
+    txd.unlock_time = tx.unlock_time;
+
+    txd.no_confirmations = 0;
+
+    if (blk_height == 0 && core_storage->have_tx(txd.hash))
+    {
+        // if blk_height is zero then search for tx block in
+        // the blockchain. but since often block height is know a priory
+        // this is not needed
+
+        txd.blk_height = core_storage->get_db().get_tx_block_height(txd.hash);
+
+        // get the current blockchain height. Just to check
+        uint64_t bc_height = core_storage->get_current_blockchain_height();
+
+        txd.no_confirmations = bc_height - (txd.blk_height);
+    }
+    else
+    {
+        // if we know blk_height, and current blockchan height
+        // just use it to get no_confirmations.
+
+        txd.no_confirmations = bc_height - (blk_height);
+    }
+
+    return txd;
+}
+
+/**
+ * Prepare index page context, i.e., txs in the last blocks,
+ * network info and emission. Ages are not set here, as they
+ * change with time. Use set_index_ages for that.
+ *
+ * @param block_rows index of the first tx row of each block
+ *                   in context["txs"] and block's timestamp
+ */
+mstch::map
+get_index_context(uint64_t page_no,
+                  bool refresh_page,
+                  uint64_t height,
+                  MempoolStatus::network_info const& current_network_info,
+                  vector<pair<size_t, uint64_t>>& block_rows)
+{
+    // number of last blocks to show
+    uint64_t no_of_last_blocks = std::min(no_blocks_on_index + 1, height);
+
+    // initalise page tempate map with basic info about blockchain
+    mstch::map context {
+            {"testnet"                  , testnet},
+            {"stagenet"                 , stagenet},
+            {"testnet_url"              , testnet_url},
+            {"stagenet_url"             , stagenet_url},
+            {"mainnet_url"              , mainnet_url},
+            {"refresh"                  , refresh_page},
+            {"height"                   , height},
+            {"server_timestamp"         , string {}},
+            {"age_format"               , string("[h:m:d]")},
+            {"page_no"                  , page_no},
+            {"total_page_no"            , (height / no_of_last_blocks)},
+            {"is_page_zero"             , !bool(page_no)},
+            {"no_of_last_blocks"        , no_of_last_blocks},
+            {"next_page"                , (page_no + 1)},
+            {"prev_page"                , (page_no > 0 ? page_no - 1 : 0)},
+            {"enable_pusher"            , enable_pusher},
+            {"enable_key_image_checker" , enable_key_image_checker},
+            {"enable_output_key_checker", enable_output_key_checker},
+            {"enable_autorefresh_option", enable_autorefresh_option}
+    };
+
+    context.emplace("txs", mstch::array()); // will keep tx to show
+
+    // get reference to txs mstch map to be field below
+    mstch::array& txs = boost::get<mstch::array>(context["txs"]);
+
+    // calculate starting and ending block numbers to show
+    int64_t start_height = height - no_of_last_blocks * (page_no + 1);
+
+    // check if start height is not below range
+    start_height = start_height < 0 ? 0 : start_height;
+
+    int64_t end_height = start_height + no_of_last_blocks - 1;
+
+    vector<double> blk_sizes;
+
+    // get decoded blocks from the cache, or
+    // decode them now if not there yet
+    vector<shared_ptr<const block_summary>> blk_summaries
+            = get_block_summaries(start_height, end_height, height);
+
+    // loop index
+    int64_t i = end_height;
+
+    // iterate over last no_of_last_blocks of blocks
+    for (shared_ptr<const block_summary> const& blk_summary: blk_summaries)
+    {
+        if (!blk_summary)
+        {
+            --i;
+            continue;
+        }
+
+        // get block size in kB
+        double blk_size = static_cast<double>(blk_summary->weight)/1024.0;
+
+        blk_sizes.push_back(blk_size);
+
+        block_rows.emplace_back(txs.size(), blk_summary->timestamp);
+
+        // copy cached tx rows into txs array, that will go
+        // to templates.
+        for (const mstch::map& tx_row: blk_summary->tx_rows)
+        {
+            txs.push_back(tx_row);
+
+            boost::get<mstch::map>(txs.back())["confirmations"] = height - i;
+        }
+
+        --i; // go to next block number
+
+    } // for (shared_ptr<const block_summary> const& blk_summary: blk_summaries)
+
+    // calculate median size of the blocks shown
+    //double blk_size_median = xmreg::calc_median(blk_sizes.begin(), blk_sizes.end());
+
+    // perapre network info mstch::map for the front page
+    string hash_rate;
+
+    double hr_d;
+    char metric_prefix;
+
+    cryptonote::difficulty_type hr = make_difficulty(
+            current_network_info.hash_rate,
+            current_network_info.hash_rate_top64);
+
+    get_metric_prefix(hr, hr_d, metric_prefix);
+
+    if (metric_prefix != 0)
+        hash_rate = fmt::format("{:0.3f} {:c}H/s", hr_d, metric_prefix);
+    else
+        hash_rate = fmt::format("{:s} H/s", hr.str());
+
+    context["network_info"] = mstch::map {
+            {"difficulty"        , current_network_info.difficulty},
+            {"hash_rate"         , hash_rate},
+            {"fee_per_kb"        , print_money(current_network_info.fee_per_kb)},
+            {"alt_blocks_no"     , current_network_info.alt_blocks_count},
+            {"have_alt_block"    , (current_network_info.alt_blocks_count > 0)},
+            {"tx_pool_size"      , current_network_info.tx_pool_size},
+            {"block_size_limit"  , string {current_network_info.block_size_limit_str}},
+            {"block_size_median" , string {current_network_info.block_size_median_str}},
+            {"is_current_info"   , current_network_info.current},
+            {"is_pool_size_zero" , (current_network_info.tx_pool_size == 0)},
+            {"current_hf_version", current_network_info.current_hf_version},
+            {"age"               , string {}},
+            {"age_format"        , string {}},
+    };
+
+    // median size of 100 blocks
+    context["blk_size_median"] = string {current_network_info.block_size_median_str};
+
+    if (CurrentBlockchainStatus::is_thread_running())
+    {
+        CurrentBlockchainStatus::Emission current_values
+                = CurrentBlockchainStatus::get_emission();
+
+        string emission_blk_no   = std::to_string(current_values.blk_no - 1);
+        string emission_coinbase = xmr_amount_to_str(current_values.coinbase, "{:0.3f}");
+        string emission_fee      = xmr_amount_to_str(current_values.fee, "{:0.3f}");
+
+        context["emission"] = mstch::map {
+                {"blk_no"    , emission_blk_no},
+                {"amount"    , emission_coinbase},
+                {"fee_amount", emission_fee}
+        };
+    }
+    else
+    {
+        cerr  << "emission thread not running, skipping." << endl;
+    }
+
+    add_css_style(context);
+
+    return context;
+}
+
+/**
+ * Set age of blocks, network info and server time
+ * in the index page context
+ */
+void
+set_index_ages(mstch::map& context,
+               vector<pair<size_t, uint64_t>> const& block_rows,
+               MempoolStatus::network_info current_network_info,
+               uint64_t timestamp)
+{
+    context["server_timestamp"] = xmreg::timestamp_to_str_gm(timestamp);
+
+    mstch::array& txs = boost::get<mstch::array>(context["txs"]);
+
+    // only the first tx in a block shows its age
+    for (pair<size_t, uint64_t> const& block_row: block_rows)
+    {
+        pair<string, string> age = get_age(timestamp, block_row.second);
+
+        boost::get<mstch::map>(txs.at(block_row.first))["age"] = age.first;
+
+        context["age_format"] = age.second;
+    }
+
+    pair<string, string> network_info_age = get_age(timestamp,
+                                                    current_network_info.info_timestamp);
+
+    // if network info is younger than 2 minute, assume its current. No sense
+    // showing that it is not current if its less then block time.
+    if (timestamp - current_network_info.info_timestamp < 120)
+    {
+        current_network_info.current = true;
+    }
+
+    mstch::map& network_info = boost::get<mstch::map>(context["network_info"]);
+
+    network_info["is_current_info"] = current_network_info.current;
+    network_info["age"]             = network_info_age.first;
+    network_info["age_format"]      = network_info_age.second;
+}
+
+/**
+ * Prepare mempool context. Ages of txs are not set here,
+ * use set_mempool_ages for that.
+ */
+mstch::map
+get_mempool_context(bool add_header_and_footer, uint64_t no_of_mempool_tx)
+{
+    // current mempool snapshot, no txs are copied here
+    std::shared_ptr<const MempoolStatus::mempool_snapshot> mempool
+            = MempoolStatus::get_mempool_snapshot();
+
+    const vector<MempoolStatus::mempool_tx_ptr>& mempool_txs = mempool->txs;
+
+    if (add_header_and_footer)
+    {
+        // show all memmpool txs
+        no_of_mempool_tx = mempool_txs.size();
+    }
+    else
+    {
+        // show only first no_of_mempool_tx txs
+        no_of_mempool_tx = std::min<uint64_t>(no_of_mempool_tx, mempool_txs.size());
+    }
+
+    // total size of mempool in bytes
+    uint64_t mempool_size_bytes = MempoolStatus::mempool_size;
+
+    // reasign this number, in case no of txs in mempool is smaller
+    // than what we requested or we want all txs.
+
+
+    uint64_t total_no_of_mempool_tx = mempool_txs.size();
+
+    // initalise page tempate map with basic info about mempool
+    mstch::map context {
+            {"mempool_size"          , static_cast<uint64_t>(total_no_of_mempool_tx)}, // total no of mempool txs
+            {"mempool_refresh_time"  , MempoolStatus::mempool_refresh_time}
+    };
+
+    context.emplace("mempooltxs" , mstch::array());
+
+    // get reference to blocks template map to be field below
+    mstch::array& txs = boost::get<mstch::array>(context["mempooltxs"]);
+
+    // for each transaction in the memory pool
+    for (size_t i = 0; i < no_of_mempool_tx; ++i)
+    {
+        // get transaction info of the tx in the mempool
+        const MempoolStatus::mempool_tx& mempool_tx = *mempool_txs.at(i);
+
+        // set output page template map
+        txs.push_back(mstch::map {
+                {"timestamp_no"    , mempool_tx.receive_time},
+                {"timestamp"       , mempool_tx.timestamp_str},
+                {"age"             , string {}},
+                {"hash"            , pod_to_hex(mempool_tx.tx_hash)},
+                {"fee"             , mempool_tx.fee_micro_str},
+                {"payed_for_kB"    , mempool_tx.payed_for_kB_micro_str},
+                {"xmr_inputs"      , mempool_tx.xmr_inputs_str},
+                {"xmr_outputs"     , mempool_tx.xmr_outputs_str},
+                {"no_inputs"       , mempool_tx.no_inputs},
+                {"no_outputs"      , mempool_tx.no_outputs},
+                {"no_nonrct_inputs", mempool_tx.num_nonrct_inputs},
+                {"mixin"           , mempool_tx.mixin_no},
+                {"txsize"          , mempool_tx.txsize}
+        });
+    }
+
+    context.insert({"mempool_size_kB",
+                    fmt::format("{:0.2f}",
+                                static_cast<double>(mempool_size_bytes)/1024.0)});
+
+    if (add_header_and_footer)
+    {
+        // this is when mempool is on its own page, /mempool
+        add_css_style(context);
+
+        context["partial_mempool_shown"] = false;
+
+        return context;
+    }
+
+    // this is for partial disply on front page.
+
+    context["mempool_fits_on_front_page"]    = (total_no_of_mempool_tx <= no_of_mempool_tx);
+    context["no_of_mempool_tx_of_frontpage"] = no_of_mempool_tx;
+
+    context["partial_mempool_shown"] = true;
+
+    return context;
+}
+
+/**
+ * Set age of txs in mempool context
+ */
+void
+set_mempool_ages(mstch::map& context, uint64_t timestamp)
+{
+    mstch::array& txs = boost::get<mstch::array>(context["mempooltxs"]);
+
+    for (mstch::node& tx_node: txs)
+    {
+        mstch::map& tx_map = boost::get<mstch::map>(tx_node);
+
+        // calculate difference between tx in mempool and server timestamps
+        array<size_t, 5> delta_time = timestamp_difference(
+                timestamp,
+                boost::get<uint64_t>(tx_map["timestamp_no"]));
+
+        // use only hours, so if we have days, add
+        // it to hours
+        uint64_t delta_hours {delta_time[1]*24 + delta_time[2]};
+
+        string age_str = fmt::format("{:02d}:{:02d}:{:02d}",
+                                     delta_hours,
+                                     delta_time[3], delta_time[4]);
+
+        // if more than 99 hourse, change formating
+        // for the template
+        if (delta_hours > 99)
+        {
+            age_str = fmt::format("{:03d}:{:02d}:{:02d}",
+                                  delta_hours,
+                                  delta_time[3], delta_time[4]);
+        }
+
+        tx_map["age"] = age_str;
+    }
+}
+
+/**
+ * Prepare front page context in advance, for
+ * the index snapshot thread
+ */
+shared_ptr<const index_snapshot>
+make_index_snapshot()
+{
+    shared_ptr<index_snapshot> snapshot = make_shared<index_snapshot>();
+
+    // read these before making the context. if they change
+    // in the meantime, the snapshot will just be made again.
+    ChainTipWatcher::chain_tip tip = ChainTipWatcher::get_chain_tip();
+
+    snapshot->chain_generation   = tip.generation;
+    snapshot->height             = tip.height;
+    snapshot->mempool_generation = MempoolStatus::mempool_generation;
+    snapshot->network_info       = MempoolStatus::current_network_info;
+
+    if (CurrentBlockchainStatus::is_thread_running())
+        snapshot->emission_blk_no = CurrentBlockchainStatus::get_emission().blk_no;
+
+    snapshot->context = get_index_context(0, false,
+                                          snapshot->height,
+                                          snapshot->network_info,
+                                          snapshot->block_rows);
+
+    snapshot->mempool_context = get_mempool_context(
+                false, no_of_mempool_tx_of_frontpage);
+
+    return snapshot;
+}
+
+/**
+ * Render front page from the snapshot with
+ * ages set to the current time
+ */
+string
+render_index_snapshot(index_snapshot const& snapshot, bool refresh_page)
+{
+    //get current server timestamp
+    server_timestamp = std::time(nullptr);
+
+    uint64_t local_copy_server_timestamp = server_timestamp;
+
+    mstch::map mempool_context = snapshot.mempool_context;
+
+    set_mempool_ages(mempool_context, local_copy_server_timestamp);
+
+    mstch::map context = snapshot.context;
+
+    context["refresh"] = refresh_page;
+
+    set_index_ages(context, snapshot.block_rows,
+                   snapshot.network_info,
+                   local_copy_server_timestamp);
+
+    context["mempool_info"] = render_page(compiled_templates.at("mempool"),
+                                          mempool_context);
+
+    // render the page
+    return render_page(compiled_templates.at("index2"), context);
+}
+
+/**
+ * Resolve ring member of given amount and global output index
+ * into its tx, block and summary of the tx. Resolved members are
+ * kept in ring_member_cache. Cached member is only used if its
+ * public key and height match output_data, i.e., what is at
+ * this global index now.
+ */
+bool
+get_ring_member(uint64_t amount,
+                uint64_t global_idx,
+                cryptonote::output_data_t const& output_data,
+                ring_member& member,
+                string& error_msg)
+{
+    pair<uint64_t, uint64_t> key {amount, global_idx};
+
+    if (ring_member_cache.get(key, member)
+            && member.output_pubkey == output_data.pubkey
+            && member.height == output_data.height)
+    {
+        return true;
+    }
+
+    tx_out_index tx_out_idx;
+
+    try
+    {
+        // get pair pair<crypto::hash, uint64_t> where first is tx hash
+        // and second is local index of the output i in that tx
+        tx_out_idx = core_storage->get_db()
+                .get_output_tx_and_index(amount, global_idx);
+    }
+    catch (const OUTPUT_DNE &e)
+    {
+        error_msg = fmt::format(
+                "Output with amount {:d} and index {:d} does not exist!",
+                amount, global_idx);
+        return false;
+    }
+
+    // get mixin transaction
+    transaction mixin_tx;
+
+    if (!mcore->get_tx(tx_out_idx.first, mixin_tx))
+    {
+        error_msg = fmt::format("Cant get tx: {:s}", pod_to_hex(tx_out_idx.first));
+        return false;
+    }
+
+    // only counts are needed, so no full tx_details here
+    vector<pair<txout_to_key, uint64_t>> output_pub_keys;
+    vector<txin_to_key> input_key_imgs;
+
+    const array<uint64_t, 4>& sum_data = summary_of_in_out_rct(
+            mixin_tx, output_pub_keys, input_key_imgs);
+
+    member.output_pubkey = output_data.pubkey;
+    member.tx_hash       = tx_out_idx.first;
+    member.out_idx       = tx_out_idx.second;
+    member.height        = output_data.height;
+    member.timestamp     = get_blk_timestamp(output_data.height);
+    member.mixin_no      = sum_data[2];
+    member.no_of_inputs  = input_key_imgs.size();
+    member.no_of_outputs = output_pub_keys.size();
+
+    ring_member_cache.put(key, member);
+
+    return true;
+}
+
+/**
+ * Read tx used in a ring and check which of its outputs
+ * belong to the address of the given keys.
+ */
+void
+scan_mixin_tx(mixin_tx_scan& scan,
+              secret_key const& prv_view_key,
+              public_key const& pub_spend_key)
+{
+    transaction mixin_tx;
+
+    if (!mcore->get_tx(scan.tx_hash, mixin_tx))
+        return;
+
+    scan.found   = true;
+    scan.version = mixin_tx.version;
+
+    scan.tx_pub_key = xmreg::get_tx_pub_key_from_received_outs(mixin_tx);
+
+    std::vector<public_key> mixin_additional_tx_pub_keys
+            = cryptonote::get_additional_tx_pub_keys_from_extra(mixin_tx);
+
+    // public transaction key is combined with our viewkey
+    // to create, so called, derived key.
+    key_derivation derivation;
+
+    std::vector<key_derivation> additional_derivations(
+                mixin_additional_tx_pub_keys.size());
+
+    if (!generate_key_derivation(scan.tx_pub_key,
+                                 prv_view_key, derivation))
+    {
+        cerr << "Cant get derived key for: "  << "\n"
+             << "pub_tx_key: " << scan.tx_pub_key << " and "
+             << "prv_view_key" << prv_view_key << endl;
 
-        uint64_t tx_index;
+        return;
+    }
 
-        if (core_storage->get_db().tx_exists(txd.hash, tx_index))
-        {
-            //out_amount_indices = core_storage->get_db()
-                    //.get_tx_amount_output_indices(tx_index).front();
-            get_tx_amount_output_indices<BlockchainDB>(
-                   out_amount_indices, 
-                   tx_index);
-        }
-        else
+    for (size_t i = 0; i < mixin_additional_tx_pub_keys.size(); ++i)
+    {
+        if (!generate_key_derivation(mixin_additional_tx_pub_keys[i],
+                                     prv_view_key,
+                                     additional_derivations[i]))
         {
-            cerr << "get_tx_outputs_gindexs failed to find transaction with id = " << txd.hash;
-        }
+            cerr << "Cant get derived key for: "  << "\n"
+                 << "pub_tx_key: " << mixin_additional_tx_pub_keys[i]
+                 << " and prv_view_key" << prv_view_key << endl;
 
-    }
-    catch(const exception& e)
-    {
-        cerr << e.what() << endl;
+            continue;
+        }
     }
 
-    uint64_t output_idx {0};
+    scan.derived = true;
 
-    mstch::array outputs;
+    //          <public_key  , amount  , out idx>
+    vector<tuple<txout_to_key, uint64_t, uint64_t>> output_pub_keys
+            = xmreg::get_ouputs_tuple(mixin_tx);
 
-    uint64_t outputs_xmr_sum {0};
+    bool coinbase = is_coinbase(mixin_tx);
 
-    for (pair<txout_to_key, uint64_t>& outp: txd.output_pub_keys)
+    scan.outputs.reserve(output_pub_keys.size());
+
+    for (const auto& mix_out: output_pub_keys)
     {
+        mixin_tx_scan::output out;
 
-        // total number of ouputs in the blockchain for this amount
-        uint64_t num_outputs_amount = core_storage->get_db()
-                .get_num_outputs(outp.second);
+        out.pub_key = std::get<0>(mix_out).key;
+        out.amount  = std::get<1>(mix_out);
+        out.out_idx = std::get<2>(mix_out);
 
-        string out_amount_index_str {"N/A"};
+        // get the tx output public key
+        // that normally would be generated for us,
+        // if someone had sent us some xmr.
+        public_key tx_pubkey_generated;
 
-        // outputs in tx in them mempool dont have yet global indices
-        // thus for them, we print N/A
-        if (!out_amount_indices.empty())
-        {
-            out_amount_index_str
-                    = std::to_string(out_amount_indices.at(output_idx));
-        }
+        derive_public_key(derivation,
+                          out.out_idx,
+                          pub_spend_key,
+                          tx_pubkey_generated);
 
-        outputs_xmr_sum += outp.second;
+        // check if generated public key matches the current output's key
+        out.mine = (out.pub_key == tx_pubkey_generated);
 
-        outputs.push_back(mstch::map {
-                {"out_pub_key"           , pod_to_hex(outp.first.key)},
-                {"amount"                , xmreg::xmr_amount_to_str(outp.second)},
-                {"amount_idx"            , out_amount_index_str},
-                {"num_outputs"           , num_outputs_amount},
-                {"unformated_output_idx" , output_idx},
-                {"output_idx"            , fmt::format("{:02d}", output_idx++)}
-        });
+        bool with_additional = false;
 
-    } //  for (pair<txout_to_key, uint64_t>& outp: txd.output_pub_keys)
+        if (!out.mine && mixin_additional_tx_pub_keys.size()
+                == output_pub_keys.size())
+        {
+            derive_public_key(additional_derivations[out.out_idx],
+                              out.out_idx,
+                              pub_spend_key,
+                              tx_pubkey_generated);
 
-    context["outputs_xmr_sum"] = xmreg::xmr_amount_to_str(outputs_xmr_sum);
+            out.mine = (out.pub_key == tx_pubkey_generated);
 
-    context.emplace("outputs", outputs);
+            with_additional = true;
+        }
 
+        // cointbase txs have amounts in plain sight.
+        // so use amount from ringct, only for non-coinbase txs
+        if (out.mine && mixin_tx.version == 2 && !coinbase)
+        {
+            // initialize with regular amount
+            uint64_t rct_amount = out.amount;
+
+            bool r = decode_ringct(
+                        mixin_tx.rct_signatures,
+                        with_additional
+                        ? additional_derivations[out.out_idx] : derivation,
+                        out.out_idx,
+                        mixin_tx.rct_signatures.ecdhInfo[out.out_idx].mask,
+                        rct_amount);
+
+            if (!r)
+                cerr << "show_my_outputs: key images: "
+                        "Cant decode RingCT!\n";
+
+            out.amount = rct_amount;
+        }
 
-    return context;
+        scan.outputs.push_back(out);
+    }
 }
 
-pair<mstch::array, double>
-construct_mstch_mixin_timescales(
-        const vector<vector<uint64_t>>& mixin_timestamp_groups,
-        uint64_t& min_mix_timestamp,
-        uint64_t& max_mix_timestamp
-)
+/**
+ * Get txs of blocks from end_height down to start_height, in that
+ * order, as rows for the index page and json api. Decoded blocks
+ * are kept in block_summary_cache, so that the same top blocks are
+ * not decoded again for each request. Cached entry is only used
+ * if its hash matches the current block at that height, i.e.,
+ * reorged blocks are decoded again.
+ *
+ * Blocks not in the cache are decoded in parallel by the executor,
+ * using at most BLOCK_DECODE_MAX_THREADS threads, so that one
+ * request does not take all of them.
+ *
+ * @return summaries, with nullptr for blocks that cant be read
+ */
+vector<shared_ptr<const block_summary>>
+get_block_summaries(int64_t start_height, int64_t end_height,
+                    uint64_t bc_height)
 {
-    mstch::array mixins_timescales;
+    vector<shared_ptr<const block_summary>> summaries;
 
-    double timescale_scale {0.0};     // size of one '_' in days
+    if (end_height < start_height)
+        return summaries;
 
-    // initialize with some large and some numbers
-    min_mix_timestamp = server_timestamp*2L;
-    max_mix_timestamp = 0;
+    summaries.resize(end_height - start_height + 1);
 
-    // find min and maximum timestamps
-    for (const vector<uint64_t>& mixn_timestamps : mixin_timestamp_groups)
+    vector<size_t> missing;
+
+    for (size_t n = 0; n < summaries.size(); ++n)
     {
+        summaries[n] = get_cached_block_summary(end_height - n);
 
-        uint64_t min_found = *min_element(mixn_timestamps.begin(), mixn_timestamps.end());
-        uint64_t max_found = *max_element(mixn_timestamps.begin(), mixn_timestamps.end());
+        if (!summaries[n])
+            missing.push_back(n);
+    }
 
-        if (min_found < min_mix_timestamp)
-            min_mix_timestamp = min_found;
+    executor->parallel_for(missing.size(), BLOCK_DECODE_MAX_THREADS,
+            [&](size_t i)
+    {
+        size_t n = missing[i];
 
-        if (max_found > max_mix_timestamp)
-            max_mix_timestamp = max_found;
-    }
+        summaries[n] = decode_block_summary(end_height - n, bc_height);
+    });
 
+    return summaries;
+}
 
-    min_mix_timestamp -= 3600;
-    max_mix_timestamp += 3600;
+/**
+ * Get summary of a block from block_summary_cache, if it is
+ * there for the block which is currently at the given height.
+ * The hash is read from lmdb, not the header index, as the index
+ * can still have the old block there for a while after a reorg.
+ *
+ * @return nullptr if not in the cache
+ */
+shared_ptr<const block_summary>
+get_cached_block_summary(uint64_t blk_height)
+{
+    crypto::hash blk_hash = core_storage->get_block_id_by_height(blk_height);
 
-    // make timescale maps for mixins in input with adjusted range
-    for (auto& mixn_timestamps : mixin_timestamp_groups)
+    shared_ptr<const block_summary> cached_summary;
+
+    if (block_summary_cache.get(blk_height, cached_summary)
+            && cached_summary->hash == blk_hash)
     {
-        // get mixins in time scale for visual representation
-        pair<string, double> mixin_times_scale = xmreg::timestamps_time_scale(
-                mixn_timestamps,
-                max_mix_timestamp,
-                170,
-                min_mix_timestamp);
+        return cached_summary;
+    }
 
-        // save resolution of mixin timescales
-        timescale_scale = mixin_times_scale.second;
+    return nullptr;
+}
 
-        // save the string timescales for later to show
-        mixins_timescales.push_back(mstch::map {
-                {"timescale", mixin_times_scale.first}
-        });
-    }
+/**
+ * Header of the block at a given height from the header index.
+ * The index is updated by its own thread, so after a reorg it
+ * can still have the old block at that height for a while. So
+ * its entry is used only if it has the same hash as the block at
+ * that height in lmdb, which is one lookup, rather than reading
+ * and deserializing the block.
+ *
+ * @return false if the index does not have the block
+ */
+bool
+get_indexed_header(uint64_t blk_height, HeaderIndex::header& blk_header)
+{
+    if (!header_index.get_header(blk_height, blk_header))
+        return false;
 
-    return make_pair(mixins_timescales, timescale_scale);
+    return blk_header.hash
+           == core_storage->get_block_id_by_height(blk_height);
 }
 
+uint64_t
+get_blk_timestamp(uint64_t blk_height)
+{
+    HeaderIndex::header blk_header;
 
-tx_details
-get_tx_details(const transaction& tx,
-               bool coinbase = false,
-               uint64_t blk_height = 0,
-               uint64_t bc_height = 0)
+    if (get_indexed_header(blk_height, blk_header))
+        return blk_header.timestamp;
+
+    return mcore->get_blk_timestamp(blk_height);
+}
+
+// in bytes
+uint64_t
+get_blk_weight(uint64_t blk_height)
 {
-    tx_details txd;
+    HeaderIndex::header blk_header;
 
-    // get tx hash
-    
-    if (!tx.pruned)
-    {
-        txd.hash = get_transaction_hash(tx);
-    }
-    else
+    if (get_indexed_header(blk_height, blk_header))
+        return blk_header.weight;
+
+    return core_storage->get_db().get_block_weight(blk_height);
+}
+
+// from cumulative difficulties of the block and the one before it
+difficulty_type
+get_blk_difficulty(uint64_t blk_height)
+{
+    HeaderIndex::header blk_header;
+    HeaderIndex::header prev_blk_header;
+
+    if (get_indexed_header(blk_height, blk_header))
     {
-        txd.hash = get_pruned_transaction_hash(tx, tx.prunable_hash);
+        if (blk_height == 0)
+            return blk_header.cumulative_difficulty;
+
+        if (get_indexed_header(blk_height - 1, prev_blk_header))
+            return blk_header.cumulative_difficulty
+                   - prev_blk_header.cumulative_difficulty;
     }
 
-    // get tx public key from extra
-    // this check if there are two public keys
-    // due to previous bug with sining txs:
-    // https://github.com/monero-project/monero/pull/1358/commits/7abfc5474c0f86e16c405f154570310468b635c2
-    txd.pk = xmreg::get_tx_pub_key_from_received_outs(tx);
-    txd.additional_pks = cryptonote::get_additional_tx_pub_keys_from_extra(tx);
+    return core_storage->get_db().get_block_difficulty(blk_height);
+}
 
+/**
+ * Decode block and its txs into block_summary,
+ * and put it into block_summary_cache.
+ *
+ * It runs in executor's threads, so it opens its own read
+ * transaction. Hash and weight are read with the block in that
+ * transaction, so that they are of the same block even if there
+ * is a reorg at the same time.
+ *
+ * @return nullptr if the block or its txs cant be read
+ */
+shared_ptr<const block_summary>
+decode_block_summary(uint64_t blk_height, uint64_t bc_height)
+{
+    ReadTxnScope rtxn_scope {core_storage->get_db()};
 
-    // sum xmr in inputs and ouputs in the given tx
-    const array<uint64_t, 4>& sum_data = summary_of_in_out_rct(
-            tx, txd.output_pub_keys, txd.input_key_imgs);
+    // get block at the given height
+    block blk;
 
-    txd.xmr_outputs       = sum_data[0];
-    txd.xmr_inputs        = sum_data[1];
-    txd.mixin_no          = sum_data[2];
-    txd.num_nonrct_inputs = sum_data[3];
+    if (!mcore->get_block_by_height(blk_height, blk))
+    {
+        cerr << "Cant get block: " << blk_height << endl;
+        return nullptr;
+    }
 
-    txd.fee = 0;
+    // get all transactions in the block found
+    // initialize the first list with transaction for solving
+    // the block i.e. coinbase.
+    vector<cryptonote::transaction> blk_txs {blk.miner_tx};
+    vector<crypto::hash> missed_txs;
 
-    if (!coinbase &&  tx.vin.size() > 0)
+    if (!core_storage->get_transactions(blk.tx_hashes, blk_txs, missed_txs))
     {
-        // check if not miner tx
-        // i.e., for blocks without any user transactions
-        if (tx.vin.at(0).type() != typeid(txin_gen))
-        {
-            // get tx fee
-            txd.fee = get_tx_fee(tx);
-        }
+        cerr << "Cant get transactions in block: " << blk_height << endl;
+        return nullptr;
     }
 
-    get_payment_id(tx, txd.payment_id, txd.payment_id8);
+    shared_ptr<block_summary> blk_summary = make_shared<block_summary>();
 
-    // get tx size in bytes
-    txd.size = get_object_blobsize(tx);
+    blk_summary->height    = blk_height;
+    blk_summary->hash      = get_block_hash(blk);
+    blk_summary->timestamp = blk.timestamp;
+    blk_summary->weight    = core_storage->get_db().get_block_weight(blk_height);
+    blk_summary->txs_json  = json::array();
 
-    txd.extra = tx.extra;
+    string blk_hash_str = pod_to_hex(blk_summary->hash);
+    string blk_size_str = fmt::format("{:0.2f}",
+                                      static_cast<double>(blk_summary->weight)/1024.0);
 
-    // get tx signatures for each input
-    txd.signatures = tx.signatures;
+    uint64_t tx_i {0};
 
-    // get tx version
-    txd.version = tx.version;
+    for(auto it = blk_txs.begin(); it != blk_txs.end(); ++it)
+    {
+        const cryptonote::transaction& tx = *it;
 
-    // get unlock time
-    txd.unlock_time = tx.unlock_time;
+        const tx_details& txd = get_tx_details(tx, false, blk_height, bc_height);
 
-    txd.no_confirmations = 0;
+        mstch::map txd_map = txd.get_mstch_map();
 
-    if (blk_height == 0 && core_storage->have_tx(txd.hash))
-    {
-        // if blk_height is zero then search for tx block in
-        // the blockchain. but since often block height is know a priory
-        // this is not needed
+        txd_map.insert({"height"    , blk_height});
+        txd_map.insert({"blk_hash"  , blk_hash_str});
+        txd_map.insert({"age"       , string("")});
+        txd_map.insert({"is_ringct" , (tx.version > 1)});
+        txd_map.insert({"rct_type"  , tx.rct_signatures.type});
+        txd_map.insert({"blk_size"  , blk_size_str});
 
-        txd.blk_height = core_storage->get_db().get_tx_block_height(txd.hash);
+        // do not show block info for other than first tx in a block
+        if (tx_i > 0)
+        {
+            txd_map["height"]     = string("");
+            txd_map["blk_size"]   = string("");
+        }
 
-        // get the current blockchain height. Just to check
-        uint64_t bc_height = core_storage->get_current_blockchain_height();
+        blk_summary->tx_rows.push_back(std::move(txd_map));
 
-        txd.no_confirmations = bc_height - (txd.blk_height);
-    }
-    else
-    {
-        // if we know blk_height, and current blockchan height
-        // just use it to get no_confirmations.
+        blk_summary->txs_json.push_back(get_tx_json(tx, txd));
 
-        txd.no_confirmations = bc_height - (blk_height);
+        ++tx_i;
     }
 
-    return txd;
+    block_summary_cache.put(blk_height, blk_summary);
+
+    return blk_summary;
 }
 
 void
@@ -6656,28 +8373,26 @@ find_tx_for_json(
 
 bool
 search_mempool(crypto::hash tx_hash,
-               vector<MempoolStatus::mempool_tx>& found_txs)
+               vector<MempoolStatus::mempool_tx_ptr>& found_txs)
 {
     // if tx_hash == null_hash then this method
     // will just return the vector containing all
     // txs in mempool
 
+    // get mempool snapshot from mempoolstatus thread
+    std::shared_ptr<const MempoolStatus::mempool_snapshot> mempool
+            = MempoolStatus::get_mempool_snapshot();
 
-
-    // get mempool tx from mempoolstatus thread
-    vector<MempoolStatus::mempool_tx> mempool_txs
-            = MempoolStatus::get_mempool_txs();
-
-    // if dont have tx_blob member, construct tx
-    // from json obtained from the rpc call
+    const vector<MempoolStatus::mempool_tx_ptr>& mempool_txs = mempool->txs;
 
     for (size_t i = 0; i < mempool_txs.size(); ++i)
     {
         // get transaction info of the tx in the mempool
-        const MempoolStatus::mempool_tx& mempool_tx = mempool_txs.at(i);
+        const MempoolStatus::mempool_tx_ptr& mempool_tx = mempool_txs.at(i);
 
-        if (tx_hash == mempool_tx.tx_hash || tx_hash == null_hash)
+        if (tx_hash == mempool_tx->tx_hash || tx_hash == null_hash)
         {
+            // found tx is shared with the snapshot, not copied
             found_txs.push_back(mempool_tx);
 
             if (tx_hash != null_hash)
@@ -6731,6 +8446,46 @@ get_age(uint64_t timestamp1, uint64_t timestamp2, bool full_format = 0)
 }
 
 
+void
+compile_templates()
+{
+    map<string, string> partials {
+            {"tx_details"   , template_file["tx_details"]},
+            {"tx_table_head", template_file["tx_table_header"]},
+            {"tx_table_row" , template_file["tx_table_row"]}
+    };
+
+    for (auto const& tmpl: template_file)
+    {
+        compiled_templates.emplace(
+                tmpl.first,
+                mstch::compiled_template {tmpl.second, partials});
+    }
+}
+
+/**
+ * Renders the template into buffer of the calling thread and
+ * returns its copy. Pages are up to few MB, so the buffer does
+ * not need to be reallocated, and copied, many times as they
+ * grow, which happens when each render starts with empty string.
+ */
+string
+render_page(const mstch::compiled_template& tmplt, const mstch::node& context)
+{
+    static thread_local string buffer;
+
+    buffer.clear();
+
+    tmplt.render(context, buffer);
+
+    string page {buffer};
+
+    if (buffer.capacity() > RENDER_BUFFER_MAX_CAPACITY)
+        string {}.swap(buffer);
+
+    return page;
+}
+
 string
 get_full_page(const string& middle)
 {
@@ -6777,20 +8532,59 @@ get_monero_network_info(json& j_info)
 bool
 get_dynamic_per_kb_fee_estimate(uint64_t& fee_estimated)
 {
+    std::function<bool(uint64_t&)> rpc_call = [this](uint64_t& fee)
+    {
+        string error_msg;
 
-    string error_msg;
+        if (!rpc->get_dynamic_per_kb_fee_estimate(
+                FEE_ESTIMATE_GRACE_BLOCKS,
+                fee, error_msg))
+        {
+            cerr << "rpc.get_dynamic_per_kb_fee_estimate failed" << endl;
+            return false;
+        }
 
-    if (!rpc.get_dynamic_per_kb_fee_estimate(
-            FEE_ESTIMATE_GRACE_BLOCKS,
-            fee_estimated, error_msg))
+        return true;
+    };
+
+    return call_rpc(rpc_call, fee_estimated);
+}
+
+/**
+ * Execute rpc call in the executor, and wait for its result
+ * at most the rpc deadline. This way slow or not responding
+ * deamon does not block crow's threads.
+ *
+ * The call itself cant take longer than its deadline, so
+ * a worker thread is busy with it at most that long. We stop
+ * waiting earlier only if the call waited in the executor's
+ * queue. The result is kept in shared_ptr, as the call can
+ * still be running then. The result is copied even if the call
+ * failed, as it can be an error message.
+ */
+template <typename T>
+bool
+call_rpc(std::function<bool(T&)> rpc_call, T& result)
+{
+    shared_ptr<T> rpc_result = make_shared<T>();
+
+    std::future<bool> rpc_ftr = executor->submit([rpc_call, rpc_result]()
+    {
+        return rpc_call(*rpc_result);
+    });
+
+    if (rpc_ftr.wait_for(std::chrono::milliseconds(rpc->get_timeout()))
+            != std::future_status::ready)
     {
-        cerr << "rpc.get_dynamic_per_kb_fee_estimate failed" << endl;
+        cerr << "rpc call to the deamon timed out" << endl;
         return false;
     }
 
-    (void) error_msg;
+    bool r = rpc_ftr.get();
 
-    return true;
+    result = *rpc_result;
+
+    return r;
 }
 
 bool
@@ -6861,7 +8655,7 @@ get_tx(string const& tx_hash_str,
        transaction& tx,
        crypto::hash& tx_hash)
 {
-    if (!epee::string_tools::hex_to_pod(tx_hash_str, tx_hash))
+    if (!hex_to_pod(tx_hash_str, tx_hash))
     {
         string msg = fmt::format("Cant parse {:s} as tx hash!", tx_hash_str);
         cerr << msg << endl;
@@ -6875,7 +8669,7 @@ get_tx(string const& tx_hash_str,
         cerr << "Cant get tx in blockchain: " << tx_hash
              << ". \n Check mempool now\n";
 
-        vector<MempoolStatus::mempool_tx> found_txs;
+        vector<MempoolStatus::mempool_tx_ptr> found_txs;
 
         search_mempool(tx_hash, found_txs);
 
@@ -6885,7 +8679,7 @@ get_tx(string const& tx_hash_str,
             return false;
         }
 
-        tx = found_txs.at(0).tx;
+        tx = found_txs.at(0)->tx;
     }
 
     return true;
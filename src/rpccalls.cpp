@@ -11,7 +11,8 @@ namespace xmreg
 rpccalls::rpccalls(
          string _deamon_url,
          login_opt login,
-         uint64_t _timeout)
+         uint64_t _timeout,
+         size_t _no_of_connections)
         : deamon_url {_deamon_url},
           timeout_time {_timeout}
 {
@@ -21,23 +22,152 @@ rpccalls::rpccalls(
 
     timeout_time_ms = std::chrono::milliseconds {timeout_time};    
 
-     m_http_client.set_server(
-             deamon_url,
-             login,
-             epee::net_utils::ssl_support_t::e_ssl_support_disabled);
+    _no_of_connections = std::max<size_t>(_no_of_connections, 1);
+
+    // connections are made lazily, when they
+    // are checked out for the first time
+    for (size_t i = 0; i < _no_of_connections; ++i)
+    {
+        http_clients.emplace_back(new http_client_t());
+
+        http_clients.back()->set_server(
+                deamon_url,
+                login,
+                epee::net_utils::ssl_support_t::e_ssl_support_disabled);
+
+        idle_http_clients.push_back(http_clients.back().get());
+    }
+}
+
+std::chrono::milliseconds
+rpccalls::client_lease::time_left() const
+{
+    using std::chrono::milliseconds;
+
+    milliseconds left = std::chrono::duration_cast<milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+
+    return std::max(left, milliseconds {0});
 }
 
 bool
-rpccalls::connect_to_monero_deamon()
+rpccalls::client_lease::expired() const
+{
+    return std::chrono::steady_clock::now() >= deadline;
+}
+
+rpccalls::client_lease
+rpccalls::checkout_client()
 {
-    //std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+    using std::chrono::steady_clock;
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+
+    steady_clock::time_point start_time = steady_clock::now();
+    steady_clock::time_point deadline   = start_time + timeout_time_ms;
+
+    http_client_t* client {nullptr};
 
-    if(m_http_client.is_connected())
     {
-        return true;
+        std::unique_lock<std::mutex> lck (pool_mutex);
+
+        if (!pool_cv.wait_until(lck, deadline, [this]() {
+                    return !idle_http_clients.empty();}))
+        {
+            ++checkout_timeouts;
+            cerr << "No free connection to the deamon at "
+                 << deamon_url << endl;
+            return client_lease {};
+        }
+
+        client = idle_http_clients.back();
+        idle_http_clients.pop_back();
+    }
+
+    uint64_t wait_time = duration_cast<microseconds>(
+            steady_clock::now() - start_time).count();
+
+    ++checkouts;
+    total_wait_time += wait_time;
+
+    uint64_t current_max = max_wait_time;
+
+    while (wait_time > current_max
+           && !max_wait_time.compare_exchange_weak(current_max, wait_time))
+    {}
+
+    client_lease lease {this, client, deadline};
+
+    // health check. connection could have been closed
+    // by the deamon or broken by previous call.
+    if (!client->is_connected())
+    {
+        ++reconnects;
+
+        if (lease.expired() || !client->connect(lease.time_left()))
+        {
+            // lease returns it to the pool
+            return client_lease {};
+        }
     }
 
-    return m_http_client.connect(timeout_time_ms);
+    // no time left for the call itself
+    if (lease.expired())
+    {
+        ++checkout_timeouts;
+        cerr << "No time left for rpc call to the deamon at "
+             << deamon_url << endl;
+        return client_lease {};
+    }
+
+    return lease;
+}
+
+void
+rpccalls::return_client(http_client_t* client, bool broken)
+{
+    if (broken)
+    {
+        ++failed_calls;
+
+        // dont know in what state the connection is,
+        // so next checkout will connect again.
+        client->disconnect();
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(pool_mutex);
+        idle_http_clients.push_back(client);
+    }
+
+    pool_cv.notify_one();
+}
+
+uint64_t
+rpccalls::get_timeout() const
+{
+    return timeout_time;
+}
+
+rpccalls::pool_stats
+rpccalls::get_pool_stats() const
+{
+    pool_stats stats;
+
+    {
+        std::lock_guard<std::mutex> guard(pool_mutex);
+        stats.idle_connections = idle_http_clients.size();
+    }
+
+    stats.no_of_connections = http_clients.size();
+    stats.checkouts         = checkouts;
+    stats.checkout_timeouts = checkout_timeouts;
+    stats.reconnects        = reconnects;
+    stats.failed_calls      = failed_calls;
+    stats.total_wait_time   = total_wait_time;
+    stats.max_wait_time     = max_wait_time;
+
+    return stats;
 }
 
 uint64_t
@@ -46,9 +176,9 @@ rpccalls::get_current_height()
     COMMAND_RPC_GET_HEIGHT::request   req;
     COMMAND_RPC_GET_HEIGHT::response  res;
 
-    std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+    client_lease client = checkout_client();
 
-    if (!connect_to_monero_deamon())
+    if (!client)
     {
         cerr << "get_current_height: not connected to deamon" << endl;
         return false;
@@ -56,7 +186,10 @@ rpccalls::get_current_height()
 
     bool r = epee::net_utils::invoke_http_json(
             "/getheight",
-            req, res, m_http_client, timeout_time_ms);
+            req, res, *client, client.time_left());
+
+    if (!r)
+        client.mark_broken();
 
     if (!r)
     {
@@ -78,9 +211,9 @@ rpccalls::get_mempool(vector<tx_info>& mempool_txs)
     bool r;
 
     {
-        std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+        client_lease client = checkout_client();
 
-        if (!connect_to_monero_deamon())
+        if (!client)
         {
             cerr << "get_mempool: not connected to deamon" << endl;
             return false;
@@ -88,7 +221,10 @@ rpccalls::get_mempool(vector<tx_info>& mempool_txs)
 
         r = epee::net_utils::invoke_http_json(
                 "/get_transaction_pool",
-                req, res, m_http_client, timeout_time_ms);
+                req, res, *client, client.time_left());
+
+        if (!r)
+            client.mark_broken();
     }
 
     if (!r || res.status != CORE_RPC_STATUS_OK)
@@ -125,9 +261,9 @@ rpccalls::commit_tx(tools::wallet2::pending_tx& ptx, string& error_msg)
 
     req.do_not_relay = false;
 
-    std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+    client_lease client = checkout_client();
 
-    if (!connect_to_monero_deamon())
+    if (!client)
     {
         cerr << "commit_tx: not connected to deamon" << endl;
         return false;
@@ -135,7 +271,10 @@ rpccalls::commit_tx(tools::wallet2::pending_tx& ptx, string& error_msg)
 
     bool r = epee::net_utils::invoke_http_json(
             "/sendrawtransaction",
-            req, res, m_http_client, timeout_time_ms);
+            req, res, *client, client.time_left());
+
+    if (!r)
+        client.mark_broken();
 
     if (!r || res.status == "Failed")
     {
@@ -164,9 +303,9 @@ rpccalls::get_network_info(COMMAND_RPC_GET_INFO::response& response)
     req_t.method = "get_info";
 
     {
-        std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+        client_lease client = checkout_client();
 
-        if (!connect_to_monero_deamon())
+        if (!client)
         {
             cerr << "get_network_info: not connected to deamon" << endl;
             return false;
@@ -174,7 +313,11 @@ rpccalls::get_network_info(COMMAND_RPC_GET_INFO::response& response)
 
         r = epee::net_utils::invoke_http_json("/json_rpc",
                                               req_t, resp_t,
-                                              m_http_client);
+                                              *client,
+                                              client.time_left());
+
+        if (!r)
+            client.mark_broken();
     }
 
     string err;
@@ -224,9 +367,9 @@ rpccalls::get_hardfork_info(COMMAND_RPC_HARD_FORK_INFO::response& response)
     req_t.method = "hard_fork_info";
 
     {
-        std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+        client_lease client = checkout_client();
 
-        if (!connect_to_monero_deamon())
+        if (!client)
         {
             cerr << "get_hardfork_info: not connected to deamon" << endl;
             return false;
@@ -234,7 +377,11 @@ rpccalls::get_hardfork_info(COMMAND_RPC_HARD_FORK_INFO::response& response)
 
         r = epee::net_utils::invoke_http_json("/json_rpc",
                                               req_t, resp_t,
-                                              m_http_client);
+                                              *client,
+                                              client.time_left());
+
+        if (!r)
+            client.mark_broken();
     }
 
 
@@ -292,9 +439,9 @@ rpccalls::get_dynamic_per_kb_fee_estimate(
     bool r {false};
 
     {
-        std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+        client_lease client = checkout_client();
 
-        if (!connect_to_monero_deamon())
+        if (!client)
         {
             cerr << "get_dynamic_per_kb_fee_estimate: not connected to deamon" << endl;
             return false;
@@ -302,7 +449,11 @@ rpccalls::get_dynamic_per_kb_fee_estimate(
 
         r = epee::net_utils::invoke_http_json("/json_rpc",
                                               req_t, resp_t,
-                                              m_http_client);
+                                              *client,
+                                              client.time_left());
+
+        if (!r)
+            client.mark_broken();
     }
 
     string err;
@@ -355,9 +506,9 @@ rpccalls::get_block(string const& blk_hash, block& blk, string& error_msg)
     bool r {false};
 
     {
-        std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+        client_lease client = checkout_client();
 
-        if (!connect_to_monero_deamon())
+        if (!client)
         {
             cerr << "get_block: not connected to deamon" << endl;
             return false;
@@ -365,7 +516,11 @@ rpccalls::get_block(string const& blk_hash, block& blk, string& error_msg)
 
         r = epee::net_utils::invoke_http_json("/json_rpc",
                                               req_t, resp_t,
-                                              m_http_client);
+                                              *client,
+                                              client.time_left());
+
+        if (!r)
+            client.mark_broken();
     }
 
     string err;
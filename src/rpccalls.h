@@ -11,7 +11,11 @@
 #include "wipeable_string.h"
 
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <utility>
+#include <condition_variable>
 
 
 
@@ -69,28 +73,116 @@ using namespace std;
 
 class rpccalls
 {
-    string deamon_url ;
-    uint64_t timeout_time;
+public:
 
-    std::chrono::milliseconds timeout_time_ms;
+    using http_client_t = epee::net_utils::http::http_simple_client;
 
-    epee::net_utils::http::url_content url;
+    using login_opt = boost::optional<epee::net_utils::http::login>;
 
-    epee::net_utils::http::http_simple_client m_http_client;
-    std::mutex m_daemon_rpc_mutex;
+    // counters of the connection pool, to help
+    // with setting its size
+    struct pool_stats
+    {
+        uint64_t no_of_connections {0};
+        uint64_t idle_connections {0};
+        uint64_t checkouts {0};
+        uint64_t checkout_timeouts {0};
+        uint64_t reconnects {0};
+        uint64_t failed_calls {0};
+
+        // time waited for a free connection, in microseconds
+        uint64_t total_wait_time {0};
+        uint64_t max_wait_time {0};
+    };
 
-    string port;
+    /**
+     * Connection checked out from the pool. It goes back
+     * to the pool when the lease goes out of scope.
+     * Connections marked as broken are disconnected first,
+     * so that next checkout connects them again.
+     */
+    class client_lease
+    {
+    public:
 
-public:
+        client_lease(rpccalls* _pool = nullptr,
+                     http_client_t* _client = nullptr,
+                     std::chrono::steady_clock::time_point _deadline = {})
+            : pool {_pool}, client {_client}, deadline {_deadline}
+        {}
 
-    using login_opt = boost::optional<epee::net_utils::http::login>;
+        client_lease(client_lease&& other)
+            : pool {other.pool}, client {other.client},
+              deadline {other.deadline}, broken {other.broken}
+        {
+            other.client = nullptr;
+        }
+
+        client_lease(const client_lease&) = delete;
+        client_lease& operator=(const client_lease&) = delete;
+
+        ~client_lease()
+        {
+            if (client)
+                pool->return_client(client, broken);
+        }
+
+        explicit operator bool() const
+        {
+            return client != nullptr;
+        }
+
+        http_client_t&
+        operator*()
+        {
+            return *client;
+        }
+
+        void
+        mark_broken()
+        {
+            broken = true;
+        }
+
+        // what is left from the call's deadline,
+        // zero if it has already passed
+        std::chrono::milliseconds
+        time_left() const;
+
+        bool
+        expired() const;
+
+    private:
+        rpccalls* pool;
+        http_client_t* client;
+        std::chrono::steady_clock::time_point deadline;
+        bool broken {false};
+    };
 
     rpccalls(string _deamon_url = "http:://127.0.0.1:18081",
              login_opt _login = login_opt {},
-             uint64_t _timeout = 200000);
+             uint64_t _timeout = 10000,
+             size_t _no_of_connections = 4);
 
-    bool
-    connect_to_monero_deamon();
+    /**
+     * Get connection to the deamon from the pool. If all are
+     * in use, wait for one until the call's deadline, i.e.,
+     * timeout_time from now. Connecting and the call itself
+     * must also finish before that deadline.
+     *
+     * @return lease which evaluates to false if no connection
+     *         is available, it cant connect to the deamon or
+     *         the deadline has already passed
+     */
+    client_lease
+    checkout_client();
+
+    // deadline of each call, in milliseconds
+    uint64_t
+    get_timeout() const;
+
+    pool_stats
+    get_pool_stats() const;
 
     uint64_t
     get_current_height();
@@ -133,9 +225,9 @@ public:
         typename T::response resp;
 
         {
-            std::lock_guard<std::mutex> guard(m_daemon_rpc_mutex);
+            client_lease client = checkout_client();
 
-            if (!connect_to_monero_deamon())
+            if (!client)
             {
                 cerr << "get_alt_blocks: not connected to deamon" << endl;
                 return false;
@@ -143,7 +235,11 @@ public:
 
             r = epee::net_utils::invoke_http_json("/get_alt_blocks_hashes",
                                                   req, resp,
-                                                  m_http_client);
+                                                  *client,
+                                                  client.time_left());
+
+            if (!r)
+                client.mark_broken();
         }
 
         string err;
@@ -191,6 +287,34 @@ public:
     bool
     get_block(string const& blk_hash, block& blk, string& error_msg);
 
+private:
+
+    void
+    return_client(http_client_t* client, bool broken);
+
+    string deamon_url ;
+    uint64_t timeout_time;
+
+    std::chrono::milliseconds timeout_time_ms;
+
+    epee::net_utils::http::url_content url;
+
+    string port;
+
+    // all connections to the deamon, and those
+    // of them which are not used at the moment
+    vector<unique_ptr<http_client_t>> http_clients;
+    vector<http_client_t*> idle_http_clients;
+
+    mutable std::mutex pool_mutex;
+    std::condition_variable pool_cv;
+
+    std::atomic<uint64_t> checkouts {0};
+    std::atomic<uint64_t> checkout_timeouts {0};
+    std::atomic<uint64_t> reconnects {0};
+    std::atomic<uint64_t> failed_calls {0};
+    std::atomic<uint64_t> total_wait_time {0};
+    std::atomic<uint64_t> max_wait_time {0};
 };
 
 
@@ -22,11 +22,11 @@ parse_str_secret_key(const string& key_str, T& secret_key)
 
     // hash and keys have same structure, so to parse string of
     // a key, e.g., a view key, we can first parse it into the hash
-    // object using parse_hash256 function, and then copy the reslting
+    // object using hex_to_pod function, and then copy the reslting
     // hash data into secret key.
     crypto::hash hash_;
 
-    if(!parse_hash256(key_str, hash_))
+    if(!hex_to_pod(key_str, hash_))
     {
         cerr << "Cant parse a key (e.g. viewkey): " << key_str << endl;
         return false;
@@ -965,71 +965,151 @@ decode_ringct(rct::rctSig const& rv,
     return true;
 }
 
+namespace
+{
+
+// characters kept by remove_bad_chars, i.e., [a-zA-Z0-9+/=]
+std::array<bool, 256>
+make_base64_chars()
+{
+    std::array<bool, 256> chars;
+
+    chars.fill(false);
+
+    for (int c = '0'; c <= '9'; ++c)
+        chars[c] = true;
+
+    for (int c = 'a'; c <= 'z'; ++c)
+        chars[c] = chars[c - 'a' + 'A'] = true;
+
+    chars['+'] = chars['/'] = chars['='] = true;
+
+    return chars;
+}
+
+/**
+ * Appends percent decoded in to out, in one pass. Runs of characters
+ * which need no decoding are appended at once. With only_base64_chars,
+ * decoded characters other than [a-zA-Z0-9+/=] are dropped.
+ */
 bool
-url_decode(const std::string& in, std::string& out)
+url_decode_append(boost::string_ref in, string& out, bool only_base64_chars)
 {
-    out.clear();
-    out.reserve(in.size());
-    for (std::size_t i = 0; i < in.size(); ++i)
+    static const std::array<bool, 256> base64_chars = make_base64_chars();
+
+    out.reserve(out.size() + in.size());
+
+    const char* p   = in.data();
+    const char* end = p + in.size();
+
+    while (p < end)
     {
-        if (in[i] == '%')
+        const char* run = p;
+
+        while (p < end && *p != '%' && *p != '+'
+               && (!only_base64_chars || base64_chars[static_cast<uint8_t>(*p)]))
         {
-            if (i + 3 <= in.size())
-            {
-                int value = 0;
-                std::istringstream is(in.substr(i + 1, 2));
-                if (is >> std::hex >> value)
-                {
-                    out += static_cast<char>(value);
-                    i += 2;
-                }
-                else
-                {
-                    return false;
-                }
-            }
-            else
-            {
+            ++p;
+        }
+
+        out.append(run, p);
+
+        if (p == end)
+            break;
+
+        char c;
+
+        if (*p == '%')
+        {
+            if (end - p < 3)
                 return false;
-            }
+
+            int high = hex_digit_value(p[1]);
+            int low  = hex_digit_value(p[2]);
+
+            if (high < 0 || low < 0)
+                return false;
+
+            c = static_cast<char>((high << 4) | low);
+
+            p += 3;
         }
-        else if (in[i] == '+')
+        else if (*p == '+')
         {
-            out += ' ';
+            c = ' ';
+            ++p;
         }
         else
         {
-            out += in[i];
+            // not allowed character, just skip it
+            ++p;
+            continue;
         }
+
+        if (!only_base64_chars || base64_chars[static_cast<uint8_t>(c)])
+            out += c;
     }
+
     return true;
 }
 
-map<std::string, std::string>
-parse_crow_post_data(const string& req_body)
+}
+
+bool
+url_decode(const std::string& in, std::string& out)
+{
+    out.clear();
+
+    return url_decode_append(in, out, false);
+}
+
+form_fields
+parse_form_data(boost::string_ref body)
 {
-    map<std::string, std::string> body;
+    form_fields fields;
 
-    vector<string> vec;
-    string tmp;
-    bool result = url_decode(req_body, tmp);
-    if (result)
+    while (!body.empty())
     {
-        boost::algorithm::split(vec, tmp,
-            [](char x) {return x == '&';
-        });
+        size_t end = body.find('&');
 
-        for(auto &it : vec)
-        {
-            auto pos = it.find("=");
+        boost::string_ref field = body.substr(0, end);
 
-            if (pos != string::npos)
-                body[it.substr(0, pos)] = it.substr(pos + 1);
-            else
-                break;
+        body.remove_prefix(end == boost::string_ref::npos
+                           ? body.size() : end + 1);
+
+        size_t pos = field.find('=');
+
+        if (pos == boost::string_ref::npos)
+            continue;
+
+        fields.emplace_back(field.substr(0, pos), field.substr(pos + 1));
+    }
+
+    return fields;
+}
+
+bool
+get_form_field(form_fields const& fields, boost::string_ref name,
+               string& value, bool only_base64_chars)
+{
+    value.clear();
+
+    // the last one is used if the field is given more than once
+    for (auto it = fields.rbegin(); it != fields.rend(); ++it)
+    {
+        if (it->first != name)
+            continue;
+
+        if (!url_decode_append(it->second, value, only_base64_chars))
+        {
+            value.clear();
+            return false;
         }
+
+        return true;
     }
-    return body;
+
+    return false;
 }
 
 
@@ -1270,7 +1350,7 @@ pause_execution(uint64_t no_seconds, const string& text)
 string
 tx_to_hex(transaction const& tx)
 {
-    return epee::string_tools::buff_to_hex_nodelimer(t_serializable_object_to_blob(tx));
+    return buff_to_hex(t_serializable_object_to_blob(tx));
 }
 
 void get_metric_prefix(cryptonote::difficulty_type hr, double& hr_d, char& prefix)
@@ -16,6 +16,7 @@
 
 
 #include "monero_headers.h"
+#include "HexCodec.h"
 
 #include "../ext/fmt/ostream.h"
 #include "../ext/fmt/format.h"
@@ -25,6 +26,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/utility/string_ref.hpp>
 
 #include <string>
 #include <vector>
@@ -32,6 +34,7 @@
 #include <algorithm>
 #include <type_traits>
 #include <regex>
+#include <array>
 
 /**
  * Some helper functions used in the example.
@@ -257,8 +260,27 @@ decode_ringct(const rct::rctSig & rv,
 bool
 url_decode(const std::string& in, std::string& out);
 
-map<std::string, std::string>
-parse_crow_post_data(const string& req_body);
+// fields of url encoded form, as sent in body of POST requests.
+// Names and values are not decoded yet, and point into the body.
+using form_fields = vector<pair<boost::string_ref, boost::string_ref>>;
+
+/**
+ * Splits url encoded form body into its fields, without
+ * copying or decoding them. Fields without '=' are skipped.
+ */
+form_fields
+parse_form_data(boost::string_ref body);
+
+/**
+ * Decodes value of the named field. With only_base64_chars,
+ * characters other than [a-zA-Z0-9+/=] are dropped while
+ * decoding, as remove_bad_chars does.
+ *
+ * @return false if the field is not given or cant be decoded
+ */
+bool
+get_form_field(form_fields const& fields, boost::string_ref name,
+               string& value, bool only_base64_chars = true);
 
 // from wallet2::decrypt
 string
@@ -0,0 +1,238 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+// Checks every hex codec implementation the cpu can run, i.e.,
+// sse2 and avx2 ones on x86-64, against the scalar one. Sizes
+// go over the 16 and 32 byte blocks and their remainders, and
+// each position of the input gets characters which are not hex
+// digits. At the end, speed of each of them is printed.
+
+#include "../src/HexCodec.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+
+#define MAX_TEST_SIZE       100
+#define BENCHMARK_SIZE      (1 << 20)
+#define BENCHMARK_REPEATS   50
+
+using namespace std;
+
+namespace
+{
+
+int no_of_failures {0};
+
+void
+check(bool condition, const string& what)
+{
+    if (condition)
+        return;
+
+    cerr << "FAILED: " << what << endl;
+    ++no_of_failures;
+}
+
+vector<uint8_t>
+random_bytes(size_t size, std::mt19937& rng)
+{
+    vector<uint8_t> bytes(size);
+
+    for (auto& b: bytes)
+        b = static_cast<uint8_t>(rng());
+
+    return bytes;
+}
+
+void
+test_encode(const xmreg::hex_codec& scalar,
+            const xmreg::hex_codec& codec,
+            std::mt19937& rng)
+{
+    for (size_t size = 0; size <= MAX_TEST_SIZE; ++size)
+    {
+        vector<uint8_t> bytes = random_bytes(size, rng);
+
+        string expected(2 * size, '\0');
+        string hex(2 * size, '\0');
+
+        scalar.encode(bytes.data(), size, &expected[0]);
+        codec.encode(bytes.data(), size, &hex[0]);
+
+        check(hex == expected, string(codec.name) + " encode of "
+                               + to_string(size) + " bytes");
+    }
+
+    // all byte values, for the nibbles to characters mapping
+    vector<uint8_t> all_bytes(256);
+
+    for (size_t i = 0; i < all_bytes.size(); ++i)
+        all_bytes[i] = static_cast<uint8_t>(i);
+
+    string expected(512, '\0');
+    string hex(512, '\0');
+
+    scalar.encode(all_bytes.data(), all_bytes.size(), &expected[0]);
+    codec.encode(all_bytes.data(), all_bytes.size(), &hex[0]);
+
+    check(hex == expected, string(codec.name) + " encode of all bytes");
+}
+
+void
+test_decode(const xmreg::hex_codec& scalar,
+            const xmreg::hex_codec& codec,
+            std::mt19937& rng)
+{
+    const string mixed_case_digits = "0123456789abcdefABCDEF";
+
+    for (size_t size = 0; size <= MAX_TEST_SIZE; ++size)
+    {
+        string hex(2 * size, '\0');
+
+        for (auto& c: hex)
+            c = mixed_case_digits[rng() % mixed_case_digits.size()];
+
+        vector<uint8_t> expected(size);
+        vector<uint8_t> bytes(size);
+
+        bool expected_ok = scalar.decode(hex.data(), size, expected.data());
+        bool ok          = codec.decode(hex.data(), size, bytes.data());
+
+        check(expected_ok && ok && bytes == expected,
+              string(codec.name) + " decode of " + to_string(size) + " bytes");
+    }
+
+    // every non hex character, including ones next to the digit
+    // and letter ranges and ones with the top bit set, at
+    // each position of block and remainder parts of the input
+    for (size_t size: {1, 15, 16, 17, 31, 32, 33, 64, 65})
+    {
+        string valid_hex(2 * size, 'a');
+
+        for (int c = 0; c < 256; ++c)
+        {
+            if (xmreg::hex_digit_value(static_cast<char>(c)) >= 0)
+                continue;
+
+            for (size_t pos = 0; pos < valid_hex.size(); ++pos)
+            {
+                string hex = valid_hex;
+
+                hex[pos] = static_cast<char>(c);
+
+                vector<uint8_t> bytes(size);
+
+                check(!scalar.decode(hex.data(), size, bytes.data()),
+                      "scalar accepted " + to_string(c));
+
+                check(!codec.decode(hex.data(), size, bytes.data()),
+                      string(codec.name) + " accepted character "
+                      + to_string(c) + " at " + to_string(pos)
+                      + " of " + to_string(hex.size()));
+            }
+        }
+    }
+}
+
+void
+test_digit_values()
+{
+    for (int c = 0; c < 256; ++c)
+    {
+        int expected {-1};
+
+        if (c >= '0' && c <= '9')
+            expected = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            expected = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            expected = c - 'A' + 10;
+
+        check(xmreg::hex_digit_value(static_cast<char>(c)) == expected,
+              "hex_digit_value of " + to_string(c));
+    }
+}
+
+double
+megabytes_per_second(size_t no_of_bytes,
+                     std::chrono::steady_clock::duration duration)
+{
+    double seconds = std::chrono::duration<double>(duration).count();
+
+    return no_of_bytes / seconds / 1e6;
+}
+
+void
+benchmark(const xmreg::hex_codec& codec, std::mt19937& rng)
+{
+    vector<uint8_t> bytes = random_bytes(BENCHMARK_SIZE, rng);
+    vector<uint8_t> decoded(BENCHMARK_SIZE);
+
+    string hex(2 * BENCHMARK_SIZE, '\0');
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCHMARK_REPEATS; ++i)
+        codec.encode(bytes.data(), bytes.size(), &hex[0]);
+
+    auto encode_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+
+    bool ok {true};
+
+    for (int i = 0; i < BENCHMARK_REPEATS; ++i)
+        ok = codec.decode(hex.data(), decoded.size(), decoded.data()) && ok;
+
+    auto decode_time = std::chrono::steady_clock::now() - start;
+
+    check(ok && decoded == bytes, string(codec.name) + " benchmark round trip");
+
+    size_t no_of_bytes = static_cast<size_t>(BENCHMARK_SIZE) * BENCHMARK_REPEATS;
+
+    cout << codec.name
+         << ": encode " << megabytes_per_second(no_of_bytes, encode_time)
+         << " MB/s, decode " << megabytes_per_second(no_of_bytes, decode_time)
+         << " MB/s" << endl;
+}
+
+}
+
+int
+main()
+{
+    std::mt19937 rng {2026};
+
+    vector<xmreg::hex_codec> codecs = xmreg::get_hex_codecs();
+
+    check(!codecs.empty() && strcmp(codecs.front().name, "scalar") == 0,
+          "scalar codec comes first");
+
+    test_digit_values();
+
+    for (auto const& codec: codecs)
+    {
+        test_encode(codecs.front(), codec, rng);
+        test_decode(codecs.front(), codec, rng);
+    }
+
+    cout << "used: " << xmreg::hex_codec_name() << endl;
+
+    for (auto const& codec: codecs)
+        benchmark(codec, rng);
+
+    if (no_of_failures > 0)
+    {
+        cerr << no_of_failures << " checks failed" << endl;
+        return 1;
+    }
+
+    cout << "all checks passed" << endl;
+
+    return 0;
+}
@@ -0,0 +1,227 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+// Regression test of streamed responses, e.g., /api/transactions,
+// requested over HTTP/1.0. Such clients dont know chunked encoding,
+// so crow produces the whole body before sending it. Producers
+// stopping each part at JSON_STREAM_CHUNK_SIZE made it spin
+// forever once the body got larger than that.
+
+#include "../ext/crow/crow.h"
+
+#include <boost/asio.hpp>
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#define JSON_STREAM_CHUNK_SIZE  16384
+#define TEST_PORT               45181
+#define NO_OF_BLOCKS            100
+
+using namespace std;
+
+using boost::asio::ip::tcp;
+
+namespace
+{
+
+string
+block_json(int height)
+{
+    return "{\"height\":" + to_string(height)
+           + ",\"txs\":\"" + string(1000, 'x') + "\"}";
+}
+
+string
+expected_body()
+{
+    string body = "{\"blocks\":[";
+
+    for (int i = 0; i < NO_OF_BLOCKS; ++i)
+        body += (i > 0 ? "," : "") + block_json(i);
+
+    return body + "]}";
+}
+
+// sends the request and reads until the server closes the
+// connection. Returns false if that did not happen in time.
+bool
+http_request(const string& request, string& response)
+{
+    boost::asio::io_service io_service;
+
+    tcp::socket socket(io_service);
+
+    socket.connect(tcp::endpoint(
+            boost::asio::ip::address::from_string("127.0.0.1"), TEST_PORT));
+
+    boost::asio::write(socket, boost::asio::buffer(request));
+
+    bool closed {false};
+
+    std::array<char, 4096> buffer;
+
+    std::function<void(const boost::system::error_code&, size_t)> on_read
+            = [&](const boost::system::error_code& ec, size_t no_of_bytes)
+    {
+        response.append(buffer.data(), no_of_bytes);
+
+        if (ec)
+        {
+            closed = true;
+            return;
+        }
+
+        socket.async_read_some(boost::asio::buffer(buffer), on_read);
+    };
+
+    socket.async_read_some(boost::asio::buffer(buffer), on_read);
+
+    io_service.run_for(std::chrono::seconds(10));
+
+    return closed;
+}
+
+bool
+check(bool condition, const string& what)
+{
+    if (!condition)
+        cerr << "FAILED: " << what << endl;
+
+    return condition;
+}
+
+}
+
+int
+main()
+{
+    crow::logger::setLogLevel(crow::LogLevel::Warning);
+
+    crow::SimpleApp app;
+
+    CROW_ROUTE(app, "/api/transactions")
+    ([]() {
+        crow::response r;
+
+        int i {0};
+
+        // the way json_transactions limited its parts, by
+        // the size of the whole string it appends to
+        r.body_producer = [i](string& chunk) mutable -> bool
+        {
+            if (i == 0)
+                chunk += "{\"blocks\":[";
+
+            while (i < NO_OF_BLOCKS && chunk.size() < JSON_STREAM_CHUNK_SIZE)
+            {
+                if (i > 0)
+                    chunk += ',';
+
+                chunk += block_json(i++);
+            }
+
+            if (i < NO_OF_BLOCKS)
+                return true;
+
+            chunk += "]}";
+
+            return false;
+        };
+
+        return r;
+    });
+
+    CROW_ROUTE(app, "/throwing")
+    ([]() {
+        crow::response r;
+
+        bool first_part {true};
+
+        r.body_producer = [first_part](string& chunk) mutable -> bool
+        {
+            if (!first_part)
+                throw std::runtime_error("producer failed");
+
+            first_part = false;
+            chunk += "{\"blocks\":[";
+
+            return true;
+        };
+
+        return r;
+    });
+
+    std::thread server_thread([&app]() {
+        app.port(TEST_PORT).run();
+    });
+
+    // wait for the server to accept connections
+    for (int i = 0; i < 100; ++i)
+    {
+        try
+        {
+            boost::asio::io_service io_service;
+            tcp::socket socket(io_service);
+            socket.connect(tcp::endpoint(
+                    boost::asio::ip::address::from_string("127.0.0.1"), TEST_PORT));
+            break;
+        }
+        catch (const std::exception&)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+
+    bool passed {true};
+
+    string response;
+
+    bool completed = http_request(
+            "GET /api/transactions HTTP/1.0\r\n\r\n", response);
+
+    passed &= check(completed, "HTTP/1.0 response is completed");
+
+    string body = expected_body();
+
+    passed &= check(response.find("HTTP/1.1 200") == 0,
+                    "HTTP/1.0 response has status 200");
+    passed &= check(response.find("Transfer-Encoding") == string::npos,
+                    "HTTP/1.0 response is not chunked");
+    passed &= check(response.find("Content-Length: " + to_string(body.size()))
+                    != string::npos, "HTTP/1.0 response has Content-Length");
+    passed &= check(response.size() >= body.size()
+                    && response.compare(response.size() - body.size(),
+                                        body.size(), body) == 0,
+                    "HTTP/1.0 response has whole body");
+
+    response.clear();
+
+    completed = http_request(
+            "GET /api/transactions HTTP/1.1\r\nHost: localhost\r\n"
+            "Connection: close\r\n\r\n", response);
+
+    passed &= check(completed, "HTTP/1.1 response is completed");
+    passed &= check(response.find("Transfer-Encoding: chunked") != string::npos,
+                    "HTTP/1.1 response is chunked");
+
+    response.clear();
+
+    completed = http_request(
+            "GET /throwing HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n",
+            response);
+
+    passed &= check(completed, "connection is closed if producer throws");
+    passed &= check(response.empty(), "nothing is sent if producer throws");
+
+    app.stop();
+    server_thread.join();
+
+    cout << (passed ? "passed" : "failed") << endl;
+
+    return passed ? 0 : 1;
+}
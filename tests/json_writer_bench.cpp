@@ -0,0 +1,304 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+// Benchmark of JsonWriter against obj_to_json_str, whose output
+// used to be parsed into nlohmann json and dumped again. It is
+// done for a large synthetic RingCT block, i.e., CLSAG txs with
+// full rings and bulletproofs, and prints bytes per second and
+// number of allocations of both. Output of both is also compared,
+// so it fails if JsonWriter produces different json.
+//
+// It needs monero libraries, so it is only built together with
+// the explorer, i.e., with -DBUILD_TESTS=ON.
+
+#include "JsonWriter.h"
+
+#include "../ext/json.hpp"
+
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#define NO_OF_TXS           150
+#define NO_OF_INPUTS        2
+#define NO_OF_OUTPUTS       2
+#define RING_SIZE           16
+#define BULLETPROOF_ROUNDS  7   // log2(64 * NO_OF_OUTPUTS)
+#define BENCHMARK_REPEATS   20
+
+using namespace std;
+using namespace cryptonote;
+
+using json = nlohmann::json;
+
+namespace
+{
+
+std::atomic<size_t> no_of_allocations {0};
+
+}
+
+void*
+operator new(size_t size)
+{
+    ++no_of_allocations;
+
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+
+std::mt19937_64 rng {2026};
+
+template <typename T>
+T
+random_pod()
+{
+    T pod;
+
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&pod);
+
+    for (size_t i = 0; i < sizeof(T); ++i)
+        bytes[i] = static_cast<uint8_t>(rng());
+
+    return pod;
+}
+
+rct::keyV
+random_keys(size_t no_of_keys)
+{
+    rct::keyV keys;
+
+    for (size_t i = 0; i < no_of_keys; ++i)
+        keys.push_back(random_pod<rct::key>());
+
+    return keys;
+}
+
+transaction
+make_clsag_tx()
+{
+    transaction tx;
+
+    tx.version = 2;
+    tx.unlock_time = 0;
+
+    for (size_t i = 0; i < NO_OF_INPUTS; ++i)
+    {
+        txin_to_key in_key;
+
+        in_key.amount = 0;
+        in_key.k_image = random_pod<crypto::key_image>();
+
+        for (size_t j = 0; j < RING_SIZE; ++j)
+            in_key.key_offsets.push_back(rng() % 1000000);
+
+        tx.vin.push_back(in_key);
+    }
+
+    for (size_t i = 0; i < NO_OF_OUTPUTS; ++i)
+    {
+        tx_out out;
+
+        out.amount = 0;
+        out.target = txout_to_key(random_pod<crypto::public_key>());
+
+        tx.vout.push_back(out);
+    }
+
+    // tx public key
+    tx.extra.push_back(TX_EXTRA_TAG_PUBKEY);
+
+    for (size_t i = 0; i < 32; ++i)
+        tx.extra.push_back(static_cast<uint8_t>(rng()));
+
+    rct::rctSig& rct = tx.rct_signatures;
+
+    rct.type = rct::RCTTypeCLSAG;
+    rct.txnFee = rng() % 100000000;
+
+    for (size_t i = 0; i < NO_OF_OUTPUTS; ++i)
+    {
+        rct::ecdhTuple ecdh;
+
+        ecdh.mask = rct::zero();
+        ecdh.amount = rct::zero();
+
+        // only 8 bytes of the amount are kept
+        ecdh.amount.bytes[0] = static_cast<uint8_t>(rng());
+
+        rct.ecdhInfo.push_back(ecdh);
+        rct.outPk.push_back({rct::zero(), random_pod<rct::key>()});
+    }
+
+    rct::Bulletproof bp;
+
+    bp.A    = random_pod<rct::key>();
+    bp.S    = random_pod<rct::key>();
+    bp.T1   = random_pod<rct::key>();
+    bp.T2   = random_pod<rct::key>();
+    bp.taux = random_pod<rct::key>();
+    bp.mu   = random_pod<rct::key>();
+    bp.L    = random_keys(BULLETPROOF_ROUNDS);
+    bp.R    = random_keys(BULLETPROOF_ROUNDS);
+    bp.a    = random_pod<rct::key>();
+    bp.b    = random_pod<rct::key>();
+    bp.t    = random_pod<rct::key>();
+
+    rct.p.bulletproofs.push_back(bp);
+
+    for (size_t i = 0; i < NO_OF_INPUTS; ++i)
+    {
+        rct::clsag sig;
+
+        sig.s  = random_keys(RING_SIZE);
+        sig.c1 = random_pod<rct::key>();
+        sig.D  = random_pod<rct::key>();
+
+        rct.p.CLSAGs.push_back(sig);
+    }
+
+    rct.p.pseudoOuts = random_keys(NO_OF_INPUTS);
+
+    return tx;
+}
+
+block
+make_block(const vector<transaction>& txs)
+{
+    block blk;
+
+    blk.major_version = 16;
+    blk.minor_version = 16;
+    blk.timestamp = 1790000000;
+    blk.prev_id = random_pod<crypto::hash>();
+    blk.nonce = static_cast<uint32_t>(rng());
+
+    blk.miner_tx.version = 2;
+    blk.miner_tx.unlock_time = 3000060;
+    blk.miner_tx.vin.push_back(txin_gen {3000000});
+
+    tx_out out;
+
+    out.amount = 600000000000;
+    out.target = txout_to_key(random_pod<crypto::public_key>());
+
+    blk.miner_tx.vout.push_back(out);
+    blk.miner_tx.rct_signatures.type = rct::RCTTypeNull;
+
+    for (size_t i = 0; i < txs.size(); ++i)
+        blk.tx_hashes.push_back(random_pod<crypto::hash>());
+
+    return blk;
+}
+
+// how pages produced json of the block and its txs before
+string
+old_block_json(block& blk, vector<transaction>& txs)
+{
+    string json_str = json::parse(obj_to_json_str(blk)).dump();
+
+    for (transaction& tx: txs)
+        json_str += json::parse(obj_to_json_str(tx)).dump();
+
+    return json_str;
+}
+
+string
+new_block_json(const block& blk, const vector<transaction>& txs)
+{
+    string json_str;
+
+    xmreg::write_block_json(blk, json_str);
+
+    for (const transaction& tx: txs)
+        xmreg::write_tx_json(tx, json_str);
+
+    return json_str;
+}
+
+void
+print_result(const char* name, size_t no_of_bytes,
+             std::chrono::steady_clock::duration duration,
+             size_t allocations)
+{
+    double seconds = std::chrono::duration<double>(duration).count();
+
+    cout << name << ": "
+         << no_of_bytes * BENCHMARK_REPEATS / seconds / 1e6 << " MB/s, "
+         << allocations / BENCHMARK_REPEATS << " allocations per block"
+         << endl;
+}
+
+}
+
+int
+main()
+{
+    vector<transaction> txs;
+
+    for (size_t i = 0; i < NO_OF_TXS; ++i)
+        txs.push_back(make_clsag_tx());
+
+    block blk = make_block(txs);
+
+    // each of them must produce the same json
+    string blk_json;
+
+    xmreg::write_block_json(blk, blk_json);
+
+    bool same = json::parse(blk_json) == json::parse(obj_to_json_str(blk));
+
+    for (transaction& tx: txs)
+    {
+        string json_str;
+
+        xmreg::write_tx_json(tx, json_str);
+
+        same = same && json::parse(json_str) == json::parse(obj_to_json_str(tx));
+    }
+
+    if (!same)
+    {
+        cerr << "JsonWriter and obj_to_json_str produced different json" << endl;
+        return 1;
+    }
+
+    size_t no_of_bytes {0};
+
+    size_t allocations_before = no_of_allocations;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCHMARK_REPEATS; ++i)
+        no_of_bytes = old_block_json(blk, txs).size();
+
+    print_result("obj_to_json_str + nlohmann json", no_of_bytes,
+                 std::chrono::steady_clock::now() - start,
+                 no_of_allocations - allocations_before);
+
+    allocations_before = no_of_allocations;
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCHMARK_REPEATS; ++i)
+        no_of_bytes = new_block_json(blk, txs).size();
+
+    print_result("JsonWriter", no_of_bytes,
+                 std::chrono::steady_clock::now() - start,
+                 no_of_allocations - allocations_before);
+
+    return 0;
+}
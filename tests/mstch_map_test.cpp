@@ -0,0 +1,178 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+// Test of the flat mstch::map used for template contexts. Pages
+// rely on it working as std::map did, i.e., insert and emplace do
+// not overwrite existing keys, while operator[] does. Keys are
+// kept in insertion order.
+
+#include "mstch/mstch.hpp"
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+
+int no_of_failures {0};
+
+void
+check(bool condition, const string& what)
+{
+    if (condition)
+        return;
+
+    cerr << "FAILED: " << what << endl;
+    ++no_of_failures;
+}
+
+string
+get_string(const mstch::map& context, const string& key)
+{
+    return boost::get<string>(context.at(key));
+}
+
+void
+test_insert()
+{
+    mstch::map context {{"hash", string {"a"}}};
+
+    auto result = context.insert({"hash", string {"b"}});
+
+    check(!result.second, "insert of existing key returns false");
+    check(result.first == context.begin(), "insert returns existing item");
+    check(get_string(context, "hash") == "a", "insert does not overwrite");
+
+    mstch::map::value_type item {"height", uint64_t {10}};
+
+    result = context.insert(item);
+
+    check(result.second, "insert of new key returns true");
+    check(boost::get<uint64_t>(result.first->second) == 10,
+          "insert returns new item");
+    check(context.size() == 2, "insert adds new key");
+}
+
+void
+test_emplace()
+{
+    mstch::map context;
+
+    auto result = context.emplace("txs", mstch::array {});
+
+    check(result.second, "emplace of new key returns true");
+
+    boost::get<mstch::array>(result.first->second).push_back(string {"tx"});
+
+    result = context.emplace("txs", mstch::array {});
+
+    check(!result.second, "emplace of existing key returns false");
+    check(boost::get<mstch::array>(context.at("txs")).size() == 1,
+          "emplace does not overwrite");
+}
+
+void
+test_subscript()
+{
+    mstch::map context {{"has_error", false}};
+
+    context["has_error"] = true;
+
+    check(boost::get<bool>(context.at("has_error")),
+          "operator[] overwrites existing key");
+    check(context.size() == 1, "operator[] of existing key adds nothing");
+
+    context["error_msg"] = string {"failed"};
+
+    check(get_string(context, "error_msg") == "failed",
+          "operator[] adds new key");
+
+    // new key starts as default node, i.e., nullptr
+    mstch::node& node = context["empty"];
+
+    check(node.which() == 0, "operator[] adds default node");
+    check(context.size() == 3, "operator[] adds one key each");
+}
+
+void
+test_order_and_lookup()
+{
+    mstch::map context {
+            {"b", string {"1"}},
+            {"a", string {"2"}},
+            {"b", string {"3"}},
+            {"c", string {"4"}}};
+
+    // duplicate in initializer list is ignored, as in std::map
+    check(context.size() == 3, "duplicates in initializer list ignored");
+    check(get_string(context, "b") == "1", "first duplicate kept");
+
+    string keys;
+
+    for (auto const& item: context)
+        keys += item.first;
+
+    check(keys == "bac", "keys kept in insertion order");
+
+    check(context.count("a") == 1 && context.count("d") == 0, "count");
+    check(context.find("d") == context.end(), "find of missing key");
+
+    bool thrown {false};
+
+    try
+    {
+        context.at("d");
+    }
+    catch (const std::out_of_range&)
+    {
+        thrown = true;
+    }
+
+    check(thrown, "at of missing key throws");
+
+    check(context.erase("a") == 1 && context.erase("a") == 0, "erase");
+    check(context.size() == 2 && get_string(context, "c") == "4",
+          "other keys kept after erase");
+}
+
+void
+test_render()
+{
+    mstch::map context {
+            {"hash", string {"a"}},
+            {"txs" , mstch::array {
+                    mstch::map {{"no", uint64_t {1}}},
+                    mstch::map {{"no", uint64_t {2}}}}}};
+
+    context.insert({"hash", string {"b"}});
+
+    string html = mstch::render("{{hash}}:{{#txs}}{{no}}{{/txs}}", context);
+
+    check(html == "a:12", "map rendered, got " + html);
+}
+
+}
+
+int
+main()
+{
+    test_insert();
+    test_emplace();
+    test_subscript();
+    test_order_and_lookup();
+    test_render();
+
+    if (no_of_failures > 0)
+    {
+        cerr << no_of_failures << " checks failed" << endl;
+        return 1;
+    }
+
+    cout << "all checks passed" << endl;
+
+    return 0;
+}
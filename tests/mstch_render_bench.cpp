@@ -0,0 +1,201 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+// Benchmark of rendering the front page, i.e., index2.html with
+// header and footer, for 10 and 100 blocks of txs. Each render
+// into a new string is compared with rendering into a buffer which
+// is reused between renders, as pages do. Both must produce the
+// same html. Renders per second and allocations per render of
+// each are printed.
+
+#include "mstch/mstch.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#define TXS_PER_BLOCK       20
+#define BENCHMARK_REPEATS   50
+
+using namespace std;
+
+namespace
+{
+
+std::atomic<size_t> no_of_allocations {0};
+
+}
+
+void*
+operator new(size_t size)
+{
+    ++no_of_allocations;
+
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+
+string
+read_template(const string& name)
+{
+    ifstream file {string {TEMPLATES_DIR} + "/" + name};
+
+    if (!file)
+        throw runtime_error("Cant read template " + name);
+
+    stringstream ss;
+
+    ss << file.rdbuf();
+
+    return ss.str();
+}
+
+// front page context with the same keys as index2 of the page
+mstch::map
+make_index_context(uint64_t no_of_blocks)
+{
+    mstch::map context {
+            {"server_timestamp"     , string {"2026-10-17 12:00:00"}},
+            {"enable_pusher"        , true},
+            {"network_info"         , mstch::map {
+                    {"difficulty"        , string {"350000000000"}},
+                    {"current_hf_version", uint64_t {16}},
+                    {"hash_rate"         , string {"2.917 GH/s"}},
+                    {"fee_per_kb"        , string {"0.000000020000"}},
+                    {"block_size_limit"  , string {"600.00"}},
+                    {"is_current_info"   , true}}},
+            {"mempool_info"         , string {"<h2>Memory pool</h2>"}},
+            {"is_page_zero"         , true},
+            {"no_of_last_blocks"    , no_of_blocks},
+            {"blk_size_median"      , string {"292.97"}},
+            {"age_format"           , string {"[h:m:s]"}},
+            {"page_no"              , uint64_t {0}},
+            {"total_page_no"        , uint64_t {300000}},
+            {"next_page"            , uint64_t {1}},
+            {"txs"                  , mstch::array {}}
+    };
+
+    mstch::array& txs = boost::get<mstch::array>(context["txs"]);
+
+    for (uint64_t i = 0; i < no_of_blocks; ++i)
+    {
+        uint64_t height = 3000000 - i;
+
+        for (uint64_t j = 0; j < TXS_PER_BLOCK; ++j)
+        {
+            string hash(64, '0');
+
+            for (size_t k = 0; k < hash.size(); ++k)
+                hash[k] = "0123456789abcdef"[(height * 31 + j * 7 + k) % 16];
+
+            txs.push_back(mstch::map {
+                    {"height"           , height},
+                    {"age"              , string {"00:02:14"}},
+                    {"blk_size"         , string {"45.12"}},
+                    {"hash"             , hash},
+                    {"fee_micro"        , string {"0031"}},
+                    {"sum_outputs_short", string {"?"}},
+                    {"no_inputs"        , uint64_t {2}},
+                    {"no_outputs"       , uint64_t {2}},
+                    {"tx_size_short"    , string {"1.54"}}
+            });
+        }
+    }
+
+    return context;
+}
+
+double
+renders_per_second(std::chrono::steady_clock::duration duration)
+{
+    return BENCHMARK_REPEATS / std::chrono::duration<double>(duration).count();
+}
+
+bool
+benchmark(const mstch::compiled_template& index_tmplt, uint64_t no_of_blocks)
+{
+    mstch::node context = make_index_context(no_of_blocks);
+
+    string expected = index_tmplt.render(context);
+
+    size_t allocations_before = no_of_allocations;
+    auto start = std::chrono::steady_clock::now();
+
+    bool same {true};
+
+    for (int i = 0; i < BENCHMARK_REPEATS; ++i)
+        same = index_tmplt.render(context) == expected && same;
+
+    auto new_string_time = std::chrono::steady_clock::now() - start;
+    size_t new_string_allocations = no_of_allocations - allocations_before;
+
+    string buffer;
+
+    allocations_before = no_of_allocations;
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCHMARK_REPEATS; ++i)
+    {
+        buffer.clear();
+        index_tmplt.render(context, buffer);
+        same = buffer == expected && same;
+    }
+
+    auto buffer_time = std::chrono::steady_clock::now() - start;
+    size_t buffer_allocations = no_of_allocations - allocations_before;
+
+    cout << no_of_blocks << " blocks, " << expected.size() << " bytes:\n"
+         << "  new string     : " << renders_per_second(new_string_time)
+         << " renders/s, " << new_string_allocations / BENCHMARK_REPEATS
+         << " allocations per render\n"
+         << "  reused buffer  : " << renders_per_second(buffer_time)
+         << " renders/s, " << buffer_allocations / BENCHMARK_REPEATS
+         << " allocations per render" << endl;
+
+    if (!same)
+        cerr << "Renders of " << no_of_blocks << " blocks differ" << endl;
+
+    return same;
+}
+
+}
+
+int
+main()
+{
+    try
+    {
+        mstch::compiled_template index_tmplt {
+                read_template("header.html")
+                + read_template("index2.html")
+                + read_template("footer.html")};
+
+        bool ok = benchmark(index_tmplt, 10);
+
+        ok = benchmark(index_tmplt, 100) && ok;
+
+        return ok ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}
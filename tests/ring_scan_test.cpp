@@ -0,0 +1,200 @@
+//
+// Created by mwo on 17/10/26.
+//
+
+// Test and benchmark of scanning txs used in rings, as done by
+// show_my_outputs, for a synthetic tx with 100 inputs and rings
+// of 16. Every ring uses the same popular tx, and the others come
+// from a small pool, so many of them are shared as well. Each tx
+// must be scanned exactly once, and each ring member must point
+// to the scan of its own tx. Scanning every ring member, as it
+// was done before, is timed against it.
+
+#include "../src/UniqueKeys.h"
+#include "../src/ThreadPool.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <memory>
+
+#define NO_OF_INPUTS            100
+#define RING_SIZE               16
+#define NO_OF_POOL_TXS          500
+#define POPULAR_TX              1000000
+#define RING_SCAN_MAX_THREADS   4
+
+// work of reading a tx and deriving its outputs
+// with the viewkey, in rounds of a hash like mixing
+#define SCAN_ROUNDS             200000
+
+using namespace std;
+
+namespace
+{
+
+int no_of_failures {0};
+
+void
+check(bool condition, const string& what)
+{
+    if (condition)
+        return;
+
+    cerr << "FAILED: " << what << endl;
+    ++no_of_failures;
+}
+
+// stands for mixin_tx_scan of page.h
+struct tx_scan
+{
+    uint64_t tx_id {0};
+    uint64_t result {0};
+};
+
+uint64_t
+scan_tx(uint64_t tx_id)
+{
+    uint64_t x = tx_id;
+
+    for (int i = 0; i < SCAN_ROUNDS; ++i)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = x ^ (x >> 31);
+    }
+
+    return x;
+}
+
+// ids of txs of members of each ring
+vector<vector<uint64_t>>
+make_rings()
+{
+    std::mt19937_64 rng {2026};
+
+    vector<vector<uint64_t>> rings(NO_OF_INPUTS);
+
+    for (auto& ring: rings)
+    {
+        ring.push_back(POPULAR_TX);
+
+        while (ring.size() < RING_SIZE)
+            ring.push_back(rng() % NO_OF_POOL_TXS);
+    }
+
+    return rings;
+}
+
+}
+
+int
+main()
+{
+    xmreg::ThreadPool executor {RING_SCAN_MAX_THREADS};
+
+    vector<vector<uint64_t>> rings = make_rings();
+
+    auto start = std::chrono::steady_clock::now();
+
+    // as show_my_outputs does it: txs of all ring members
+    // first, and then each unique one scanned once
+    xmreg::UniqueKeys<uint64_t> tx_ids;
+
+    vector<tx_scan> scans;
+    vector<vector<size_t>> scan_indices(rings.size());
+
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+        for (uint64_t tx_id: rings[i])
+        {
+            auto added = tx_ids.add(tx_id);
+
+            if (added.second)
+            {
+                scans.emplace_back();
+                scans.back().tx_id = tx_id;
+            }
+
+            scan_indices[i].push_back(added.first);
+        }
+    }
+
+    unique_ptr<std::atomic<uint64_t>[]> no_of_scans {
+            new std::atomic<uint64_t>[scans.size()]};
+
+    for (size_t i = 0; i < scans.size(); ++i)
+        no_of_scans[i] = 0;
+
+    executor.parallel_for(scans.size(), RING_SCAN_MAX_THREADS,
+            [&](size_t i)
+    {
+        ++no_of_scans[i];
+        scans[i].result = scan_tx(scans[i].tx_id);
+    });
+
+    auto unique_time = std::chrono::steady_clock::now() - start;
+
+    check(tx_ids.size() == scans.size(), "one scan for each unique tx");
+    check(tx_ids[0] == POPULAR_TX, "txs kept in order of first use");
+
+    for (size_t i = 0; i < scans.size(); ++i)
+        check(no_of_scans[i] == 1, "tx " + to_string(scans[i].tx_id)
+                                   + " scanned " + to_string(no_of_scans[i])
+                                   + " times");
+
+    size_t no_of_members {0};
+
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+        for (size_t j = 0; j < rings[i].size(); ++j)
+        {
+            const tx_scan& scan = scans[scan_indices[i][j]];
+
+            check(scan.tx_id == rings[i][j]
+                  && scan.result == scan_tx(rings[i][j]),
+                  "ring member points to scan of its tx");
+
+            ++no_of_members;
+        }
+
+        // popular tx is shared by all rings
+        check(scan_indices[i][0] == 0, "popular tx scanned once");
+    }
+
+    // as it was done before: every ring member scanned on its own
+    start = std::chrono::steady_clock::now();
+
+    std::atomic<uint64_t> checksum {0};
+
+    executor.parallel_for(rings.size(), RING_SCAN_MAX_THREADS,
+            [&](size_t i)
+    {
+        for (uint64_t tx_id: rings[i])
+            checksum += scan_tx(tx_id);
+    });
+
+    auto per_member_time = std::chrono::steady_clock::now() - start;
+
+    cout << NO_OF_INPUTS << " inputs, " << no_of_members << " ring members, "
+         << scans.size() << " unique txs (checksum " << checksum % 1000 << ")\n"
+         << "  each member scanned: "
+         << std::chrono::duration_cast<std::chrono::milliseconds>(
+                 per_member_time).count() << " ms\n"
+         << "  each tx scanned once: "
+         << std::chrono::duration_cast<std::chrono::milliseconds>(
+                 unique_time).count() << " ms" << endl;
+
+    if (no_of_failures > 0)
+    {
+        cerr << no_of_failures << " checks failed" << endl;
+        return 1;
+    }
+
+    cout << "all checks passed" << endl;
+
+    return 0;
+}